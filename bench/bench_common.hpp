@@ -0,0 +1,199 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_BENCH_BENCH_COMMON_HPP_
+#define TAWNY_DENSITY_BENCH_BENCH_COMMON_HPP_
+
+#include <malloc.h>          // for malloc_trim
+#include <sys/resource.h>    // for getrusage, rusage, RUSAGE_SELF
+#include <algorithm>         // for min
+#include <chrono>            // for steady_clock, duration
+#include <cmath>             // for exp, log
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t
+#include <fstream>           // for ofstream
+#include <random>            // for mt19937_64, uniform_real_distribution, normal_distribution, ...
+#include <stdexcept>         // for runtime_error
+#include <string>            // for string
+#include <vector>            // for vector
+#include "observations.hpp"  // for ObsPoint, UNKNOWN_DAY
+#include "stats.hpp"         // for peakRssBytes, currentRssBytes
+#include "suburb.hpp"        // for Suburb, Point
+
+using std::string;
+using std::vector;
+using observations::ObsPoint;
+using suburb::Point;
+using suburb::Suburb;
+
+namespace bench {
+
+const uint64_t DEFAULT_SEED = 20250901;
+
+// Seconds taken by the fastest of repeat runs of fn
+template <typename Fn>
+double bestSeconds(int repeat, Fn fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeat; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+        best = std::min(best, took.count());
+    }
+    return best;
+}
+
+// Peak resident set size of this process so far, in MiB
+inline double peakRssMb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;  // ru_maxrss is in KiB on Linux
+}
+
+// Resident set size now (VmRSS), in MiB
+inline double currentRssMb() {
+    return static_cast<double>(stats::currentRssBytes()) / (1024.0 * 1024.0);
+}
+
+// Peak resident set size (VmHWM), in MiB; since the last resetPeakRss() if that succeeded
+inline double peakRssSinceResetMb() {
+    return static_cast<double>(stats::peakRssBytes()) / (1024.0 * 1024.0);
+}
+
+// Returns freed heap to the system and resets VmHWM to the current RSS, so the
+// next peakRssSinceResetMb() covers only what runs after
+//
+// Returns:
+//    false where the kernel does not allow the reset (the peak then covers the process's lifetime)
+inline bool resetPeakRss() {
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+    clear.close();
+    return static_cast<bool>(clear);
+}
+
+// Union bounding box of the suburbs
+inline void suburbsBounds(const vector<Suburb>& suburbs, double* minLon, double* minLat,
+    double* maxLon, double* maxLat) {
+    *minLon = *minLat = 1e300;
+    *maxLon = *maxLat = -1e300;
+    for (const auto& s : suburbs) {
+        if (s.polys.empty()) continue;
+        *minLon = std::min(*minLon, s.minLon);
+        *minLat = std::min(*minLat, s.minLat);
+        *maxLon = std::max(*maxLon, s.maxLon);
+        *maxLat = std::max(*maxLat, s.maxLat);
+    }
+}
+
+// n points uniformly spread over a box
+inline vector<Point> uniformPoints(size_t n, double minLon, double minLat, double maxLon, double maxLat,
+    uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> lon(minLon, maxLon), lat(minLat, maxLat);
+    vector<Point> out(n);
+    for (auto& p : out) p = Point{lon(rng), lat(rng)};
+    return out;
+}
+
+// n points in Gaussian clusters (sigma in degrees) around the bbox centres of
+// randomly chosen suburbs, as sightings bunch around towns and parks
+inline vector<Point> clusteredPoints(size_t n, const vector<Suburb>& suburbs, double sigma, uint64_t seed,
+    vector<uint32_t>* outCentres = nullptr) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, suburbs.empty() ? 0 : suburbs.size() - 1);
+    std::normal_distribution<double> jitter(0, sigma);
+    vector<Point> out(n);
+    if (outCentres) outCentres->assign(n, 0);
+    for (size_t i = 0; i < n && !suburbs.empty(); ++i) {
+        const size_t s = pick(rng);
+        const Suburb& c = suburbs[s];
+        out[i] = Point{(c.minLon + c.maxLon) / 2 + jitter(rng), (c.minLat + c.maxLat) / 2 + jitter(rng)};
+        if (outCentres) (*outCentres)[i] = static_cast<uint32_t>(s);
+    }
+    return out;
+}
+
+// Shapes of synthetic observation sets
+enum class Distribution {
+    Uniform,    // evenly over the bbox
+    Clustered,  // Gaussian clusters on suburb centres, every suburb equally likely
+    RealLike,   // a few hotspot suburbs take most sightings, plus scatter, undated and out-of-range days
+};
+
+inline Distribution parseDistribution(const string& name) {
+    if (name == "uniform") return Distribution::Uniform;
+    if (name == "clustered") return Distribution::Clustered;
+    if (name == "reallike") return Distribution::RealLike;
+    throw std::runtime_error("Unknown distribution: " + name);
+}
+
+inline const char* distributionName(Distribution d) {
+    switch (d) {
+        case Distribution::Uniform: return "uniform";
+        case Distribution::Clustered: return "clustered";
+        case Distribution::RealLike: return "reallike";
+    }
+    return "unknown";
+}
+
+// n synthetic observations with ids, days in firstDay..lastDay and accuracy radii.
+// RealLike draws suburbs from a Zipf-like law (a handful of suburbs see most
+// sightings, as with iNaturalist), scatters 10% uniformly, leaves 2% undated
+// and dates 3% outside the range.
+inline vector<ObsPoint> syntheticObservations(size_t n, Distribution d, const vector<Suburb>& suburbs,
+    int firstDay, int lastDay, uint64_t seed) {
+    double minLon, minLat, maxLon, maxLat;
+    suburbsBounds(suburbs, &minLon, &minLat, &maxLon, &maxLat);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> lon(minLon, maxLon), lat(minLat, maxLat), unit(0, 1);
+    std::uniform_int_distribution<int> day(firstDay, lastDay);
+    std::uniform_int_distribution<size_t> anySuburb(0, suburbs.empty() ? 0 : suburbs.size() - 1);
+    std::normal_distribution<double> near(0, 0.01), tight(0, 0.003);
+    std::exponential_distribution<double> accuracy(1.0 / 150);
+
+    vector<ObsPoint> out(n);
+    for (size_t i = 0; i < n; ++i) {
+        ObsPoint& o = out[i];
+        o.id = i + 1;
+        o.day = day(rng);
+        o.accuracy = accuracy(rng);
+        const double u = unit(rng);
+        if (d == Distribution::Uniform || suburbs.empty() || (d == Distribution::RealLike && u < 0.10)) {
+            o.lon = lon(rng);
+            o.lat = lat(rng);
+            continue;
+        }
+        size_t s = anySuburb(rng);
+        if (d == Distribution::RealLike) {
+            // rank r is drawn with probability ~ 1/r (inverse CDF of a log-uniform)
+            const double r = std::exp(unit(rng) * std::log(static_cast<double>(suburbs.size())));
+            s = (static_cast<size_t>(r) * 2654435761u) % suburbs.size();
+            if (u > 0.98) o.day = observations::UNKNOWN_DAY;
+            else if (u > 0.95) o.day = lastDay + 1 + day(rng) - firstDay;
+        }
+        const Suburb& c = suburbs[s];
+        auto& jitter = d == Distribution::RealLike ? tight : near;
+        o.lon = (c.minLon + c.maxLon) / 2 + jitter(rng);
+        o.lat = (c.minLat + c.maxLat) / 2 + jitter(rng);
+    }
+    return out;
+}
+
+}  // namespace bench
+
+#endif  // TAWNY_DENSITY_BENCH_BENCH_COMMON_HPP_
@@ -0,0 +1,414 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Point-in-polygon micro-benchmark: times the ring, polygon and suburb
+// kernels and the SuburbIndex strategies on fixed-seed point sets, and counts
+// the edges each query visits. Also times the distance-to-boundary check and
+// accuracy-weighted counting per observation, and the observation fetch loop
+// over canned iNaturalist pages.
+
+#include <nlohmann/json.hpp>  // for json
+#include <algorithm>          // for min, max
+#include <cmath>              // for cos, sin
+#include <cstddef>            // for size_t
+#include <cstdint>            // for uint32_t, uint64_t
+#include <cstdlib>            // for strtoull
+#include <random>             // for mt19937_64, uniform_real_distribution
+#include <exception>          // for exception
+#include <fstream>            // for ofstream
+#include <functional>         // for function
+#include <iomanip>            // for setw, setprecision
+#include <iostream>           // for cout, cerr
+#include <string>             // for string, to_string
+#include <unordered_map>      // for unordered_map
+#include <vector>             // for vector
+#include "bench_common.hpp"   // for bestSeconds, uniformPoints, clusteredPoints, suburbsBounds, peakRssMb
+#include "fractional.hpp"     // for countFractional, FractionalOptions, FractionalStats
+#include "main.hpp"           // for SPRING_2025_START_DATE, SPRING_2025_END_DATE
+#include "observations.hpp"   // for fetchINatPointsSharded, ShardOptions, splitDateRange, formatIsoDate, ObsPoint
+#include "suburb.hpp"         // for Ring, Polygon, Suburb, buildChains, pointInRing, pointInPolygon, pointInSuburb
+#include "suburb_grid.hpp"    // for SuburbGrid, pointSuburbMetres
+#include "suburb_index.hpp"   // for SuburbIndex, IndexStrategy
+#include "trapezoid_map.hpp"  // for TrapezoidMap
+#include "utils.hpp"          // for IHttpClient, HttpResponse
+
+using std::cout;
+using std::cerr;
+using std::function;
+using json = nlohmann::json;
+
+using observations::ShardOptions;
+
+using suburb::Ring;
+using suburb::Polygon;
+using suburb::SuburbGrid;
+using suburb::SuburbIndex;
+using suburb::IndexStrategy;
+using suburb::NO_SUBURB;
+
+namespace {
+
+const double EDGE_BUDGET = 2e8;  // caps queries on huge rings so each kernel runs in about a second
+const double ACCURACY_METRES = 100;  // positional accuracy given to the clustered observations
+
+// Command line settings
+struct BenchArgs {
+    string geojsonPath = TAWNY_DEFAULT_GEOJSON;
+    size_t queries = 200000;
+    uint64_t seed = bench::DEFAULT_SEED;
+    int repeat = 3;
+    string jsonPath;
+};
+
+// One timed kernel
+struct Result {
+    string kernel;
+    string dataset;
+    size_t queries = 0;
+    double seconds = 0;
+    double edgesPerQuery = 0;
+    double hitRate = 0;
+};
+
+// Star-shaped ring of n vertices around (lon, lat), radius in degrees, with
+// its monotone chains built as the loader would
+Ring starRing(size_t n, double lon, double lat, double radius) {
+    Ring ring;
+    for (size_t i = 0; i < n; ++i) {
+        const double t = 6.283185307179586 * static_cast<double>(i) / static_cast<double>(n);
+        const double r = radius * (1 + 0.3 * std::sin(7 * t) + 0.05 * std::sin(97 * t));
+        ring.points.push_back(Point{lon + r * std::cos(t), lat + r * std::sin(t)});
+    }
+    ring.points.push_back(ring.points.front());
+    suburb::buildChains(&ring);
+    return ring;
+}
+
+// Edges pointInRing tests for point: every edge, or when the ring has chains
+// the one edge binary-searched in each chain spanning the point's latitude
+size_t ringEdges(const Ring& ring, const Point& p) {
+    if (ring.chains.empty()) return ring.points.size();
+    size_t edges = 0;
+    for (size_t c = 0; c < ring.chains.size(); ++c) {
+        const double fromLat = ring.chainLats[c], toLat = ring.chainLats[c + 1];
+        if (p.lat > std::min(fromLat, toLat) && p.lat <= std::max(fromLat, toLat)) ++edges;
+    }
+    return edges;
+}
+
+// Polygon with a star outer ring and a star hole, bbox filled in
+Polygon starPolygon(size_t n) {
+    Polygon poly;
+    poly.rings = { starRing(n, 145.0, -37.8, 0.05), starRing(n / 4 + 3, 145.0, -37.8, 0.015) };
+    suburb::ringBounds(poly.rings[0], &poly.minLon, &poly.minLat, &poly.maxLon, &poly.maxLat);
+    return poly;
+}
+
+// Edges pointInPolygon visits for point (mirrors its early exits)
+size_t polygonEdges(const Polygon& poly, const Point& p) {
+    if (p.lon < poly.minLon + 1e-12 || p.lon > poly.maxLon + 1e-12 ||
+        p.lat < poly.minLat + 1e-12 || p.lat > poly.maxLat + 1e-12 || poly.rings.empty())
+        return 0;
+    size_t edges = ringEdges(poly.rings[0], p);
+    if (!suburb::pointInRing(poly.rings[0], p)) return edges;
+    for (size_t i = 1; i < poly.rings.size(); ++i) {
+        edges += ringEdges(poly.rings[i], p);
+        if (suburb::pointInRing(poly.rings[i], p)) break;
+    }
+    return edges;
+}
+
+// Edges pointInSuburb visits for point (mirrors its early exits)
+size_t suburbEdges(const Suburb& s, const Point& p) {
+    if (p.lon < s.minLon + 1e-12 || p.lon > s.maxLon + 1e-12 ||
+        p.lat < s.minLat + 1e-12 || p.lat > s.maxLat + 1e-12)
+        return 0;
+    size_t edges = 0;
+    for (const auto& poly : s.polys) {
+        edges += polygonEdges(poly, p);
+        if (suburb::pointInPolygon(poly, p)) break;
+    }
+    return edges;
+}
+
+// Serves pre-rendered iNaturalist pages keyed on the d1 and page query parameters,
+// so the fetch, parse and merge path runs with no network
+struct CannedClient : IHttpClient {
+    std::unordered_map<string, string> pages;
+
+    static string key(const string& url) {
+        auto param = [&](const string& name) {
+            const size_t at = url.find("&" + name + "=");
+            if (at == string::npos) return string();
+            const size_t start = at + name.size() + 2;
+            return url.substr(start, url.find('&', start) - start);
+        };
+        return param("d1") + "/" + param("page");
+    }
+
+    HttpResponse get(const string& url) override {
+        const auto it = pages.find(key(url));
+        if (it == pages.end()) return HttpResponse{404, ""};
+        return HttpResponse{200, it->second};
+    }
+};
+
+// One day-wide window per day of spring, each two full pages of results
+// with the fields the real API returns alongside the ones we read
+CannedClient cannedSpring(uint64_t seed, size_t* outObservations) {
+    const int pagesPerDay = 2;
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> lon(144.5, 145.5), lat(-38.2, -37.5), accuracy(3, 500);
+    CannedClient client;
+    uint64_t id = 100000000;
+    *outObservations = 0;
+    for (const auto& w : observations::splitDateRange(SPRING_2025_START_DATE, SPRING_2025_END_DATE, 1)) {
+        const string day = observations::formatIsoDate(w.firstDay);
+        for (int page = 1; page <= pagesPerDay; ++page) {
+            json body = {{"total_results", pagesPerDay * observations::PER_PAGE}, {"page", page},
+                {"per_page", observations::PER_PAGE}, {"results", json::array()}};
+            for (int i = 0; i < observations::PER_PAGE; ++i, ++id) {
+                body["results"].push_back({
+                    {"id", id}, {"uuid", "0f0e0d0c-" + std::to_string(id)}, {"observed_on", day},
+                    {"quality_grade", "research"}, {"positional_accuracy", accuracy(rng)},
+                    {"geojson", {{"type", "Point"}, {"coordinates", {lon(rng), lat(rng)}}}},
+                    {"location", "-37.8,145.0"}, {"place_guess", "Melbourne VIC, Australia"},
+                    {"taxon", {{"id", 20518}, {"name", "Ninox strenua"}, {"rank", "species"},
+                        {"preferred_common_name", "Powerful Owl"}}},
+                    {"user", {{"id", id % 997}, {"login", "observer" + std::to_string(id % 997)}}}});
+            }
+            client.pages[day + "/" + std::to_string(page)] = body.dump();
+            *outObservations += observations::PER_PAGE;
+        }
+    }
+    return client;
+}
+
+// Times fn over queries 0..queries-1; fn returns true for a hit, edges counts what query i visits
+Result run(const string& kernel, const string& dataset, size_t queries, int repeat,
+    const function<bool(size_t)>& fn, const function<size_t(size_t)>& edges) {
+    Result r;
+    r.kernel = kernel;
+    r.dataset = dataset;
+    r.queries = queries;
+    size_t hits = 0;
+    r.seconds = bench::bestSeconds(repeat, [&] {
+        hits = 0;
+        for (size_t i = 0; i < queries; ++i) hits += fn(i) ? 1 : 0;
+    });
+    size_t visited = 0;
+    for (size_t i = 0; i < queries; ++i) visited += edges(i);
+    r.edgesPerQuery = queries == 0 ? 0 : static_cast<double>(visited) / queries;
+    r.hitRate = queries == 0 ? 0 : static_cast<double>(hits) / queries;
+    return r;
+}
+
+bool parseBenchArgs(int argc, char** argv, BenchArgs* out) {
+    for (int i = 1; i < argc; ++i) {
+        const string a(argv[i]);
+        if (a == "--geojson" && i + 1 < argc) {
+            out->geojsonPath = argv[++i];
+        } else if (a == "--queries" && i + 1 < argc) {
+            out->queries = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--seed" && i + 1 < argc) {
+            out->seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--repeat" && i + 1 < argc) {
+            out->repeat = static_cast<int>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (a == "--json" && i + 1 < argc) {
+            out->jsonPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return out->queries > 0 && out->repeat > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchArgs args;
+    if (!parseBenchArgs(argc, argv, &args)) {
+        cerr << "Usage: " << argv[0] << " [--geojson suburbs.geojson] [--queries 200000] [--seed N]"
+            << " [--repeat 3] [--json results.json]\n";
+        return 1;
+    }
+
+    try {
+        double minLon, minLat, maxLon, maxLat;
+        vector<Suburb> suburbs = suburb::loadSuburbsGeoJSON(args.geojsonPath, &minLon, &minLat, &maxLon, &maxLat);
+        bench::suburbsBounds(suburbs, &minLon, &minLat, &maxLon, &maxLat);
+        vector<Result> results;
+
+        // synthetic rings and polygons, queried over twice their bbox
+        for (size_t n : {100, 10000, 1000000}) {
+            const Polygon poly = starPolygon(n);
+            const Ring& ring = poly.rings[0];
+            const double w = poly.maxLon - poly.minLon, h = poly.maxLat - poly.minLat;
+            // each query checks every chain's latitude range
+            const double work = static_cast<double>(ring.chains.size());
+            const size_t q = std::min(args.queries, static_cast<size_t>(EDGE_BUDGET / work) + 1);
+            const auto points = bench::uniformPoints(q, poly.minLon - w / 2, poly.minLat - h / 2,
+                poly.maxLon + w / 2, poly.maxLat + h / 2, args.seed);
+            results.push_back(run("pointInRing/" + std::to_string(n), "uniform", q, args.repeat,
+                [&](size_t i) { return suburb::pointInRing(ring, points[i]); },
+                [&](size_t i) { return ringEdges(ring, points[i]); }));
+            results.push_back(run("pointInPolygon/" + std::to_string(n), "uniform", q, args.repeat,
+                [&](size_t i) { return suburb::pointInPolygon(poly, points[i]); },
+                [&](size_t i) { return polygonEdges(poly, points[i]); }));
+        }
+
+        // real suburbs: each clustered point tested against the suburb it was drawn around
+        vector<uint32_t> centres;
+        const auto clustered = bench::clusteredPoints(args.queries, suburbs, 0.01, args.seed + 1, &centres);
+        const auto uniform = bench::uniformPoints(args.queries, minLon, minLat, maxLon, maxLat, args.seed + 2);
+        results.push_back(run("pointInSuburb", "clustered", clustered.size(), args.repeat,
+            [&](size_t i) { return suburb::pointInSuburb(suburbs[centres[i]], clustered[i]); },
+            [&](size_t i) { return suburbEdges(suburbs[centres[i]], clustered[i]); }));
+
+        const SuburbGrid grid(suburbs);
+        for (auto strategy : {IndexStrategy::Linear, IndexStrategy::Grid, IndexStrategy::Trapezoid}) {
+            const SuburbIndex index(suburbs, strategy);
+            const string name = string("SuburbIndex/") + suburb::indexStrategyName(strategy);
+            // edges visited: every candidate tested until the first hit (for the trapezoidal
+            // map, the DAG nodes visited plus the grid's edges when the map defers to it)
+            auto edgesAt = [&](const Point& p) {
+                size_t visited = 0;
+                if (strategy == IndexStrategy::Trapezoid &&
+                    index.trapezoidMap()->locate(p, &visited) != suburb::TrapezoidMap::AMBIGUOUS) {
+                    return visited;
+                }
+                if (strategy == IndexStrategy::Linear) {
+                    for (const auto& s : suburbs) {
+                        visited += suburbEdges(s, p);
+                        if (suburb::pointInSuburb(s, p)) break;
+                    }
+                } else {
+                    size_t count = 0;
+                    const uint32_t* ids = grid.candidates(p, &count);
+                    for (size_t i = 0; i < count; ++i) {
+                        visited += suburbEdges(suburbs[ids[i]], p);
+                        if (suburb::pointInSuburb(suburbs[ids[i]], p)) break;
+                    }
+                }
+                return visited;
+            };
+            // the linear scan is slow; a tenth of the queries is plenty
+            const size_t q = strategy == IndexStrategy::Linear ? args.queries / 10 + 1 : args.queries;
+            for (const auto* set : {&uniform, &clustered}) {
+                const vector<Point>& points = *set;
+                results.push_back(run(name, set == &uniform ? "uniform" : "clustered",
+                    std::min(q, points.size()), args.repeat,
+                    [&](size_t i) { return index.locate(points[i]) != NO_SUBURB; },
+                    [&](size_t i) { return edgesAt(points[i]); }));
+            }
+        }
+
+        // countFractional's per-observation check that an accuracy circle lies inside
+        // its suburb, with and without monotone chains (the chainless scan tests
+        // every edge of the suburb; edges are not counted for either)
+        vector<Suburb> unchained = suburbs;
+        for (auto& s : unchained) {
+            for (auto& poly : s.polys) {
+                for (auto& ring : poly.rings) {
+                    ring.chains.clear();
+                    ring.chainLats.clear();
+                }
+            }
+        }
+        for (const auto* set : {&suburbs, &unchained}) {
+            const vector<Suburb>& world = *set;
+            const size_t q = set == &suburbs ? clustered.size() : clustered.size() / 10 + 1;
+            results.push_back(run(set == &suburbs ? "pointSuburbMetres" : "pointSuburbMetres/scan",
+                "clustered", std::min(q, clustered.size()), args.repeat,
+                [&](size_t i) {
+                    return suburb::pointSuburbMetres(world[centres[i]], clustered[i], ACCURACY_METRES) >=
+                        ACCURACY_METRES;
+                },
+                [&](size_t) { return size_t{0}; }));
+        }
+
+        // accuracy-weighted counting of the clustered points on one thread; hits are
+        // observations credited to some suburb
+        {
+            const SuburbIndex index(suburbs);
+            vector<observations::ObsPoint> obs(clustered.size());
+            for (size_t i = 0; i < clustered.size(); ++i) {
+                obs[i].lon = clustered[i].lon;
+                obs[i].lat = clustered[i].lat;
+                obs[i].day = 0;
+                obs[i].accuracy = ACCURACY_METRES;
+            }
+            Result fractional;
+            fractional.kernel = "countFractional";
+            fractional.dataset = "clustered";
+            fractional.queries = obs.size();
+            fractional::FractionalStats stats;
+            fractional.seconds = bench::bestSeconds(args.repeat, [&] {
+                fractional::countFractional(index, obs, 0, 0, fractional::FractionalOptions{}, 1, &stats);
+            });
+            fractional.hitRate = static_cast<double>(stats.whole + stats.spread) / static_cast<double>(obs.size());
+            results.push_back(fractional);
+        }
+
+        // the observation fetch loop over canned pages: JSON parse, extraction, merge and dedup
+        size_t cannedObservations = 0;
+        CannedClient canned = cannedSpring(args.seed, &cannedObservations);
+        ShardOptions options;
+        options.windowDays = 1;
+        options.pageDelayMs = 0;
+        Result fetch;
+        fetch.kernel = "fetchINatPointsSharded";
+        fetch.dataset = "canned";
+        fetch.queries = cannedObservations;
+        size_t fetched = 0;
+        fetch.seconds = bench::bestSeconds(args.repeat, [&] {
+            fetched = observations::fetchINatPointsSharded(canned, "Ninox strenua", SPRING_2025_START_DATE,
+                SPRING_2025_END_DATE, -38.5, 144.0, -37.0, 146.0, options).size();
+        });
+        fetch.hitRate = static_cast<double>(fetched) / static_cast<double>(cannedObservations);
+        results.push_back(fetch);
+
+        cout << std::left << std::setw(26) << "kernel" << std::setw(11) << "dataset" << std::right
+            << std::setw(10) << "queries" << std::setw(12) << "ns/query" << std::setw(14) << "queries/s"
+            << std::setw(14) << "edges/query" << std::setw(8) << "hits" << "\n";
+        json out;
+        out["benchmark"] = "tawny_density_bench";
+        out["geojson"] = args.geojsonPath;
+        out["suburbs"] = suburbs.size();
+        out["seed"] = args.seed;
+        out["peak_rss_mb"] = bench::peakRssMb();
+        out["results"] = json::array();
+        for (const auto& r : results) {
+            const double ns = r.seconds * 1e9 / static_cast<double>(r.queries);
+            const double qps = static_cast<double>(r.queries) / r.seconds;
+            cout << std::left << std::setw(26) << r.kernel << std::setw(11) << r.dataset << std::right
+                << std::setw(10) << r.queries << std::fixed << std::setprecision(1) << std::setw(12) << ns
+                << std::setprecision(0) << std::setw(14) << qps << std::setprecision(1) << std::setw(14)
+                << r.edgesPerQuery << std::setprecision(2) << std::setw(8) << r.hitRate << "\n";
+            out["results"].push_back({
+                {"kernel", r.kernel}, {"dataset", r.dataset}, {"queries", r.queries},
+                {"ns_per_query", ns}, {"queries_per_second", qps},
+                {"edges_per_query", r.edgesPerQuery}, {"hit_rate", r.hitRate}});
+        }
+        if (!args.jsonPath.empty()) {
+            std::ofstream file(args.jsonPath);
+            file << out.dump(2) << "\n";
+            if (!file) throw std::runtime_error("Failed to write " + args.jsonPath);
+        }
+    } catch (const std::exception& e) {
+        cerr << "Fatal: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
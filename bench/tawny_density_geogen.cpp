@@ -0,0 +1,340 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Synthetic suburb GeoJSON generator for loader and index stress tests.
+// Writes a jittered cols x rows tessellation of a bbox whose shared edges are
+// wiggly polylines (identical vertices on both sides), with enclaves cut out
+// as holes and owned by a neighbour as an extra MultiPolygon part, and a
+// fraction of suburbs bounded by very long rings. Then times loading the file
+// and building the index, and checks sample points land in exactly one suburb.
+
+#include <nlohmann/json.hpp>  // for json
+#include <algorithm>          // for reverse, min
+#include <cmath>              // for sin, cos
+#include <cstddef>            // for size_t
+#include <cstdint>            // for uint64_t, uint32_t
+#include <cstdio>             // for snprintf, sscanf
+#include <cstdlib>            // for strtoull, strtod
+#include <exception>          // for exception
+#include <fstream>            // for ofstream, ifstream
+#include <iomanip>            // for setprecision
+#include <iostream>           // for cout, cerr
+#include <stdexcept>          // for runtime_error
+#include <string>             // for string, to_string
+#include <utility>            // for move
+#include <vector>             // for vector
+#include "bench_common.hpp"   // for bestSeconds, peakRssMb, uniformPoints
+#include "suburb.hpp"         // for Suburb, Point, loadSuburbsGeoJSON, pointInSuburb
+#include "suburb_grid.hpp"    // for SuburbGrid
+#include "suburb_index.hpp"   // for SuburbIndex
+
+using std::cout;
+using std::cerr;
+using json = nlohmann::json;
+
+using suburb::SuburbGrid;
+using suburb::SuburbIndex;
+
+namespace {
+
+const double PI = 3.141592653589793;
+const double CORNER_JITTER = 0.25;  // interior corners move up to this fraction of a cell
+const double EDGE_WIGGLE = 0.08;    // peak sideways offset of an edge, as a fraction of its length
+const double HOLE_RADIUS = 0.1;     // enclave radius as a fraction of the smaller cell side
+
+// Command line settings
+struct GenArgs {
+    string outPath;
+    size_t cols = 60, rows = 50;
+    size_t edgeVertices = 16;        // vertices along each shared edge
+    double longFraction = 0.02;      // suburbs whose edges get longVertices instead
+    size_t longVertices = 20000;
+    double holeFraction = 0.1;       // suburbs with an enclave owned by their east neighbour
+    double minLon = 144.4, minLat = -38.5, maxLon = 145.6, maxLat = -37.4;
+    uint64_t seed = bench::DEFAULT_SEED;
+    bool measure = true;
+    size_t verifyPoints = 100000;
+};
+
+// Deterministic hash of (seed, tag, i, j) mapped to [0, 1)
+double unitHash(uint64_t seed, uint64_t tag, uint64_t i, uint64_t j) {
+    uint64_t x = seed ^ (tag * 0x9E3779B97F4A7C15ull) ^ (i * 0xBF58476D1CE4E5B9ull) ^ (j * 0x94D049BB133111EBull);
+    // splitmix64 finaliser
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return static_cast<double>(x >> 11) / 9007199254740992.0;
+}
+
+// Builds the tessellation: corners, edges and rings, all derived from hashes
+// so the two cells either side of an edge generate the same vertices.
+class Tessellation {
+ public:
+    explicit Tessellation(const GenArgs& args) : a_(args) {}
+
+    // Corner (i, j) for 0 <= i <= cols, 0 <= j <= rows; border corners only slide along the border
+    Point corner(size_t i, size_t j) const {
+        const double w = (a_.maxLon - a_.minLon) / a_.cols, h = (a_.maxLat - a_.minLat) / a_.rows;
+        double lon = a_.minLon + w * i, lat = a_.minLat + h * j;
+        if (i > 0 && i < a_.cols) lon += w * CORNER_JITTER * (2 * unitHash(a_.seed, 1, i, j) - 1);
+        if (j > 0 && j < a_.rows) lat += h * CORNER_JITTER * (2 * unitHash(a_.seed, 2, i, j) - 1);
+        if (i == 0) lon = a_.minLon;
+        if (i == a_.cols) lon = a_.maxLon;
+        if (j == 0) lat = a_.minLat;
+        if (j == a_.rows) lat = a_.maxLat;
+        return Point{lon, lat};
+    }
+
+    bool isLong(size_t i, size_t j) const { return unitHash(a_.seed, 3, i, j) < a_.longFraction; }
+    bool hasHole(size_t i, size_t j) const { return a_.cols > 1 && unitHash(a_.seed, 4, i, j) < a_.holeFraction; }
+
+    // Outer ring of cell (i, j), counter-clockwise and closed
+    vector<Point> cellRing(size_t i, size_t j) const {
+        vector<Point> ring;
+        append(edge(true, i, j), false, &ring);       // bottom, west to east
+        append(edge(false, i + 1, j), false, &ring);  // east, south to north
+        append(edge(true, i, j + 1), true, &ring);    // top, east to west
+        append(edge(false, i, j), true, &ring);       // west, north to south
+        ring.push_back(ring.front());
+        return ring;
+    }
+
+    // Enclave of cell (i, j): a closed star around the cell centre, counter-clockwise
+    vector<Point> enclave(size_t i, size_t j) const {
+        const Point c0 = corner(i, j), c1 = corner(i + 1, j), c2 = corner(i + 1, j + 1), c3 = corner(i, j + 1);
+        const double lon = (c0.lon + c1.lon + c2.lon + c3.lon) / 4, lat = (c0.lat + c1.lat + c2.lat + c3.lat) / 4;
+        const double r = HOLE_RADIUS * std::min((a_.maxLon - a_.minLon) / a_.cols, (a_.maxLat - a_.minLat) / a_.rows);
+        const size_t n = std::max<size_t>(8, a_.edgeVertices * 2);
+        vector<Point> ring;
+        for (size_t k = 0; k < n; ++k) {
+            const double t = 2 * PI * k / n;
+            const double rk = r * (1 + 0.3 * std::sin(5 * t));
+            ring.push_back(Point{lon + rk * std::cos(t), lat + rk * std::sin(t)});
+        }
+        ring.push_back(ring.front());
+        return ring;
+    }
+
+ private:
+    // Edge starting at corner (i, j): horizontal to (i + 1, j) or vertical to (i, j + 1), endpoints included
+    vector<Point> edge(bool horizontal, size_t i, size_t j) const {
+        const Point a = corner(i, j), b = horizontal ? corner(i + 1, j) : corner(i, j + 1);
+        // long if either cell beside it is long
+        const bool border = horizontal ? (j == 0 || j == a_.rows) : (i == 0 || i == a_.cols);
+        const bool longEdge = horizontal ? ((j > 0 && isLong(i, j - 1)) || (j < a_.rows && isLong(i, j)))
+                                   : ((i > 0 && isLong(i - 1, j)) || (i < a_.cols && isLong(i, j)));
+        const size_t n = (longEdge ? a_.longVertices : a_.edgeVertices) + 1;
+        const double waves = 1 + static_cast<int>(3 * unitHash(a_.seed, horizontal ? 5 : 6, i, j));
+        const double dx = b.lon - a.lon, dy = b.lat - a.lat;
+        vector<Point> pts(n + 1);
+        for (size_t k = 0; k <= n; ++k) {
+            const double t = static_cast<double>(k) / n;
+            // border edges stay straight so the tessellation exactly fills the bbox
+            const double off = border ? 0 : EDGE_WIGGLE * std::sin(PI * t) * std::sin(PI * waves * t);
+            pts[k] = Point{a.lon + dx * t - dy * off, a.lat + dy * t + dx * off};
+        }
+        pts.back() = b;
+        return pts;
+    }
+
+    // Appends pts (optionally reversed) to ring, dropping the last point, which the next edge starts with
+    static void append(vector<Point> pts, bool reversed, vector<Point>* ring) {
+        if (reversed) std::reverse(pts.begin(), pts.end());
+        ring->insert(ring->end(), pts.begin(), pts.end() - 1);
+    }
+
+    const GenArgs& a_;
+};
+
+// Buffered GeoJSON writer
+class GeoJsonOut {
+ public:
+    explicit GeoJsonOut(const string& path) : file_(path, std::ios::binary) {
+        if (!file_) throw std::runtime_error("Failed to open " + path);
+        buf_ = "{\"type\":\"FeatureCollection\",\"features\":[\n";
+    }
+
+    void feature(const string& name, const vector<vector<vector<Point>>>& polys) {
+        if (features_++ > 0) buf_ += ",\n";
+        buf_ += "{\"type\":\"Feature\",\"properties\":{\"name\":\"" + name + "\"},\"geometry\":{\"type\":\"";
+        buf_ += polys.size() == 1 ? "Polygon\",\"coordinates\":" : "MultiPolygon\",\"coordinates\":[";
+        for (size_t p = 0; p < polys.size(); ++p) {
+            if (p > 0) buf_ += ',';
+            buf_ += '[';
+            for (size_t r = 0; r < polys[p].size(); ++r) {
+                if (r > 0) buf_ += ',';
+                ring(polys[p][r]);
+            }
+            buf_ += ']';
+        }
+        buf_ += polys.size() == 1 ? "}}" : "]}}";
+        if (buf_.size() > (1u << 22)) flush();
+    }
+
+    // Closes the collection; returns bytes written
+    size_t finish() {
+        buf_ += "\n]}\n";
+        flush();
+        file_.close();
+        if (!file_) throw std::runtime_error("Failed to write GeoJSON");
+        return bytes_;
+    }
+
+ private:
+    void ring(const vector<Point>& pts) {
+        char num[64];
+        buf_ += '[';
+        for (size_t k = 0; k < pts.size(); ++k) {
+            const int len = std::snprintf(num, sizeof(num), "%s[%.8f,%.8f]", k > 0 ? "," : "", pts[k].lon, pts[k].lat);
+            buf_.append(num, static_cast<size_t>(len));
+        }
+        buf_ += ']';
+    }
+
+    void flush() {
+        file_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+        bytes_ += buf_.size();
+        buf_.clear();
+    }
+
+    std::ofstream file_;
+    string buf_;
+    size_t features_ = 0;
+    size_t bytes_ = 0;
+};
+
+bool parseGenArgs(int argc, char** argv, GenArgs* out) {
+    for (int i = 1; i < argc; ++i) {
+        const string a(argv[i]);
+        if (a == "--out" && i + 1 < argc) {
+            out->outPath = argv[++i];
+        } else if (a == "--cols" && i + 1 < argc) {
+            out->cols = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--rows" && i + 1 < argc) {
+            out->rows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--edge-vertices" && i + 1 < argc) {
+            out->edgeVertices = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--long-fraction" && i + 1 < argc) {
+            out->longFraction = std::strtod(argv[++i], nullptr);
+        } else if (a == "--long-vertices" && i + 1 < argc) {
+            out->longVertices = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--hole-fraction" && i + 1 < argc) {
+            out->holeFraction = std::strtod(argv[++i], nullptr);
+        } else if (a == "--bbox" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf,%lf", &out->minLon, &out->minLat, &out->maxLon, &out->maxLat) != 4)
+                return false;
+        } else if (a == "--seed" && i + 1 < argc) {
+            out->seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--verify" && i + 1 < argc) {
+            out->verifyPoints = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--no-measure") {
+            out->measure = false;
+        } else {
+            return false;
+        }
+    }
+    return !out->outPath.empty() && out->cols > 0 && out->rows > 0 && out->edgeVertices > 0 &&
+        out->minLon < out->maxLon && out->minLat < out->maxLat;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    GenArgs args;
+    if (!parseGenArgs(argc, argv, &args)) {
+        cerr << "Usage: " << argv[0] << " --out suburbs.geojson [--cols 60] [--rows 50] [--edge-vertices 16]\n"
+            << "    [--long-fraction 0.02] [--long-vertices 20000] [--hole-fraction 0.1]"
+            << " [--bbox minLon,minLat,maxLon,maxLat]\n"
+            << "    [--seed N] [--verify 100000] [--no-measure]\n";
+        return 1;
+    }
+
+    try {
+        // 1) Generate: one feature per cell, enclaves cut from their cell and given to the east neighbour
+        const Tessellation tess(args);
+        GeoJsonOut out(args.outPath);
+        size_t vertices = 0, holes = 0, longest = 0;
+        for (size_t j = 0; j < args.rows; ++j) {
+            for (size_t i = 0; i < args.cols; ++i) {
+                vector<vector<vector<Point>>> polys(1);
+                polys[0].push_back(tess.cellRing(i, j));
+                if (tess.hasHole(i, j)) {
+                    vector<Point> hole = tess.enclave(i, j);
+                    std::reverse(hole.begin(), hole.end());  // holes run clockwise
+                    polys[0].push_back(std::move(hole));
+                    ++holes;
+                }
+                const size_t west = i == 0 ? args.cols - 1 : i - 1;
+                if (tess.hasHole(west, j)) polys.push_back({tess.enclave(west, j)});
+                for (const auto& poly : polys) {
+                    for (const auto& ring : poly) {
+                        vertices += ring.size();
+                        longest = std::max(longest, ring.size());
+                    }
+                }
+                out.feature("Synthetic " + std::to_string(i) + "-" + std::to_string(j), polys);
+            }
+        }
+        const size_t bytes = out.finish();
+        const double mb = static_cast<double>(bytes) / (1 << 20);
+        cout << "Wrote " << args.cols * args.rows << " suburbs (" << holes << " enclaves, " << vertices
+            << " vertices, longest ring " << longest << ") to " << args.outPath << ": "
+            << std::fixed << std::setprecision(1) << mb << " MiB\n";
+        if (!args.measure) return 0;
+
+        // 2) Load and index, measuring throughput, time and peak memory
+        const double rssBefore = bench::peakRssMb();
+        vector<Suburb> suburbs;
+        double minLon, minLat, maxLon, maxLat;
+        const double loadSeconds = bench::bestSeconds(1, [&] {
+            suburbs = suburb::loadSuburbsGeoJSON(args.outPath, &minLon, &minLat, &maxLon, &maxLat);
+        });
+        const double rssLoaded = bench::peakRssMb();
+        const double gridSeconds = bench::bestSeconds(3, [&] { SuburbGrid grid(suburbs); });
+        const SuburbIndex index(std::move(suburbs));
+        const double rssIndexed = bench::peakRssMb();
+
+        // 3) Every sample point inside the bbox should fall in exactly one suburb
+        const SuburbGrid grid(index.suburbs());
+        const auto points = bench::uniformPoints(args.verifyPoints, args.minLon, args.minLat,
+            args.maxLon, args.maxLat, args.seed);
+        size_t gaps = 0, overlaps = 0;
+        for (const auto& p : points) {
+            size_t count = 0, hits = 0;
+            const uint32_t* ids = grid.candidates(p, &count);
+            for (size_t k = 0; k < count; ++k) hits += suburb::pointInSuburb(index.suburbs()[ids[k]], p) ? 1 : 0;
+            if (hits == 0) ++gaps;
+            if (hits > 1) ++overlaps;
+        }
+
+        json report = {
+            {"geojson", args.outPath}, {"suburbs", index.size()}, {"vertices", vertices},
+            {"longest_ring", longest}, {"enclaves", holes}, {"file_mb", mb},
+            {"load_seconds", loadSeconds}, {"load_mb_per_second", mb / loadSeconds},
+            {"load_peak_rss_growth_mb", rssLoaded - rssBefore}, {"grid_build_seconds", gridSeconds},
+            {"index_peak_rss_mb", rssIndexed}, {"verify_points", points.size()},
+            {"gaps", gaps}, {"overlaps", overlaps}};
+        cout << report.dump(2) << "\n";
+        if (gaps > 0 || overlaps > 0) {
+            cerr << "Tessellation check failed: " << gaps << " gaps, " << overlaps << " overlaps\n";
+            return 3;
+        }
+    } catch (const std::exception& e) {
+        cerr << "Fatal: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
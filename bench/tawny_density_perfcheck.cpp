@@ -0,0 +1,289 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Performance regression check: compares benchmark result JSON files (from
+// tawny_density_bench and tawny_density_scaling --json) with a committed
+// baseline. Each metric has a direction and a tolerance band; throughput below
+// the band, memory or work above it, or a changed deterministic output is a
+// regression. Throughput depends on the machine, so it is only compared with
+// --throughput, against the baseline recorded on the same host (CPU model and
+// count). With --update the baseline's metrics are replaced by the results.
+
+#include <nlohmann/json.hpp>  // for json
+#include <unistd.h>           // for sysconf, _SC_NPROCESSORS_ONLN
+#include <cmath>              // for fabs, isinf, HUGE_VAL
+#include <cstdio>             // for snprintf
+#include <cstdlib>            // for strtod
+#include <exception>          // for exception
+#include <fstream>            // for ifstream, ofstream
+#include <iostream>           // for cout, cerr
+#include <map>                // for map
+#include <stdexcept>          // for runtime_error
+#include <string>             // for string, getline, to_string
+#include <vector>             // for vector
+
+using std::cout;
+using std::cerr;
+using std::map;
+using std::string;
+using std::vector;
+using json = nlohmann::json;
+
+namespace {
+
+// Used when the baseline file does not exist yet (or has no tolerances):
+// better is higher, lower, equal (deterministic outputs) or ignore (too noisy
+// or derived from another metric); tolerance is a fraction of the baseline;
+// host marks metrics that are only comparable on the same machine
+const char DEFAULT_TOLERANCES[] = R"({
+    "queries_per_second":      {"better": "higher", "tolerance": 0.30, "host": true},
+    "observations_per_second": {"better": "higher", "tolerance": 0.30, "host": true},
+    "peak_rss_mb":             {"better": "lower",  "tolerance": 0.15},
+    "rss_growth_mb":           {"better": "lower",  "tolerance": 0.50},
+    "edges_per_query":         {"better": "lower",  "tolerance": 0.02},
+    "hit_rate":                {"better": "equal",  "tolerance": 0.001},
+    "assigned":                {"better": "equal",  "tolerance": 0},
+    "ns_per_query":            {"better": "ignore"},
+    "count_seconds":           {"better": "ignore"},
+    "report_seconds":          {"better": "ignore"},
+    "scaling_efficiency":      {"better": "ignore"}
+})";
+
+// Command line settings
+struct CheckArgs {
+    string baselinePath;
+    vector<string> resultPaths;
+    double toleranceScale = 1;
+    bool update = false;
+    bool throughput = false;
+};
+
+// One metric compared with its baseline
+struct Comparison {
+    string key;
+    string status;  // ok, improved, REGRESSED, MISSING or new
+    double baseline = 0, current = 0;
+    string allowed;  // the change allowed before a regression, e.g. "-30.0%" or "+/-0.1%"
+};
+
+// Names the machine host-bound metrics were measured on
+string hostKey() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    string line, model = "unknown CPU";
+    while (std::getline(cpuinfo, line)) {
+        const size_t colon = line.find(':');
+        if (line.rfind("model name", 0) == 0 && colon != string::npos && colon + 2 <= line.size()) {
+            model = line.substr(colon + 2);
+            break;
+        }
+    }
+    return model + " x" + std::to_string(sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+json readJson(const string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Failed to read " + path);
+    return json::parse(file);
+}
+
+// Flattens one results file into "benchmark field=value ... metric" -> value.
+// Fields of a result that are not metrics in tolerances identify it; top-level
+// numbers that are metrics (e.g. the process's peak_rss_mb) are keyed on the
+// benchmark alone.
+//
+// Args:
+//    results: a tawny_density_bench or tawny_density_scaling --json document
+//    tolerances: metric name -> {better, tolerance, host}
+//    out: flattened machine-independent metrics, added to here
+//    hostOut: flattened host-bound metrics, added to here
+void flatten(const json& results, const json& tolerances, map<string, double>* out, map<string, double>* hostOut) {
+    const string benchmark = results.value("benchmark", string("unknown"));
+    auto isMetric = [&](const string& name) {
+        return tolerances.contains(name) && tolerances[name].value("better", string("ignore")) != "ignore";
+    };
+    auto add = [&](const string& key, const string& metric, double value) {
+        (tolerances[metric].value("host", false) ? *hostOut : *out)[key] = value;
+    };
+    for (const auto& item : results.items()) {
+        if (item.value().is_number() && isMetric(item.key()))
+            add(benchmark + " " + item.key(), item.key(), item.value());
+    }
+    for (const auto& r : results.value("results", json::array())) {
+        string identity = benchmark;
+        for (const auto& field : r.items()) {
+            if (tolerances.contains(field.key())) continue;
+            identity += " " + field.key() + "=" + (field.value().is_string() ? field.value().get<string>()
+                : field.value().dump());
+        }
+        for (const auto& field : r.items()) {
+            if (field.value().is_number() && isMetric(field.key()))
+                add(identity + " " + field.key(), field.key(), field.value());
+        }
+    }
+}
+
+string percent(double fraction) {
+    if (std::isinf(fraction)) return "n/a";
+    char text[32];
+    std::snprintf(text, sizeof(text), "%+.1f%%", fraction * 100);
+    return text;
+}
+
+// Compares one metric
+//
+// Args:
+//    key: flattened metric key; its last word names the metric
+//    baseline: the committed value
+//    current: the measured value
+//    spec: {better, tolerance} for the metric
+//    scale: multiplies the tolerance
+// Returns:
+//    the comparison, with status ok, improved or REGRESSED
+Comparison compare(const string& key, double baseline, double current, const json& spec, double scale) {
+    Comparison c{key, "ok", baseline, current, ""};
+    const string better = spec.value("better", string("higher"));
+    const double tolerance = spec.value("tolerance", 0.0) * scale;
+    const double change = baseline == 0 ? (current == 0 ? 0 : HUGE_VAL) : (current - baseline) / std::fabs(baseline);
+    if (better == "higher") {
+        c.allowed = percent(-tolerance);
+        if (change < -tolerance) c.status = "REGRESSED";
+        else if (change > tolerance) c.status = "improved";
+    } else if (better == "lower") {
+        c.allowed = percent(tolerance);
+        if (change > tolerance) c.status = "REGRESSED";
+        else if (change < -tolerance) c.status = "improved";
+    } else {
+        c.allowed = "+/-" + percent(tolerance).substr(1);
+        const double diff = std::fabs(current - baseline);
+        if (diff > tolerance * std::fabs(baseline) && diff > 1e-12) c.status = "REGRESSED";
+    }
+    return c;
+}
+
+bool parseCheckArgs(int argc, char** argv, CheckArgs* out) {
+    for (int i = 1; i < argc; ++i) {
+        const string a(argv[i]);
+        if (a == "--baseline" && i + 1 < argc) {
+            out->baselinePath = argv[++i];
+        } else if (a == "--tolerance-scale" && i + 1 < argc) {
+            out->toleranceScale = std::strtod(argv[++i], nullptr);
+        } else if (a == "--update") {
+            out->update = true;
+        } else if (a == "--throughput") {
+            out->throughput = true;
+        } else if (!a.empty() && a[0] != '-') {
+            out->resultPaths.push_back(a);
+        } else {
+            return false;
+        }
+    }
+    return !out->baselinePath.empty() && !out->resultPaths.empty() && out->toleranceScale > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    CheckArgs args;
+    if (!parseCheckArgs(argc, argv, &args)) {
+        cerr << "Usage: " << argv[0] << " --baseline baseline.json [--tolerance-scale 1] [--throughput] [--update]"
+            << " results.json...\n";
+        return 1;
+    }
+
+    try {
+        json baseline = json::object();
+        if (std::ifstream(args.baselinePath)) baseline = readJson(args.baselinePath);
+        else if (!args.update) throw std::runtime_error("No baseline at " + args.baselinePath + "; run with --update");
+        if (!baseline.contains("tolerances")) baseline["tolerances"] = json::parse(DEFAULT_TOLERANCES);
+        const json& tolerances = baseline["tolerances"];
+
+        map<string, double> current, hostCurrent;
+        for (const auto& path : args.resultPaths) flatten(readJson(path), tolerances, &current, &hostCurrent);
+        const string host = hostKey();
+
+        if (args.update) {
+            baseline["metrics"] = current;
+            baseline["hosts"][host]["metrics"] = hostCurrent;
+            std::ofstream file(args.baselinePath);
+            file << baseline.dump(2) << "\n";
+            if (!file) throw std::runtime_error("Failed to write " + args.baselinePath);
+            cout << "Wrote " << current.size() << " metrics, and " << hostCurrent.size() << " for host " << host
+                << ", to " << args.baselinePath << "\n";
+            return 0;
+        }
+
+        json metrics = baseline.value("metrics", json::object());
+        if (args.throughput) {
+            const json hosts = baseline.value("hosts", json::object());
+            if (!hosts.contains(host))
+                throw std::runtime_error("No throughput baseline for host " + host + "; run perf-baseline on it");
+            metrics.update(hosts[host].value("metrics", json::object()));
+            current.insert(hostCurrent.begin(), hostCurrent.end());
+            cout << "Comparing throughput with the baseline for " << host << "\n\n";
+        }
+
+        vector<Comparison> comparisons;
+        for (const auto& item : metrics.items()) {
+            const string& key = item.key();
+            const auto it = current.find(key);
+            if (it == current.end()) {
+                comparisons.push_back(Comparison{key, "MISSING", item.value(), 0, ""});
+                continue;
+            }
+            const string metric = key.substr(key.rfind(' ') + 1);
+            comparisons.push_back(compare(key, item.value(), it->second, tolerances.value(metric, json::object()),
+                args.toleranceScale));
+        }
+        for (const auto& [key, value] : current) {
+            if (!metrics.contains(key)) comparisons.push_back(Comparison{key, "new", 0, value, ""});
+        }
+
+        // regressions first, then everything else in key order
+        size_t regressed = 0, missing = 0, improved = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (const auto& c : comparisons) {
+                const bool bad = c.status == "REGRESSED" || c.status == "MISSING";
+                if (bad != (pass == 0)) continue;
+                regressed += c.status == "REGRESSED";
+                missing += c.status == "MISSING";
+                improved += c.status == "improved";
+                char line[128];
+                if (c.status == "MISSING") {
+                    std::snprintf(line, sizeof(line), "%14.6g  %14s", c.baseline, "-");
+                } else if (c.status == "new") {
+                    std::snprintf(line, sizeof(line), "%14s  %14.6g", "-", c.current);
+                } else {
+                    std::snprintf(line, sizeof(line), "%14.6g  %14.6g  %8s  (allowed %s)", c.baseline, c.current,
+                        percent(c.baseline == 0 ? 0 : (c.current - c.baseline) / std::fabs(c.baseline)).c_str(),
+                        c.allowed.c_str());
+                }
+                cout << (c.status == "ok" ? "  " : "* ") << std::left;
+                cout.width(10);
+                cout << c.status << c.key << "\n              " << line << "\n";
+            }
+        }
+        cout << "\n" << comparisons.size() << " metrics against " << args.baselinePath << ": " << regressed
+            << " regressed, " << missing << " missing, " << improved << " improved\n";
+        if (regressed + missing > 0) {
+            cout << "perf-check FAILED (rerun with --tolerance-scale on a noisy machine; refresh the baseline with"
+                << " the perf-baseline target only for intended changes)\n";
+            return 3;
+        }
+        if (improved > 0) cout << "Consider refreshing the baseline with the perf-baseline target\n";
+    } catch (const std::exception& e) {
+        cerr << "Fatal: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
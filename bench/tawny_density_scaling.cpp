@@ -0,0 +1,225 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end scaling benchmark: generates synthetic observation sets inside
+// the suburbs' bbox and times the offline count, rank and report path at each
+// thread count, reporting throughput, scaling efficiency and how far each run
+// raised the process's peak RSS.
+
+#include <nlohmann/json.hpp>  // for json
+#include <algorithm>          // for max
+#include <cstddef>            // for size_t
+#include <cstdint>            // for uint64_t
+#include <cstdlib>            // for strtod, strtoull
+#include <exception>          // for exception
+#include <fstream>            // for ofstream
+#include <iomanip>            // for setw, setprecision
+#include <iostream>           // for cout, cerr
+#include <sstream>            // for istringstream
+#include <stdexcept>          // for runtime_error
+#include <string>             // for string, getline
+#include <thread>             // for thread
+#include <vector>             // for vector
+#include "bench_common.hpp"   // for syntheticObservations, Distribution, bestSeconds, resetPeakRss, ...
+#include "counts.hpp"         // for CountMatrix, CountStats, countObservations
+#include "csv_writer.hpp"     // for writeCountsCsv, writeSeriesCsv
+#include "main.hpp"           // for SPRING_2025_START_DATE, SPRING_2025_END_DATE
+#include "observations.hpp"   // for ObsPoint, parseIsoDate
+#include "ranking.hpp"        // for topK, orderSuburbs, SortOrder
+#include "suburb_index.hpp"   // for SuburbIndex
+
+using std::cout;
+using std::cerr;
+using json = nlohmann::json;
+
+using bench::Distribution;
+using counts::CountMatrix;
+using counts::CountStats;
+using suburb::SuburbIndex;
+
+namespace {
+
+const int BUCKET_DAYS = 7;
+const size_t TOP = 10;
+
+// Command line settings
+struct ScalingArgs {
+    string geojsonPath = TAWNY_DEFAULT_GEOJSON;
+    vector<size_t> sizes = {10000, 100000, 1000000};
+    vector<unsigned> threads;  // empty = 1, 2, 4, ... up to the core count
+    vector<Distribution> distributions = {Distribution::Uniform, Distribution::Clustered, Distribution::RealLike};
+    uint64_t seed = bench::DEFAULT_SEED;
+    int repeat = 3;
+    string outDir;  // CSV reports go to /dev/null unless set
+    string jsonPath;
+};
+
+// One timed run of the pipeline
+struct Result {
+    Distribution distribution = Distribution::Uniform;
+    size_t observations = 0;
+    unsigned threads = 1;
+    double countSeconds = 0;
+    double reportSeconds = 0;
+    size_t assigned = 0;
+    double rssGrowthMb = 0;  // peak RSS during the runs above the RSS before them
+};
+
+// Comma separated list of numbers; false on an empty or malformed list
+template <typename T>
+bool parseList(const string& text, vector<T>* out) {
+    out->clear();
+    std::istringstream in(text);
+    string item;
+    while (std::getline(in, item, ',')) {
+        char* end = nullptr;
+        const double v = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || v < 1) return false;
+        out->push_back(static_cast<T>(v));
+    }
+    return !out->empty();
+}
+
+bool parseScalingArgs(int argc, char** argv, ScalingArgs* out) {
+    for (int i = 1; i < argc; ++i) {
+        const string a(argv[i]);
+        if (a == "--geojson" && i + 1 < argc) {
+            out->geojsonPath = argv[++i];
+        } else if (a == "--sizes" && i + 1 < argc) {
+            if (!parseList(argv[++i], &out->sizes)) return false;
+        } else if (a == "--threads" && i + 1 < argc) {
+            if (!parseList(argv[++i], &out->threads)) return false;
+        } else if (a == "--distributions" && i + 1 < argc) {
+            out->distributions.clear();
+            std::istringstream in(argv[++i]);
+            string name;
+            while (std::getline(in, name, ',')) out->distributions.push_back(bench::parseDistribution(name));
+        } else if (a == "--seed" && i + 1 < argc) {
+            out->seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (a == "--repeat" && i + 1 < argc) {
+            out->repeat = static_cast<int>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (a == "--out-dir" && i + 1 < argc) {
+            out->outDir = argv[++i];
+        } else if (a == "--json" && i + 1 < argc) {
+            out->jsonPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    if (out->threads.empty()) {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned t = 1; t < cores; t *= 2) out->threads.push_back(t);
+        out->threads.push_back(cores);
+    }
+    return out->repeat > 0 && !out->distributions.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    ScalingArgs args;
+    try {
+        if (!parseScalingArgs(argc, argv, &args)) throw std::runtime_error("bad arguments");
+    } catch (const std::exception&) {
+        cerr << "Usage: " << argv[0] << " [--geojson suburbs.geojson] [--sizes 1e4,1e5,1e6] [--threads 1,2,4]\n"
+            << "    [--distributions uniform,clustered,reallike] [--seed N] [--repeat 3] [--out-dir DIR]"
+            << " [--json results.json]\n";
+        return 1;
+    }
+
+    try {
+        double minLon, minLat, maxLon, maxLat;
+        const SuburbIndex index(suburb::loadSuburbsGeoJSON(args.geojsonPath, &minLon, &minLat, &maxLon, &maxLat));
+        const vector<Suburb>& suburbs = index.suburbs();
+        const int firstDay = observations::parseIsoDate(SPRING_2025_START_DATE);
+        const int lastDay = observations::parseIsoDate(SPRING_2025_END_DATE);
+        const string countsPath = args.outDir.empty() ? "/dev/null" : args.outDir + "/scaling_counts.csv";
+        const string seriesPath = args.outDir.empty() ? "/dev/null" : args.outDir + "/scaling_series.csv";
+        vector<Result> results;
+        bool peakResets = true;
+
+        for (Distribution d : args.distributions) {
+            for (size_t n : args.sizes) {
+                // generated once per size; ~40 bytes an observation, so 1e8 needs about 4 GB
+                const vector<ObsPoint> obs = bench::syntheticObservations(n, d, suburbs, firstDay, lastDay,
+                    args.seed + n);
+                for (unsigned t : args.threads) {
+                    Result r;
+                    r.distribution = d;
+                    r.observations = n;
+                    r.threads = t;
+                    CountMatrix matrix;
+                    CountStats stats;
+                    peakResets = bench::resetPeakRss() && peakResets;
+                    const double rssBefore = bench::currentRssMb();
+                    r.countSeconds = bench::bestSeconds(args.repeat, [&] {
+                        matrix = counts::countObservations(index, obs, firstDay, lastDay, BUCKET_DAYS, t, &stats);
+                    });
+                    r.assigned = stats.assigned;
+                    // rank and report exactly as the main tool does for --top, --out and --series-csv
+                    r.reportSeconds = bench::bestSeconds(args.repeat, [&] {
+                        const vector<uint64_t> totals = matrix.totals();
+                        ranking::topK(totals, TOP, t);
+                        const auto order = ranking::orderSuburbs(suburbs, totals, ranking::SortOrder::Count);
+                        csv::writeCountsCsv(countsPath, suburbs, totals, order);
+                        csv::writeSeriesCsv(seriesPath, suburbs, matrix, order);
+                    });
+                    r.rssGrowthMb = std::max(0.0, bench::peakRssSinceResetMb() - rssBefore);
+                    results.push_back(r);
+                }
+            }
+        }
+
+        cout << std::left << std::setw(11) << "dataset" << std::right << std::setw(11) << "obs"
+            << std::setw(8) << "threads" << std::setw(11) << "count ms" << std::setw(11) << "report ms"
+            << std::setw(14) << "obs/s" << std::setw(11) << "efficiency" << std::setw(11) << "+RSS MiB" << "\n";
+        json out;
+        out["benchmark"] = "tawny_density_scaling";
+        out["geojson"] = args.geojsonPath;
+        out["suburbs"] = suburbs.size();
+        out["seed"] = args.seed;
+        out["results"] = json::array();
+        double baseline = 0;
+        for (const auto& r : results) {
+            const double seconds = r.countSeconds + r.reportSeconds;
+            const double throughput = static_cast<double>(r.observations) / seconds;
+            // efficiency against the first (usually single-thread) run of the same dataset and size
+            if (&r == &results.front() || r.distribution != (&r - 1)->distribution ||
+                r.observations != (&r - 1)->observations)
+                baseline = throughput / r.threads;
+            const double efficiency = throughput / (baseline * r.threads);
+            cout << std::left << std::setw(11) << bench::distributionName(r.distribution) << std::right
+                << std::setw(11) << r.observations << std::setw(8) << r.threads << std::fixed
+                << std::setprecision(2) << std::setw(11) << r.countSeconds * 1e3 << std::setw(11)
+                << r.reportSeconds * 1e3 << std::setprecision(0) << std::setw(14) << throughput
+                << std::setprecision(2) << std::setw(11) << efficiency << std::setprecision(1) << std::setw(11)
+                << r.rssGrowthMb << "\n";
+            out["results"].push_back({
+                {"dataset", bench::distributionName(r.distribution)}, {"observations", r.observations},
+                {"threads", r.threads}, {"count_seconds", r.countSeconds}, {"report_seconds", r.reportSeconds},
+                {"observations_per_second", throughput}, {"scaling_efficiency", efficiency},
+                {"assigned", r.assigned}, {"rss_growth_mb", r.rssGrowthMb}});
+        }
+        if (!peakResets) cerr << "Peak RSS cannot be reset here; +RSS includes earlier runs\n";
+        if (!args.jsonPath.empty()) {
+            std::ofstream file(args.jsonPath);
+            file << out.dump(2) << "\n";
+            if (!file) throw std::runtime_error("Failed to write " + args.jsonPath);
+        }
+    } catch (const std::exception& e) {
+        cerr << "Fatal: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,288 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "assign.hpp"
+#include <algorithm>         // for max
+#include <cctype>            // for tolower
+#include <charconv>          // for from_chars
+#include <cmath>             // for isfinite
+#include <cstdint>           // for uint32_t, uint64_t
+#include <cstring>           // for memchr, memmove
+#include <istream>           // for istream
+#include <stdexcept>         // for runtime_error
+#include <string>            // for string
+#include <string_view>       // for string_view
+#include <vector>            // for vector
+#include "csv_writer.hpp"    // for CsvWriter
+#include "parallel.hpp"      // for parallelFor, resolveThreads
+#include "suburb.hpp"        // for Point, NO_SUBURB
+#include "suburb_index.hpp"  // for SuburbIndex
+#include "trace.hpp"         // for Span, setThreadName
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::runtime_error;
+using std::from_chars;
+
+using parallel::parallelFor;
+using suburb::NO_SUBURB;
+
+namespace assign {
+
+namespace {
+
+// Strips spaces, a trailing carriage return and surrounding double quotes
+string_view trimField(string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '"')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '"' || s.back() == '\r')) s.remove_suffix(1);
+    return s;
+}
+
+// Splits a row on delimiter (no quoted delimiters)
+vector<string_view> splitRow(string_view row, char delimiter) {
+    vector<string_view> fields;
+    size_t start = 0;
+    while (true) {
+        const size_t end = row.find(delimiter, start);
+        fields.push_back(trimField(row.substr(start, end == string_view::npos ? string_view::npos : end - start)));
+        if (end == string_view::npos) break;
+        start = end + 1;
+    }
+    return fields;
+}
+
+// Lower-cased copy
+string lower(string_view s) {
+    string out(s);
+    for (auto& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+bool isLonName(const string& name) {
+    return name == "lon" || name == "lng" || name == "long" || name == "longitude" ||
+        name == "decimallongitude" || name == "x";
+}
+
+bool isLatName(const string& name) {
+    return name == "lat" || name == "latitude" || name == "decimallatitude" || name == "y";
+}
+
+// Parses one trimmed numeric field
+bool parseNumber(string_view field, double* out) {
+    field = trimField(field);
+    if (field.empty()) return false;
+    const auto r = from_chars(field.data(), field.data() + field.size(), *out);
+    return r.ec == std::errc() && r.ptr == field.data() + field.size();
+}
+
+}  // namespace
+
+// Picks the delimiter (tab if the line has tabs but no commas) and, when the
+// first line is a header, the longitude and latitude columns by name
+// (lon/lng/longitude/decimalLongitude/x and lat/latitude/decimalLatitude/y,
+// any case). Without a header the coordinates are columns 0 (lon) and 1 (lat).
+//
+// Args:
+//    firstLine: the first line of input, without its newline
+//    out: set to the layout
+// Returns:
+//    true if firstLine is a header (and so not a data row)
+bool detectLayout(string_view firstLine, RowLayout* out) {
+    *out = RowLayout();
+    if (firstLine.find('\t') != string_view::npos && firstLine.find(',') == string_view::npos)
+        out->delimiter = '\t';
+    const vector<string_view> fields = splitRow(firstLine, out->delimiter);
+    double value;
+    if (fields.size() >= 2 && parseNumber(fields[0], &value) && parseNumber(fields[1], &value)) return false;
+
+    bool lonFound = false, latFound = false;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const string name = lower(fields[i]);
+        if (!lonFound && isLonName(name)) {
+            out->lonColumn = i;
+            lonFound = true;
+        } else if (!latFound && isLatName(name)) {
+            out->latColumn = i;
+            latFound = true;
+        }
+    }
+    if (!lonFound || !latFound) throw runtime_error("Header has no longitude/latitude columns: " + string(firstLine));
+    return true;
+}
+
+// Parses the coordinates of one row
+//
+// Args:
+//    begin: start of the row
+//    end: end of the row (excluding the newline)
+//    layout: delimiter and coordinate columns
+//    out: set to the point
+// Returns:
+//    false if either coordinate is missing, not a number or out of range
+bool parseRow(const char* begin, const char* end, const RowLayout& layout, Point* out) {
+    const size_t last = std::max(layout.lonColumn, layout.latColumn);
+    double lon = 0, lat = 0;
+    bool haveLon = false, haveLat = false;
+    const char* field = begin;
+    for (size_t column = 0; column <= last; ++column) {
+        if (field > end) return false;
+        const auto* stop = static_cast<const char*>(std::memchr(field, layout.delimiter, end - field));
+        const char* fieldEnd = stop ? stop : end;
+        if (column == layout.lonColumn) haveLon = parseNumber(string_view(field, fieldEnd - field), &lon);
+        if (column == layout.latColumn) haveLat = parseNumber(string_view(field, fieldEnd - field), &lat);
+        field = fieldEnd + 1;
+    }
+    if (!haveLon || !haveLat || !std::isfinite(lon) || !std::isfinite(lat) ||
+        lon < -180 || lon > 180 || lat < -90 || lat > 90)
+        return false;
+    *out = Point{lon, lat};
+    return true;
+}
+
+// Streams delimited lon/lat rows and assigns each to a suburb. Input is read
+// in chunks; each chunk is split at line boundaries into one piece per thread,
+// and every thread parses and locates its piece. Counts are kept per thread
+// and summed at the end.
+//
+// Args:
+//    in: the rows (header optional, see detectLayout)
+//    index: the suburb index
+//    threads: number of threads to use (0 = hardware concurrency)
+//    outCounts: set to per-suburb counts indexed by suburb id
+//    ids: if not null, gets one row per data row: the suburb id, or empty if in no suburb
+//    chunkBytes: bytes read per chunk (grown if a single line is longer)
+// Returns:
+//    row tallies
+AssignStats assignPoints(std::istream& in, const SuburbIndex& index, unsigned threads,
+    vector<uint64_t>* outCounts, CsvWriter* ids, size_t chunkBytes) {
+    const size_t suburbs = index.size();
+    const unsigned workers = parallel::resolveThreads(threads);
+    vector<vector<uint64_t>> counts(workers, vector<uint64_t>(suburbs, 0));
+    vector<AssignStats> stats(workers);
+    vector<vector<uint32_t>> pieceIds(workers);
+
+    RowLayout layout;
+    bool firstLine = true;
+    vector<char> buf(std::max<size_t>(chunkBytes, 64));
+    size_t carry = 0;
+
+    // Parses and locates every row in [begin, end)
+    auto process = [&](const char* begin, const char* end) {
+        if (firstLine) {
+            const auto* nl = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            const char* lineEnd = nl ? nl : end;
+            if (detectLayout(string_view(begin, lineEnd - begin), &layout)) begin = nl ? nl + 1 : end;
+            firstLine = false;
+        }
+        // piece boundaries fall just after a newline
+        vector<const char*> cuts{begin};
+        for (unsigned k = 1; k < workers; ++k) {
+            const char* cut = std::max(cuts.back(), begin + (end - begin) * k / workers);
+            const auto* nl = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+            cuts.push_back(nl ? nl + 1 : end);
+        }
+        cuts.push_back(end);
+
+        parallelFor(workers, threads, [&](size_t first, size_t last, unsigned w) {
+            if (w > 0) trace::setThreadName("assign worker");
+            trace::Span span("assign_batch", "assign");
+            const uint64_t rowsBefore = stats[w].rows;
+            for (size_t piece = first; piece < last; ++piece) {
+                vector<uint32_t>& out = pieceIds[piece];
+                out.clear();
+                const char* row = cuts[piece];
+                while (row < cuts[piece + 1]) {
+                    const auto* nl = static_cast<const char*>(std::memchr(row, '\n', cuts[piece + 1] - row));
+                    const char* rowEnd = nl ? nl : cuts[piece + 1];
+                    const char* next = nl ? nl + 1 : rowEnd;
+                    if (rowEnd > row && rowEnd[-1] == '\r') --rowEnd;
+                    if (rowEnd == row) {
+                        row = next;
+                        continue;
+                    }
+                    ++stats[w].rows;
+                    Point point;
+                    uint32_t id = NO_SUBURB;
+                    if (parseRow(row, rowEnd, layout, &point)) {
+                        id = index.locate(point);
+                    } else {
+                        ++stats[w].skipped;
+                    }
+                    if (id != NO_SUBURB) {
+                        ++counts[w][id];
+                        ++stats[w].assigned;
+                    }
+                    out.push_back(id);
+                    row = next;
+                }
+            }
+            span.setItems(static_cast<int64_t>(stats[w].rows - rowsBefore));
+        });
+
+        if (!ids) return;
+        trace::Span span("write_ids", "assign");
+        for (const auto& piece : pieceIds) {
+            for (uint32_t id : piece) {
+                if (id == NO_SUBURB) {
+                    ids->raw("");
+                } else {
+                    ids->integer(id);
+                }
+                ids->endRow();
+            }
+        }
+    };
+
+    while (true) {
+        in.read(buf.data() + carry, static_cast<std::streamsize>(buf.size() - carry));
+        const size_t n = carry + static_cast<size_t>(in.gcount());
+        if (in.bad()) throw runtime_error("Failed to read points");
+        const bool eof = !in;
+        if (n == 0) break;
+
+        size_t complete = n;
+        if (!eof) {
+            complete = 0;
+            for (size_t i = n; i > 0; --i) {
+                if (buf[i - 1] == '\n') {
+                    complete = i;
+                    break;
+                }
+            }
+            if (complete == 0) {
+                // a single line longer than the buffer
+                carry = n;
+                buf.resize(buf.size() * 2);
+                continue;
+            }
+        }
+        process(buf.data(), buf.data() + complete);
+        carry = n - complete;
+        std::memmove(buf.data(), buf.data() + complete, carry);
+        if (eof) break;
+    }
+
+    AssignStats total;
+    outCounts->assign(suburbs, 0);
+    for (unsigned w = 0; w < workers; ++w) {
+        for (size_t s = 0; s < suburbs; ++s) (*outCounts)[s] += counts[w][s];
+        total.rows += stats[w].rows;
+        total.assigned += stats[w].assigned;
+        total.skipped += stats[w].skipped;
+    }
+    return total;
+}
+
+}  // namespace assign
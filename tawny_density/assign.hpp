@@ -0,0 +1,58 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_ASSIGN_HPP_
+#define TAWNY_DENSITY_ASSIGN_HPP_
+
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint64_t
+#include <istream>           // for istream
+#include <string_view>       // for string_view
+#include <vector>            // for vector
+#include "csv_writer.hpp"    // for CsvWriter
+#include "suburb.hpp"        // for Point
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::string_view;
+using std::vector;
+using csv::CsvWriter;
+using suburb::Point;
+using suburb::SuburbIndex;
+
+namespace assign {
+
+const size_t DEFAULT_CHUNK_BYTES = 8 << 20;  // input is read, parsed and located 8 MiB at a time
+
+// Where the coordinates sit in each delimited row
+struct RowLayout {
+    char delimiter = ',';
+    size_t lonColumn = 0;
+    size_t latColumn = 1;
+};
+
+// What assignPoints did with the rows
+struct AssignStats {
+    size_t rows = 0;      // data rows read (blank lines and the header excluded)
+    size_t assigned = 0;  // rows inside a suburb
+    size_t skipped = 0;   // rows without two valid coordinates
+};
+
+bool detectLayout(string_view firstLine, RowLayout* out);
+bool parseRow(const char* begin, const char* end, const RowLayout& layout, Point* out);
+AssignStats assignPoints(std::istream& in, const SuburbIndex& index, unsigned threads,
+    vector<uint64_t>* outCounts, CsvWriter* ids, size_t chunkBytes = DEFAULT_CHUNK_BYTES);
+
+}  // namespace assign
+
+#endif  // TAWNY_DENSITY_ASSIGN_HPP_
@@ -0,0 +1,420 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Arrow IPC file writer for the count series. Only the small part of the
+// FlatBuffers encoding that Arrow's metadata needs is implemented here, so the
+// output has no dependency on the Arrow or FlatBuffers libraries.
+// See https://arrow.apache.org/docs/format/Columnar.html#ipc-file-format
+// All values are written little-endian (the host byte order on supported platforms).
+
+#include "columnar.hpp"
+#include <cstddef>     // for size_t
+#include <cstdint>     // for int16_t, int32_t, int64_t, uint8_t, uint32_t
+#include <cstring>     // for memcpy
+#include <fstream>     // for ofstream
+#include <memory>      // for shared_ptr, make_shared
+#include <stdexcept>   // for runtime_error
+#include <string>      // for string
+#include <utility>     // for move
+#include <vector>      // for vector
+#include "counts.hpp"  // for CountMatrix
+#include "suburb.hpp"  // for Suburb
+
+using std::string;
+using std::vector;
+using std::runtime_error;
+using std::shared_ptr;
+using std::make_shared;
+using std::ofstream;
+
+using counts::CountMatrix;
+using suburb::Suburb;
+
+namespace columnar {
+
+namespace {
+
+// ---------------------------------------------------------------------
+// Minimal FlatBuffers serializer. Objects are emitted parent-first, so
+// every offset points forward as the format requires.
+// ---------------------------------------------------------------------
+
+struct FbObject;
+using FbRef = shared_ptr<FbObject>;
+
+// One table field: an inline scalar or an offset to a child object
+struct FbField {
+    int id{};
+    vector<uint8_t> bytes;  // scalar value (empty for offset fields)
+    FbRef child;            // offset target (null for scalar fields)
+};
+
+struct FbObject {
+    enum Kind { Table, String, StructVector, TableVector } kind = Table;
+    vector<FbField> fields;   // Table
+    string text;              // String
+    vector<uint8_t> structs;  // StructVector: packed elements
+    size_t count = 0;         // StructVector: element count
+    vector<FbRef> tables;     // TableVector
+};
+
+template <typename T>
+void put(vector<uint8_t>* buf, size_t pos, T value) {
+    std::memcpy(buf->data() + pos, &value, sizeof(T));
+}
+
+template <typename T>
+void append(vector<uint8_t>* buf, T value) {
+    buf->resize(buf->size() + sizeof(T));
+    put(buf, buf->size() - sizeof(T), value);
+}
+
+void padTo(vector<uint8_t>* buf, size_t alignment, size_t bias = 0) {
+    while ((buf->size() + bias) % alignment != 0) buf->push_back(0);
+}
+
+// Builder helpers for table fields
+struct TableBuilder {
+    FbRef obj = make_shared<FbObject>();
+
+    template <typename T>
+    TableBuilder& scalar(int id, T value) {
+        FbField f;
+        f.id = id;
+        f.bytes.resize(sizeof(T));
+        std::memcpy(f.bytes.data(), &value, sizeof(T));
+        obj->fields.push_back(std::move(f));
+        return *this;
+    }
+
+    TableBuilder& child(int id, FbRef value) {
+        FbField f;
+        f.id = id;
+        f.child = std::move(value);
+        obj->fields.push_back(std::move(f));
+        return *this;
+    }
+
+    FbRef build() { return obj; }
+};
+
+FbRef fbString(const string& text) {
+    auto obj = make_shared<FbObject>();
+    obj->kind = FbObject::String;
+    obj->text = text;
+    return obj;
+}
+
+FbRef fbTables(vector<FbRef> tables) {
+    auto obj = make_shared<FbObject>();
+    obj->kind = FbObject::TableVector;
+    obj->tables = std::move(tables);
+    return obj;
+}
+
+// Vector of 8-byte aligned structs made of int64 words
+FbRef fbStructs(const vector<int64_t>& words, size_t wordsPerStruct) {
+    auto obj = make_shared<FbObject>();
+    obj->kind = FbObject::StructVector;
+    obj->count = words.size() / wordsPerStruct;
+    obj->structs.resize(words.size() * sizeof(int64_t));
+    std::memcpy(obj->structs.data(), words.data(), obj->structs.size());
+    return obj;
+}
+
+// Writes obj at the end of buf
+// Returns:
+//    position that offsets to obj must point at
+size_t emit(const FbObject& obj, vector<uint8_t>* buf) {
+    switch (obj.kind) {
+    case FbObject::String: {
+        padTo(buf, 4);
+        const size_t pos = buf->size();
+        append(buf, static_cast<uint32_t>(obj.text.size()));
+        buf->insert(buf->end(), obj.text.begin(), obj.text.end());
+        buf->push_back(0);
+        return pos;
+    }
+    case FbObject::StructVector: {
+        padTo(buf, 8, 4);  // elements (after the length) must be 8-byte aligned
+        const size_t pos = buf->size();
+        append(buf, static_cast<uint32_t>(obj.count));
+        buf->insert(buf->end(), obj.structs.begin(), obj.structs.end());
+        return pos;
+    }
+    case FbObject::TableVector: {
+        padTo(buf, 4);
+        const size_t pos = buf->size();
+        append(buf, static_cast<uint32_t>(obj.tables.size()));
+        const size_t slots = buf->size();
+        buf->resize(slots + 4 * obj.tables.size());
+        for (size_t i = 0; i < obj.tables.size(); ++i) {
+            const size_t target = emit(*obj.tables[i], buf);
+            put(buf, slots + 4 * i, static_cast<uint32_t>(target - (slots + 4 * i)));
+        }
+        return pos;
+    }
+    case FbObject::Table:
+        break;
+    }
+
+    // Lay out the table inline: soffset to the vtable, then widest fields first
+    int maxId = -1;
+    for (const auto& f : obj.fields) maxId = f.id > maxId ? f.id : maxId;
+    vector<uint16_t> fieldOffset(static_cast<size_t>(maxId + 1), 0);
+    vector<const FbField*> ordered;
+    for (size_t width : {8, 4, 2, 1}) {
+        for (const auto& f : obj.fields) {
+            const size_t size = f.child ? 4 : f.bytes.size();
+            if (size == width) ordered.push_back(&f);
+        }
+    }
+    size_t inlineSize = 4;
+    for (const FbField* f : ordered) {
+        const size_t size = f->child ? 4 : f->bytes.size();
+        inlineSize = (inlineSize + size - 1) / size * size;
+        fieldOffset[static_cast<size_t>(f->id)] = static_cast<uint16_t>(inlineSize);
+        inlineSize += size;
+    }
+
+    // vtable
+    padTo(buf, 2);
+    const size_t vtable = buf->size();
+    append(buf, static_cast<uint16_t>(4 + 2 * fieldOffset.size()));
+    append(buf, static_cast<uint16_t>(inlineSize));
+    for (uint16_t off : fieldOffset) append(buf, off);
+
+    // table
+    padTo(buf, 8);
+    const size_t table = buf->size();
+    buf->resize(table + inlineSize, 0);
+    put(buf, table, static_cast<int32_t>(table - vtable));
+    for (const FbField* f : ordered) {
+        if (!f->child) std::memcpy(buf->data() + table + fieldOffset[f->id], f->bytes.data(), f->bytes.size());
+    }
+    for (const FbField* f : ordered) {
+        if (!f->child) continue;
+        const size_t slot = table + fieldOffset[f->id];
+        const size_t target = emit(*f->child, buf);
+        put(buf, slot, static_cast<uint32_t>(target - slot));
+    }
+    return table;
+}
+
+// Serializes a root table as a complete flatbuffer
+vector<uint8_t> finish(const FbRef& root) {
+    vector<uint8_t> buf(4, 0);
+    const size_t pos = emit(*root, &buf);
+    put(&buf, 0, static_cast<uint32_t>(pos));
+    return buf;
+}
+
+// ---------------------------------------------------------------------
+// Arrow metadata (Schema.fbs / Message.fbs / File.fbs)
+// ---------------------------------------------------------------------
+
+const int16_t METADATA_V5 = 4;
+const uint8_t HEADER_SCHEMA = 1, HEADER_DICTIONARY_BATCH = 2, HEADER_RECORD_BATCH = 3;
+const uint8_t TYPE_INT = 2, TYPE_UTF8 = 5, TYPE_DATE = 8;
+const int16_t DATE_UNIT_DAY = 0;
+const size_t BODY_ALIGNMENT = 64;
+
+FbRef intType(int32_t bitWidth, bool isSigned) {
+    return TableBuilder().scalar<int32_t>(0, bitWidth).scalar<uint8_t>(1, isSigned).build();
+}
+
+FbRef field(const string& name, uint8_t typeType, FbRef type, FbRef dictionary = nullptr) {
+    TableBuilder b;
+    b.child(0, fbString(name))
+        .scalar<uint8_t>(1, 0)  // not nullable
+        .scalar<uint8_t>(2, typeType)
+        .child(3, std::move(type))
+        .child(5, fbTables({}));  // readers require the (empty) children list
+    if (dictionary) b.child(4, std::move(dictionary));
+    return b.build();
+}
+
+// suburb_id: uint32, suburb: dictionary<int32, utf8>, bucket_start: date32[day], count: uint64
+FbRef seriesSchema() {
+    FbRef dictionary = TableBuilder()
+        .scalar<int64_t>(0, 0)  // dictionary id
+        .child(1, intType(32, true))
+        .scalar<uint8_t>(2, 0)  // not ordered
+        .build();
+    return TableBuilder()
+        .scalar<int16_t>(0, 0)  // little endian
+        .child(1, fbTables({
+            field("suburb_id", TYPE_INT, intType(32, false)),
+            field("suburb", TYPE_UTF8, TableBuilder().build(), dictionary),
+            field("bucket_start", TYPE_DATE, TableBuilder().scalar<int16_t>(0, DATE_UNIT_DAY).build()),
+            field("count", TYPE_INT, intType(64, false)),
+        }))
+        .build();
+}
+
+// Column buffers of one record batch and the matching metadata
+struct Body {
+    vector<uint8_t> bytes;
+    vector<int64_t> buffers;  // (offset, length) pairs
+    vector<int64_t> nodes;    // (length, null_count) pairs
+
+    // Adds a column with no nulls: an empty validity bitmap plus the given buffers
+    void column(int64_t length, const vector<vector<uint8_t>>& data) {
+        nodes.push_back(length);
+        nodes.push_back(0);
+        buffers.push_back(static_cast<int64_t>(bytes.size()));
+        buffers.push_back(0);
+        for (const auto& d : data) {
+            buffers.push_back(static_cast<int64_t>(bytes.size()));
+            buffers.push_back(static_cast<int64_t>(d.size()));
+            bytes.insert(bytes.end(), d.begin(), d.end());
+            while (bytes.size() % BODY_ALIGNMENT != 0) bytes.push_back(0);
+        }
+    }
+
+    FbRef recordBatch(int64_t length) const {
+        return TableBuilder()
+            .scalar<int64_t>(0, length)
+            .child(1, fbStructs(nodes, 2))
+            .child(2, fbStructs(buffers, 2))
+            .build();
+    }
+};
+
+template <typename T>
+vector<uint8_t> bytesOf(const vector<T>& values) {
+    vector<uint8_t> out(values.size() * sizeof(T));
+    if (!out.empty()) std::memcpy(out.data(), values.data(), out.size());
+    return out;
+}
+
+FbRef message(uint8_t headerType, FbRef header, int64_t bodyLength) {
+    return TableBuilder()
+        .scalar<int16_t>(0, METADATA_V5)
+        .scalar<uint8_t>(1, headerType)
+        .child(2, std::move(header))
+        .scalar<int64_t>(3, bodyLength)
+        .build();
+}
+
+// Writes an encapsulated IPC message and records its file block (offset, metadata length, body length)
+void writeMessage(ofstream* out, int64_t* filePos, const FbRef& msg, const vector<uint8_t>& body,
+    vector<int64_t>* blocks) {
+    // pad the metadata so the body (and so every buffer) starts 64-byte aligned in the file
+    vector<uint8_t> meta = finish(msg);
+    while ((static_cast<size_t>(*filePos) + 8 + meta.size()) % BODY_ALIGNMENT != 0) meta.push_back(0);
+
+    vector<uint8_t> prefix;
+    append(&prefix, static_cast<uint32_t>(0xFFFFFFFF));  // continuation marker
+    append(&prefix, static_cast<int32_t>(meta.size()));
+    out->write(reinterpret_cast<const char*>(prefix.data()), static_cast<std::streamsize>(prefix.size()));
+    out->write(reinterpret_cast<const char*>(meta.data()), static_cast<std::streamsize>(meta.size()));
+    out->write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+
+    if (blocks) {
+        // Block struct: offset (int64), metaDataLength (int32 + 4 bytes padding), bodyLength (int64)
+        blocks->push_back(*filePos);
+        blocks->push_back(static_cast<int64_t>(prefix.size() + meta.size()));
+        blocks->push_back(static_cast<int64_t>(body.size()));
+    }
+    *filePos += static_cast<int64_t>(prefix.size() + meta.size() + body.size());
+}
+
+}  // namespace
+
+// Writes the suburb x bucket series as an Arrow IPC file (a.k.a. Feather v2)
+// with columns suburb_id (uint32), suburb (dictionary-encoded utf8 whose
+// indices are the suburb ids), bucket_start (date32) and count (uint64).
+// Like the series CSV, every bucket of each suburb with sightings is written.
+// Buffers are 64-byte aligned so readers can memory-map the file zero-copy.
+//
+// Args:
+//    path: the file to create
+//    suburbs: the loaded suburbs (for the name dictionary)
+//    matrix: suburb x time-bucket counts
+//    order: suburb ids in output order
+void writeSeriesArrow(const string& path, const vector<Suburb>& suburbs,
+    const CountMatrix& matrix, const vector<uint32_t>& order) {
+    // name dictionary: entry i is suburb i
+    vector<int32_t> nameOffsets{0};
+    vector<uint8_t> nameData;
+    for (const auto& s : suburbs) {
+        nameData.insert(nameData.end(), s.name.begin(), s.name.end());
+        nameOffsets.push_back(static_cast<int32_t>(nameData.size()));
+    }
+    Body dictionary;
+    dictionary.column(static_cast<int64_t>(suburbs.size()), {bytesOf(nameOffsets), nameData});
+
+    // series columns
+    vector<uint32_t> ids;
+    vector<int32_t> nameIndex, bucketStart;
+    vector<uint64_t> count;
+    for (uint32_t id : order) {
+        const uint64_t* row = matrix.row(id);
+        bool any = false;
+        for (size_t b = 0; b < matrix.buckets() && !any; ++b) any = row[b] != 0;
+        if (!any) continue;
+        for (size_t b = 0; b < matrix.buckets(); ++b) {
+            ids.push_back(id);
+            nameIndex.push_back(static_cast<int32_t>(id));
+            bucketStart.push_back(matrix.bucketStart(b));
+            count.push_back(row[b]);
+        }
+    }
+    const int64_t rows = static_cast<int64_t>(ids.size());
+    Body batch;
+    batch.column(rows, {bytesOf(ids)});
+    batch.column(rows, {bytesOf(nameIndex)});
+    batch.column(rows, {bytesOf(bucketStart)});
+    batch.column(rows, {bytesOf(count)});
+
+    ofstream out(path, std::ios::binary);
+    if (!out) throw runtime_error("Failed to open Arrow file for writing: " + path);
+    out.write("ARROW1\0\0", 8);
+    int64_t filePos = 8;
+
+    vector<int64_t> dictionaryBlocks, batchBlocks;
+    writeMessage(&out, &filePos, message(HEADER_SCHEMA, seriesSchema(), 0), {}, nullptr);
+    FbRef dictionaryBatch = TableBuilder()
+        .scalar<int64_t>(0, 0)  // dictionary id
+        .child(1, dictionary.recordBatch(static_cast<int64_t>(suburbs.size())))
+        .scalar<uint8_t>(2, 0)  // not a delta
+        .build();
+    writeMessage(&out, &filePos,
+        message(HEADER_DICTIONARY_BATCH, dictionaryBatch, static_cast<int64_t>(dictionary.bytes.size())),
+        dictionary.bytes, &dictionaryBlocks);
+    writeMessage(&out, &filePos,
+        message(HEADER_RECORD_BATCH, batch.recordBatch(rows), static_cast<int64_t>(batch.bytes.size())),
+        batch.bytes, &batchBlocks);
+
+    // end-of-stream marker, then the footer repeating the schema and indexing the blocks
+    const uint32_t eos[2] = {0xFFFFFFFF, 0};
+    out.write(reinterpret_cast<const char*>(eos), sizeof(eos));
+
+    vector<uint8_t> footer = finish(TableBuilder()
+        .scalar<int16_t>(0, METADATA_V5)
+        .child(1, seriesSchema())
+        .child(2, fbStructs(dictionaryBlocks, 3))
+        .child(3, fbStructs(batchBlocks, 3))
+        .build());
+    out.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+    const int32_t footerSize = static_cast<int32_t>(footer.size());
+    out.write(reinterpret_cast<const char*>(&footerSize), sizeof(footerSize));
+    out.write(ARROW_MAGIC, 6);
+
+    out.close();
+    if (!out) throw runtime_error("Failed to write Arrow file: " + path);
+}
+
+}  // namespace columnar
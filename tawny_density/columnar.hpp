@@ -0,0 +1,37 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_COLUMNAR_HPP_
+#define TAWNY_DENSITY_COLUMNAR_HPP_
+
+#include <cstdint>     // for uint32_t
+#include <string>      // for string
+#include <vector>      // for vector
+#include "counts.hpp"  // for CountMatrix
+#include "suburb.hpp"  // for Suburb
+
+using std::string;
+using std::vector;
+using counts::CountMatrix;
+using suburb::Suburb;
+
+namespace columnar {
+
+const char ARROW_MAGIC[] = "ARROW1";
+
+void writeSeriesArrow(const string& path, const vector<Suburb>& suburbs,
+    const CountMatrix& matrix, const vector<uint32_t>& order);
+
+}  // namespace columnar
+
+#endif  // TAWNY_DENSITY_COLUMNAR_HPP_
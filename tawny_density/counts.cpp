@@ -0,0 +1,181 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "counts.hpp"
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t
+#include <stdexcept>         // for runtime_error
+#include <utility>           // for move
+#include <vector>            // for vector
+#include "observations.hpp"  // for ObsPoint
+#include "parallel.hpp"      // for parallelFor, resolveThreads
+#include "suburb.hpp"        // for Point, NO_SUBURB
+#include "suburb_index.hpp"  // for SuburbIndex
+#include "trace.hpp"         // for Span, setThreadName
+
+using std::vector;
+using std::runtime_error;
+
+using parallel::parallelFor;
+using suburb::Point;
+using suburb::NO_SUBURB;
+
+namespace counts {
+
+// Creates an all-zero matrix covering the inclusive day range firstDay..lastDay
+//
+// Args:
+//    suburbs: number of suburbs (rows)
+//    firstDay: first day of the first bucket (days since 1970-01-01)
+//    lastDay: last day that must fall inside a bucket
+//    bucketDays: bucket width in days (1 = daily, 7 = weekly)
+CountMatrix::CountMatrix(size_t suburbs, int firstDay, int lastDay, int bucketDays)
+    : suburbs_(suburbs), firstDay_(firstDay), bucketDays_(bucketDays) {
+    if (bucketDays < 1) throw runtime_error("bucketDays must be at least 1");
+    if (lastDay < firstDay) throw runtime_error("Count range ends before it starts");
+    buckets_ = static_cast<size_t>((lastDay - firstDay) / bucketDays + 1);
+    cells_.assign(suburbs_ * buckets_, 0);
+}
+
+// Finds the bucket holding day
+//
+// Args:
+//    day: observation day (days since 1970-01-01)
+//    bucket: set to the bucket index when found
+// Returns:
+//    false if day is outside the matrix's buckets
+bool CountMatrix::bucketOf(int day, size_t* bucket) const {
+    if (day < firstDay_) return false;
+    *bucket = static_cast<size_t>((day - firstDay_) / bucketDays_);
+    return *bucket < buckets_;
+}
+
+// Adds n sightings for suburb on day
+//
+// Args:
+//    suburb: suburb id (row)
+//    day: observation day (days since 1970-01-01)
+//    n: number of sightings to add
+// Returns:
+//    false (and counts nothing) if day is outside the matrix's buckets
+bool CountMatrix::add(uint32_t suburb, int day, uint64_t n) {
+    size_t bucket = 0;
+    if (!bucketOf(day, &bucket)) return false;
+    cells_[suburb * buckets_ + bucket] += n;
+    return true;
+}
+
+// Removes n sightings previously added for suburb on day
+//
+// Args:
+//    suburb: suburb id (row)
+//    day: observation day (days since 1970-01-01)
+//    n: number of sightings to remove
+// Returns:
+//    false (and changes nothing) if day is outside the buckets or the cell holds fewer than n
+bool CountMatrix::remove(uint32_t suburb, int day, uint64_t n) {
+    size_t bucket = 0;
+    if (!bucketOf(day, &bucket)) return false;
+    uint64_t& cell = cells_[suburb * buckets_ + bucket];
+    if (cell < n) return false;
+    cell -= n;
+    return true;
+}
+
+// Adds every cell of other (same shape) into this matrix
+//
+// Args:
+//    other: the matrix to add, e.g. one thread's partial counts
+void CountMatrix::merge(const CountMatrix& other) {
+    if (other.suburbs_ != suburbs_ || other.buckets_ != buckets_ ||
+        other.firstDay_ != firstDay_ || other.bucketDays_ != bucketDays_)
+        throw runtime_error("Cannot merge count matrices of different shapes");
+    for (size_t i = 0; i < cells_.size(); ++i) cells_[i] += other.cells_[i];
+}
+
+// Sums each suburb's row
+//
+// Returns:
+//    dense per-suburb totals indexed by suburb id
+vector<uint64_t> CountMatrix::totals() const {
+    vector<uint64_t> out(suburbs_, 0);
+    for (size_t s = 0; s < suburbs_; ++s) {
+        const uint64_t* r = row(s);
+        for (size_t b = 0; b < buckets_; ++b) out[s] += r[b];
+    }
+    return out;
+}
+
+// Assigns observations to suburbs and accumulates a suburb x time-bucket matrix
+// in one pass. Each thread counts a contiguous slice of obs into its own matrix
+// and the per-thread matrices are merged at the end. Points outside every
+// suburb can fall back to the suburb with the nearest boundary.
+//
+// Args:
+//    index: the suburb index
+//    obs: the observations to count
+//    firstDay: first day of the first bucket (days since 1970-01-01)
+//    lastDay: last day to count
+//    bucketDays: bucket width in days
+//    threads: number of threads to use (0 = hardware concurrency)
+//    outStats: assigned/undated/nearest tallies, set here
+//    nearestMetres: assign points outside every suburb to the nearest one within this distance (0 = off)
+// Returns:
+//    the merged count matrix
+CountMatrix countObservations(
+    const SuburbIndex& index, const vector<ObsPoint>& obs,
+    int firstDay, int lastDay, int bucketDays, unsigned threads,
+    CountStats* outStats, double nearestMetres) {
+    const size_t suburbs = index.size();
+    const unsigned maxWorkers = parallel::resolveThreads(threads);
+    vector<CountMatrix> partials(maxWorkers);
+    vector<CountStats> stats(maxWorkers);
+
+    const unsigned used = parallelFor(obs.size(), threads, [&](size_t begin, size_t end, unsigned w) {
+        if (w > 0) trace::setThreadName("assign worker");
+        trace::Span span("assign_batch", "assign");
+        span.setItems(static_cast<int64_t>(end - begin));
+        CountMatrix local(suburbs, firstDay, lastDay, bucketDays);
+        for (size_t i = begin; i < end; ++i) {
+            const Point point{obs[i].lon, obs[i].lat};
+            uint32_t id = index.locate(point);
+            bool fallback = false;
+            if (id == NO_SUBURB && nearestMetres > 0) {
+                id = index.nearest(point, nearestMetres);
+                fallback = true;
+            }
+            if (id == NO_SUBURB) continue;
+            if (local.add(id, obs[i].day)) {
+                ++stats[w].assigned;
+                if (fallback) ++stats[w].nearest;
+            } else {
+                ++stats[w].undated;
+            }
+        }
+        partials[w] = std::move(local);
+    });
+
+    trace::Span span("merge", "assign");
+    CountMatrix merged = std::move(partials[0]);
+    *outStats = stats[0];
+    for (unsigned w = 1; w < used; ++w) {
+        merged.merge(partials[w]);
+        outStats->assigned += stats[w].assigned;
+        outStats->undated += stats[w].undated;
+        outStats->nearest += stats[w].nearest;
+    }
+    return merged;
+}
+
+}  // namespace counts
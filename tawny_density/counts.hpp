@@ -0,0 +1,79 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_COUNTS_HPP_
+#define TAWNY_DENSITY_COUNTS_HPP_
+
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t
+#include <vector>            // for vector
+#include "observations.hpp"  // for ObsPoint
+#include "suburb.hpp"        // for Suburb
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::vector;
+using observations::ObsPoint;
+using suburb::Suburb;
+using suburb::SuburbIndex;
+
+namespace counts {
+
+// Sighting counts per suburb per time bucket, stored contiguously as
+// cells[suburb * buckets + bucket]. Bucket b covers the bucketDays days
+// starting at firstDay + b * bucketDays (days since 1970-01-01).
+class CountMatrix {
+ public:
+    CountMatrix() = default;
+    CountMatrix(size_t suburbs, int firstDay, int lastDay, int bucketDays);
+
+    size_t suburbs() const { return suburbs_; }
+    size_t buckets() const { return buckets_; }
+    int firstDay() const { return firstDay_; }
+    int bucketDays() const { return bucketDays_; }
+    int bucketStart(size_t bucket) const { return firstDay_ + static_cast<int>(bucket) * bucketDays_; }
+
+    bool add(uint32_t suburb, int day, uint64_t n = 1);
+    bool remove(uint32_t suburb, int day, uint64_t n = 1);
+    uint64_t at(size_t suburb, size_t bucket) const { return cells_[suburb * buckets_ + bucket]; }
+    const uint64_t* row(size_t suburb) const { return cells_.data() + suburb * buckets_; }
+    const uint64_t* data() const { return cells_.data(); }
+    uint64_t* data() { return cells_.data(); }
+    size_t size() const { return cells_.size(); }
+    void merge(const CountMatrix& other);
+    vector<uint64_t> totals() const;
+
+ private:
+    bool bucketOf(int day, size_t* bucket) const;
+
+    size_t suburbs_ = 0;
+    size_t buckets_ = 0;
+    int firstDay_ = 0;
+    int bucketDays_ = 1;
+    vector<uint64_t> cells_;
+};
+
+// What countObservations did with the observations
+struct CountStats {
+    size_t assigned = 0;  // counted in a bucket
+    size_t undated = 0;   // in a suburb but without a day in range
+    size_t nearest = 0;   // of those assigned, placed by the nearest-suburb fallback
+};
+
+CountMatrix countObservations(
+    const SuburbIndex& index, const vector<ObsPoint>& obs,
+    int firstDay, int lastDay, int bucketDays, unsigned threads,
+    CountStats* outStats, double nearestMetres = 0);
+
+}  // namespace counts
+
+#endif  // TAWNY_DENSITY_COUNTS_HPP_
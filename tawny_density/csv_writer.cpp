@@ -0,0 +1,259 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "csv_writer.hpp"
+#include <charconv>          // for to_chars
+#include <cmath>             // for round
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t
+#include <cstring>           // for memcpy
+#include <ostream>           // for ostream
+#include <stdexcept>         // for runtime_error
+#include <string>            // for string
+#include <string_view>       // for string_view
+#include <vector>            // for vector
+#include "counts.hpp"        // for CountMatrix
+#include "observations.hpp"  // for formatIsoDate
+#include "suburb.hpp"        // for Suburb
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::runtime_error;
+using std::to_chars;
+
+using observations::formatIsoDate;
+
+namespace csv {
+
+// Opens path for writing
+//
+// Args:
+//    path: the CSV file to create (truncated if it exists)
+//    bufferBytes: bytes buffered between writes to the file
+CsvWriter::CsvWriter(const string& path, size_t bufferBytes)
+    : path_(path), file_(path, std::ios::binary), out_(&file_), buffer_(bufferBytes < 64 ? 64 : bufferBytes) {
+    if (!file_) throw runtime_error("Failed to open CSV for writing: " + path);
+}
+
+// Writes to an already open stream, which must outlive the writer
+//
+// Args:
+//    out: the stream to write to
+//    bufferBytes: bytes buffered between writes to the stream
+CsvWriter::CsvWriter(std::ostream& out, size_t bufferBytes)
+    : path_("output stream"), out_(&out), buffer_(bufferBytes < 64 ? 64 : bufferBytes) {}
+
+// Flushes whatever is buffered; errors are only reported by close()
+CsvWriter::~CsvWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+// Writes a quoted text field, doubling any embedded quotes
+//
+// Args:
+//    value: the field text
+// Returns:
+//    this writer, for chaining
+CsvWriter& CsvWriter::text(string_view value) {
+    separator();
+    reserve(value.size() * 2 + 2);
+    char* p = buffer_.data() + used_;
+    *p++ = '"';
+    for (char c : value) {
+        if (c == '"') *p++ = '"';
+        *p++ = c;
+    }
+    *p++ = '"';
+    used_ = static_cast<size_t>(p - buffer_.data());
+    return *this;
+}
+
+// Writes an unsigned integer field
+//
+// Args:
+//    value: the field value
+// Returns:
+//    this writer, for chaining
+CsvWriter& CsvWriter::integer(uint64_t value) {
+    separator();
+    reserve(20);
+    char* begin = buffer_.data() + used_;
+    used_ = static_cast<size_t>(to_chars(begin, begin + 20, value).ptr - buffer_.data());
+    return *this;
+}
+
+// Writes a floating point field (shortest round-trip representation)
+//
+// Args:
+//    value: the field value
+// Returns:
+//    this writer, for chaining
+CsvWriter& CsvWriter::number(double value) {
+    separator();
+    reserve(32);
+    char* begin = buffer_.data() + used_;
+    used_ = static_cast<size_t>(to_chars(begin, begin + 32, value).ptr - buffer_.data());
+    return *this;
+}
+
+// Writes a field as is (the caller guarantees it needs no quoting)
+//
+// Args:
+//    value: the field text
+// Returns:
+//    this writer, for chaining
+CsvWriter& CsvWriter::raw(string_view value) {
+    separator();
+    reserve(value.size());
+    std::memcpy(buffer_.data() + used_, value.data(), value.size());
+    used_ += value.size();
+    return *this;
+}
+
+// Terminates the current row
+void CsvWriter::endRow() {
+    reserve(1);
+    buffer_[used_++] = '\n';
+    rowStart_ = true;
+}
+
+// Writes out buffered rows and closes the file (a stream is only flushed)
+void CsvWriter::close() {
+    if (closed_) return;
+    closed_ = true;
+    flush();
+    if (file_.is_open()) file_.close();
+    else out_->flush();
+    if (!*out_) throw runtime_error("Failed to write CSV: " + path_);
+}
+
+// Writes the comma before every field but the first of a row
+void CsvWriter::separator() {
+    if (!rowStart_) {
+        reserve(1);
+        buffer_[used_++] = ',';
+    }
+    rowStart_ = false;
+}
+
+// Makes room for bytes more bytes, flushing (or growing for huge fields)
+void CsvWriter::reserve(size_t bytes) {
+    if (used_ + bytes <= buffer_.size()) return;
+    flush();
+    if (bytes > buffer_.size()) buffer_.resize(bytes);
+}
+
+// Writes the buffer to the file
+void CsvWriter::flush() {
+    if (used_ == 0) return;
+    out_->write(buffer_.data(), static_cast<std::streamsize>(used_));
+    used_ = 0;
+    if (!*out_) throw runtime_error("Failed to write CSV: " + path_);
+}
+
+namespace {
+
+// Writes the rows of writeCountsCsv and closes the writer
+void writeCounts(CsvWriter* out, const vector<Suburb>& suburbs,
+    const vector<uint64_t>& counts, const vector<uint32_t>& order) {
+    out->raw("suburb_id").raw("suburb").raw("count").endRow();
+    for (uint32_t id : order) {
+        if (counts[id] == 0) continue;
+        out->integer(id).text(suburbs[id].name).integer(counts[id]).endRow();
+    }
+    out->close();
+}
+
+}  // namespace
+
+// Writes per-suburb totals as suburb_id,suburb,count, skipping zero counts
+//
+// Args:
+//    path: the CSV file to create
+//    suburbs: the loaded suburbs (for names)
+//    counts: dense per-suburb counts indexed by suburb id
+//    order: suburb ids in output order
+void writeCountsCsv(const string& path, const vector<Suburb>& suburbs,
+    const vector<uint64_t>& counts, const vector<uint32_t>& order) {
+    CsvWriter out(path);
+    writeCounts(&out, suburbs, counts, order);
+}
+
+// Writes per-suburb totals as suburb_id,suburb,count to an open stream
+//
+// Args:
+//    out: the stream to write to (e.g. std::cout)
+//    suburbs: the loaded suburbs (for names)
+//    counts: dense per-suburb counts indexed by suburb id
+//    order: suburb ids in output order
+void writeCountsCsv(std::ostream& out, const vector<Suburb>& suburbs,
+    const vector<uint64_t>& counts, const vector<uint32_t>& order) {
+    CsvWriter writer(out);
+    writeCounts(&writer, suburbs, counts, order);
+}
+
+// Writes per-suburb totals next to accuracy-weighted counts as
+// suburb_id,suburb,count,weighted_count, skipping suburbs where both are zero.
+// Weighted counts are rounded to 6 decimal places.
+//
+// Args:
+//    path: the CSV file to create
+//    suburbs: the loaded suburbs (for names)
+//    counts: dense per-suburb counts indexed by suburb id
+//    weighted: dense per-suburb fractional counts indexed by suburb id
+//    order: suburb ids in output order
+void writeWeightedCsv(const string& path, const vector<Suburb>& suburbs,
+    const vector<uint64_t>& counts, const vector<double>& weighted, const vector<uint32_t>& order) {
+    CsvWriter out(path);
+    out.raw("suburb_id").raw("suburb").raw("count").raw("weighted_count").endRow();
+    for (uint32_t id : order) {
+        const double w = std::round(weighted[id] * 1e6) / 1e6;
+        if (counts[id] == 0 && w == 0) continue;
+        out.integer(id).text(suburbs[id].name).integer(counts[id]).number(w).endRow();
+    }
+    out.close();
+}
+
+// Writes every bucket of each suburb with sightings as suburb_id,suburb,bucket_start,count
+//
+// Args:
+//    path: the CSV file to create
+//    suburbs: the loaded suburbs (for names)
+//    matrix: suburb x time-bucket counts
+//    order: suburb ids in output order
+void writeSeriesCsv(const string& path, const vector<Suburb>& suburbs,
+    const CountMatrix& matrix, const vector<uint32_t>& order) {
+    // bucket start dates are shared by every suburb, so format them once
+    vector<string> bucketStarts;
+    for (size_t b = 0; b < matrix.buckets(); ++b) bucketStarts.push_back(formatIsoDate(matrix.bucketStart(b)));
+
+    CsvWriter out(path);
+    out.raw("suburb_id").raw("suburb").raw("bucket_start").raw("count").endRow();
+    for (uint32_t id : order) {
+        const uint64_t* row = matrix.row(id);
+        bool any = false;
+        for (size_t b = 0; b < matrix.buckets() && !any; ++b) any = row[b] != 0;
+        if (!any) continue;
+        for (size_t b = 0; b < matrix.buckets(); ++b) {
+            out.integer(id).text(suburbs[id].name).raw(bucketStarts[b]).integer(row[b]).endRow();
+        }
+    }
+    out.close();
+}
+
+}  // namespace csv
@@ -0,0 +1,80 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_CSV_WRITER_HPP_
+#define TAWNY_DENSITY_CSV_WRITER_HPP_
+
+#include <cstddef>      // for size_t
+#include <cstdint>      // for uint32_t, uint64_t
+#include <fstream>      // for ofstream
+#include <ostream>      // for ostream
+#include <string>       // for string
+#include <string_view>  // for string_view
+#include <vector>       // for vector
+#include "counts.hpp"   // for CountMatrix
+#include "suburb.hpp"   // for Suburb
+
+using std::string;
+using std::string_view;
+using std::vector;
+using counts::CountMatrix;
+using suburb::Suburb;
+
+namespace csv {
+
+const size_t DEFAULT_BUFFER_BYTES = 1 << 20;  // 1 MiB between writes to the file
+
+// Buffered RFC 4180 CSV writer. Rows are formatted straight into a large
+// buffer (integers via to_chars) which is written to the file in big chunks.
+// Writing to a stream (e.g. std::cout) leaves the stream open on close().
+class CsvWriter {
+ public:
+    explicit CsvWriter(const string& path, size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+    explicit CsvWriter(std::ostream& out, size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+    ~CsvWriter();
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    CsvWriter& text(string_view value);
+    CsvWriter& integer(uint64_t value);
+    CsvWriter& number(double value);
+    CsvWriter& raw(string_view value);
+    void endRow();
+    void close();
+
+ private:
+    void separator();
+    void reserve(size_t bytes);
+    void flush();
+
+    string path_;
+    std::ofstream file_;
+    std::ostream* out_;
+    vector<char> buffer_;
+    size_t used_ = 0;
+    bool rowStart_ = true;
+    bool closed_ = false;
+};
+
+void writeCountsCsv(const string& path, const vector<Suburb>& suburbs,
+    const vector<uint64_t>& counts, const vector<uint32_t>& order);
+void writeCountsCsv(std::ostream& out, const vector<Suburb>& suburbs,
+    const vector<uint64_t>& counts, const vector<uint32_t>& order);
+void writeWeightedCsv(const string& path, const vector<Suburb>& suburbs,
+    const vector<uint64_t>& counts, const vector<double>& weighted, const vector<uint32_t>& order);
+void writeSeriesCsv(const string& path, const vector<Suburb>& suburbs,
+    const CountMatrix& matrix, const vector<uint32_t>& order);
+
+}  // namespace csv
+
+#endif  // TAWNY_DENSITY_CSV_WRITER_HPP_
@@ -0,0 +1,169 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fractional.hpp"
+#include <algorithm>         // for min, max
+#include <cmath>             // for cos, sin, sqrt
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t
+#include <utility>           // for move, pair
+#include <vector>            // for vector
+#include "observations.hpp"  // for ObsPoint
+#include "parallel.hpp"      // for parallelFor, resolveThreads
+#include "suburb.hpp"        // for Point, NO_SUBURB
+#include "suburb_grid.hpp"   // for pointSuburbMetres, METRES_PER_DEGREE_LAT
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::vector;
+using std::pair;
+using std::min;
+using std::max;
+
+using parallel::parallelFor;
+using suburb::NO_SUBURB;
+using suburb::METRES_PER_DEGREE_LAT;
+using suburb::pointSuburbMetres;
+
+namespace fractional {
+
+const double GOLDEN_ANGLE = 2.39996322972865332;  // radians
+const double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+// Evenly spread points over the unit disc (a sunflower spiral), each standing
+// for an equal share of the disc's area
+//
+// Args:
+//    samples: number of points
+// Returns:
+//    offsets with x, y in [-1, 1] stored as lon, lat
+vector<Point> discSamples(int samples) {
+    vector<Point> out;
+    for (int i = 0; i < samples; ++i) {
+        const double r = std::sqrt((i + 0.5) / samples);
+        const double theta = i * GOLDEN_ANGLE;
+        out.push_back(Point{r * std::cos(theta), r * std::sin(theta)});
+    }
+    return out;
+}
+
+// Credits each observation to suburbs in proportion to how much of its
+// positional accuracy circle falls inside each. A circle that lies wholly
+// inside the suburb holding its centre (checked by distance to that suburb's
+// boundary, which only visits the edges within the radius) is credited there
+// without sampling; otherwise the circle is sampled and every sample located
+// through the index. Samples outside every suburb are ignored, so each
+// observation that touches a suburb adds 1 in total.
+// Observations without an accuracy are credited to the suburb holding them.
+// With options.nearestMetres set, an observation that would be unassigned is
+// credited wholly to the suburb with the nearest boundary within that distance
+// of its centre, as countObservations does.
+//
+// Args:
+//    index: the suburb index
+//    obs: the observations
+//    firstDay: first day counted (days since 1970-01-01)
+//    lastDay: last day counted
+//    options: sample count and radius cap
+//    threads: number of threads to use (0 = hardware concurrency)
+//    outStats: what happened to the observations, set here
+// Returns:
+//    fractional counts indexed by suburb id
+vector<double> countFractional(
+    const SuburbIndex& index, const vector<ObsPoint>& obs, int firstDay, int lastDay,
+    const FractionalOptions& options, unsigned threads, FractionalStats* outStats) {
+    const size_t suburbs = index.size();
+    const vector<Point> disc = discSamples(max(options.samples, 1));
+    const unsigned maxWorkers = parallel::resolveThreads(threads);
+    vector<vector<double>> partials(maxWorkers);
+    vector<FractionalStats> stats(maxWorkers);
+
+    const unsigned used = parallelFor(obs.size(), threads, [&](size_t begin, size_t end, unsigned w) {
+        vector<double> local(suburbs, 0.0);
+        vector<pair<uint32_t, int>> hits;  // suburb, samples inside it
+        FractionalStats& st = stats[w];
+        for (size_t i = begin; i < end; ++i) {
+            const ObsPoint& op = obs[i];
+            if (op.day < firstDay || op.day > lastDay) {
+                ++st.undated;
+                continue;
+            }
+            const Point centre{op.lon, op.lat};
+            const double radius = min(op.accuracy, options.maxAccuracyMetres);
+            const uint32_t home = index.locate(centre);
+            if (home != NO_SUBURB &&
+                (radius <= 0 || pointSuburbMetres(index.suburbs()[home], centre, radius) >= radius)) {
+                local[home] += 1.0;
+                ++st.whole;
+                continue;
+            }
+            // the whole observation to the nearest suburb, or unassigned
+            auto fallBack = [&]() {
+                const uint32_t id = options.nearestMetres > 0 ? index.nearest(centre, options.nearestMetres)
+                    : NO_SUBURB;
+                if (id == NO_SUBURB) {
+                    ++st.unassigned;
+                    return;
+                }
+                local[id] += 1.0;
+                ++st.nearest;
+            };
+            if (radius <= 0) {
+                fallBack();
+                continue;
+            }
+
+            const double dLon = radius / (METRES_PER_DEGREE_LAT * std::cos(op.lat * DEG_TO_RAD));
+            const double dLat = radius / METRES_PER_DEGREE_LAT;
+            hits.clear();
+            int inside = 0;
+            for (const Point& d : disc) {
+                const uint32_t id = index.locate(Point{op.lon + d.lon * dLon, op.lat + d.lat * dLat});
+                if (id == NO_SUBURB) continue;
+                ++inside;
+                auto it = hits.begin();
+                while (it != hits.end() && it->first != id) ++it;
+                if (it == hits.end()) {
+                    hits.emplace_back(id, 1);
+                } else {
+                    ++it->second;
+                }
+            }
+            if (inside == 0) {
+                fallBack();
+                continue;
+            }
+            for (const auto& hit : hits) local[hit.first] += static_cast<double>(hit.second) / inside;
+            if (hits.size() == 1) {
+                ++st.whole;
+            } else {
+                ++st.spread;
+            }
+        }
+        partials[w] = std::move(local);
+    });
+
+    vector<double> out = std::move(partials[0]);
+    *outStats = stats[0];
+    for (unsigned w = 1; w < used; ++w) {
+        for (size_t s = 0; s < suburbs; ++s) out[s] += partials[w][s];
+        outStats->whole += stats[w].whole;
+        outStats->spread += stats[w].spread;
+        outStats->unassigned += stats[w].unassigned;
+        outStats->nearest += stats[w].nearest;
+        outStats->undated += stats[w].undated;
+    }
+    return out;
+}
+
+}  // namespace fractional
@@ -0,0 +1,54 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_FRACTIONAL_HPP_
+#define TAWNY_DENSITY_FRACTIONAL_HPP_
+
+#include <cstddef>           // for size_t
+#include <vector>            // for vector
+#include "observations.hpp"  // for ObsPoint
+#include "suburb.hpp"        // for Point
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::vector;
+using observations::ObsPoint;
+using suburb::Point;
+using suburb::SuburbIndex;
+
+namespace fractional {
+
+// Tuning for accuracy-weighted assignment
+struct FractionalOptions {
+    int samples = 32;                 // points sampled over each uncertainty circle
+    double maxAccuracyMetres = 5000;  // larger radii are clamped to this
+    double nearestMetres = 0;         // credit circles outside every suburb to the nearest within this (0 = off)
+};
+
+// What countFractional did with the observations
+struct FractionalStats {
+    size_t whole = 0;       // credited entirely to one suburb
+    size_t spread = 0;      // split across two or more suburbs
+    size_t unassigned = 0;  // no part of the circle fell inside a suburb
+    size_t nearest = 0;     // credited by the nearest-suburb fallback instead
+    size_t undated = 0;     // skipped for lacking a day in range
+};
+
+vector<Point> discSamples(int samples);
+vector<double> countFractional(
+    const SuburbIndex& index, const vector<ObsPoint>& obs, int firstDay, int lastDay,
+    const FractionalOptions& options, unsigned threads, FractionalStats* outStats);
+
+}  // namespace fractional
+
+#endif  // TAWNY_DENSITY_FRACTIONAL_HPP_
@@ -0,0 +1,285 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "heatmap.hpp"
+#include <algorithm>         // for min, max, fill
+#include <cmath>             // for ceil, cos, exp, floor
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, UINT32_MAX
+#include <fstream>           // for ofstream
+#include <stdexcept>         // for runtime_error
+#include <string>            // for string
+#include <vector>            // for vector
+#include "csv_writer.hpp"    // for CsvWriter
+#include "observations.hpp"  // for ObsPoint
+#include "parallel.hpp"      // for parallelFor, resolveThreads
+#include "suburb.hpp"        // for Suburb, Point, pointInSuburb
+
+using std::string;
+using std::vector;
+using std::min;
+using std::max;
+using std::runtime_error;
+using std::ofstream;
+
+using csv::CsvWriter;
+using parallel::parallelFor;
+using suburb::Point;
+using suburb::pointInSuburb;
+
+namespace heatmap {
+
+const double PI = 3.14159265358979323846;
+const size_t MAX_CELLS = 250000000;  // 1 GB of float cells, 2 GB while blurring
+
+// Creates an all-zero raster covering the box with roughly square cells
+//
+// Args:
+//    minLon: western edge
+//    minLat: southern edge
+//    maxLon: eastern edge
+//    maxLat: northern edge
+//    cellMetres: cell edge length in metres (longitude is scaled at the box's mid latitude)
+// Returns:
+//    the raster
+Raster makeRaster(double minLon, double minLat, double maxLon, double maxLat, double cellMetres) {
+    if (!(cellMetres > 0)) throw runtime_error("Heatmap cell size must be positive");
+    if (!(maxLon > minLon) || !(maxLat > minLat)) throw runtime_error("Heatmap extent is empty");
+
+    Raster r;
+    r.minLon = minLon;
+    r.minLat = minLat;
+    r.cellLat = cellMetres / METRES_PER_DEGREE;
+    r.cellLon = cellMetres / (METRES_PER_DEGREE * std::cos((minLat + maxLat) / 2 * PI / 180));
+    r.cols = max<size_t>(1, static_cast<size_t>(std::ceil((maxLon - minLon) / r.cellLon)));
+    r.rows = max<size_t>(1, static_cast<size_t>(std::ceil((maxLat - minLat) / r.cellLat)));
+    if (r.cols > MAX_CELLS / r.rows) throw runtime_error("Heatmap grid too large; use a bigger cell size");
+    r.cells.assign(r.cols * r.rows, 0.0f);
+    return r;
+}
+
+// Adds one to the cell under each observation (points outside the raster are ignored).
+// Cell indices are computed in parallel and counting-sorted by band of rows;
+// each thread then adds the cells of its own band, so no locks or per-thread
+// grids are needed and every observation is visited a fixed number of times.
+//
+// Args:
+//    obs: the observations
+//    raster: the raster to add to
+//    threads: number of threads to use (0 = hardware concurrency)
+void rasterise(const vector<ObsPoint>& obs, Raster* raster, unsigned threads) {
+    const Raster& r = *raster;
+    const size_t workers = parallel::resolveThreads(threads);
+    const size_t bands = min(workers, r.rows);
+    auto bandOf = [&](uint32_t idx) { return idx / r.cols * bands / r.rows; };
+
+    // cell index of each observation, and how many each worker sends to each band
+    vector<uint32_t> index(obs.size(), UINT32_MAX);
+    vector<size_t> slot(workers * bands, 0);
+    parallelFor(obs.size(), threads, [&](size_t begin, size_t end, unsigned w) {
+        size_t* counts = slot.data() + w * bands;
+        for (size_t i = begin; i < end; ++i) {
+            const double c = std::floor((obs[i].lon - r.minLon) / r.cellLon);
+            const double y = std::floor((obs[i].lat - r.minLat) / r.cellLat);
+            if (c < 0 || y < 0 || c >= static_cast<double>(r.cols) || y >= static_cast<double>(r.rows)) continue;
+            index[i] = static_cast<uint32_t>(static_cast<size_t>(y) * r.cols + static_cast<size_t>(c));
+            ++counts[bandOf(index[i])];
+        }
+    });
+
+    // turn the counts into each worker's first slot in each band
+    vector<size_t> bandStart(bands + 1, 0);
+    size_t placed = 0;
+    for (size_t b = 0; b < bands; ++b) {
+        bandStart[b] = placed;
+        for (size_t w = 0; w < workers; ++w) {
+            const size_t n = slot[w * bands + b];
+            slot[w * bands + b] = placed;
+            placed += n;
+        }
+    }
+    bandStart[bands] = placed;
+
+    // parallelFor gives each worker the same range as above
+    vector<uint32_t> sorted(placed);
+    parallelFor(obs.size(), threads, [&](size_t begin, size_t end, unsigned w) {
+        size_t* next = slot.data() + w * bands;
+        for (size_t i = begin; i < end; ++i) {
+            if (index[i] != UINT32_MAX) sorted[next[bandOf(index[i])]++] = index[i];
+        }
+    });
+
+    float* cells = raster->cells.data();
+    parallelFor(bands, threads, [&](size_t bandBegin, size_t bandEnd, unsigned) {
+        for (size_t k = bandStart[bandBegin]; k < bandStart[bandEnd]; ++k) cells[sorted[k]] += 1.0f;
+    });
+}
+
+// Normalised 1-D Gaussian weights over [-3 sigma, 3 sigma]
+//
+// Args:
+//    sigmaCells: standard deviation in cells (<= 0 gives the identity kernel)
+// Returns:
+//    odd number of weights summing to 1, centre in the middle
+vector<float> gaussianKernel(double sigmaCells) {
+    if (!(sigmaCells > 0)) return {1.0f};
+    const int radius = max(1, static_cast<int>(std::ceil(3 * sigmaCells)));
+    vector<double> w(static_cast<size_t>(2 * radius + 1));
+    double sum = 0;
+    for (int k = -radius; k <= radius; ++k) {
+        w[static_cast<size_t>(k + radius)] = std::exp(-(k * k) / (2 * sigmaCells * sigmaCells));
+        sum += w[static_cast<size_t>(k + radius)];
+    }
+    vector<float> out;
+    for (double v : w) out.push_back(static_cast<float>(v / sum));
+    return out;
+}
+
+// Smooths the raster with a separable Gaussian (zero outside the raster).
+// Both passes are parallel over rows and written as contiguous
+// multiply-adds over a whole row so the compiler vectorizes the inner loops.
+//
+// Args:
+//    raster: the raster to smooth in place
+//    sigmaCells: kernel standard deviation in cells
+//    threads: number of threads to use (0 = hardware concurrency)
+void gaussianBlur(Raster* raster, double sigmaCells, unsigned threads) {
+    const vector<float> kernel = gaussianKernel(sigmaCells);
+    if (kernel.size() == 1) return;
+    const long radius = static_cast<long>(kernel.size() / 2);
+    const size_t cols = raster->cols, rows = raster->rows;
+    vector<float> tmp(raster->cells.size());
+
+    // horizontal pass: cells -> tmp
+    parallelFor(rows, threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t y = begin; y < end; ++y) {
+            const float* in = raster->cells.data() + y * cols;
+            float* out = tmp.data() + y * cols;
+            std::fill(out, out + cols, 0.0f);
+            for (size_t k = 0; k < kernel.size(); ++k) {
+                const long off = static_cast<long>(k) - radius;
+                const float w = kernel[k];
+                const size_t cBegin = static_cast<size_t>(max(0L, -off));
+                const size_t cEnd = static_cast<size_t>(max(0L, static_cast<long>(cols) - max(0L, off)));
+                if (cBegin >= cEnd) continue;
+                const float* src = in + (static_cast<long>(cBegin) + off);
+                float* dst = out + cBegin;
+                for (size_t c = 0; c < cEnd - cBegin; ++c) dst[c] += w * src[c];
+            }
+        }
+    });
+
+    // vertical pass: tmp -> cells, as weighted sums of whole rows
+    parallelFor(rows, threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t y = begin; y < end; ++y) {
+            float* out = raster->cells.data() + y * cols;
+            std::fill(out, out + cols, 0.0f);
+            for (size_t k = 0; k < kernel.size(); ++k) {
+                const long yy = static_cast<long>(y) + static_cast<long>(k) - radius;
+                if (yy < 0 || yy >= static_cast<long>(rows)) continue;
+                const float w = kernel[k];
+                const float* in = tmp.data() + static_cast<size_t>(yy) * cols;
+                for (size_t c = 0; c < cols; ++c) out[c] += w * in[c];
+            }
+        }
+    });
+}
+
+// Summarises the raster per suburb over the cells whose centre lies inside it
+//
+// Args:
+//    suburbs: the loaded suburbs
+//    raster: the (smoothed) raster
+//    threads: number of threads to use (0 = hardware concurrency)
+// Returns:
+//    one summary per suburb, indexed by suburb id
+vector<SuburbDensity> summariseSuburbs(const vector<Suburb>& suburbs, const Raster& raster, unsigned threads) {
+    vector<SuburbDensity> out(suburbs.size());
+    // cell range whose centres may fall in [lo, hi]
+    auto span = [](double lo, double hi, double origin, double cell, size_t n, size_t* first, size_t* last) {
+        const double a = std::ceil((lo - origin) / cell - 0.5);
+        const double b = std::floor((hi - origin) / cell - 0.5);
+        *first = static_cast<size_t>(max(0.0, a));
+        *last = static_cast<size_t>(min(static_cast<double>(n) - 1, b));
+        return a <= b && b >= 0 && a < static_cast<double>(n);
+    };
+
+    parallelFor(suburbs.size(), threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t id = begin; id < end; ++id) {
+            const Suburb& s = suburbs[id];
+            SuburbDensity& d = out[id];
+            d.id = static_cast<uint32_t>(id);
+            size_t c0, c1, r0, r1;
+            if (!span(s.minLon, s.maxLon, raster.minLon, raster.cellLon, raster.cols, &c0, &c1)) continue;
+            if (!span(s.minLat, s.maxLat, raster.minLat, raster.cellLat, raster.rows, &r0, &r1)) continue;
+            double sum = 0;
+            for (size_t row = r0; row <= r1; ++row) {
+                for (size_t col = c0; col <= c1; ++col) {
+                    const Point centre{raster.centreLon(col), raster.centreLat(row)};
+                    if (!pointInSuburb(s, centre)) continue;
+                    const double v = raster.at(col, row);
+                    sum += v;
+                    if (d.cells == 0 || v > d.peak) {
+                        d.peak = v;
+                        d.peakLon = centre.lon;
+                        d.peakLat = centre.lat;
+                    }
+                    ++d.cells;
+                }
+            }
+            if (d.cells > 0) d.mean = sum / static_cast<double>(d.cells);
+        }
+    });
+    return out;
+}
+
+// Writes the raster as: magic "TAWNYHM1", cols and rows (uint32), minLon, minLat,
+// cellLon, cellLat (float64), then cols*rows float32 cells, row 0 = south.
+// All values little-endian.
+//
+// Args:
+//    path: the file to create
+//    raster: the raster to write
+void writeRaster(const string& path, const Raster& raster) {
+    ofstream out(path, std::ios::binary);
+    if (!out) throw runtime_error("Failed to open heatmap for writing: " + path);
+    const uint32_t dims[2] = {static_cast<uint32_t>(raster.cols), static_cast<uint32_t>(raster.rows)};
+    const double geo[4] = {raster.minLon, raster.minLat, raster.cellLon, raster.cellLat};
+    out.write(RASTER_MAGIC, 8);
+    out.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+    out.write(reinterpret_cast<const char*>(geo), sizeof(geo));
+    out.write(reinterpret_cast<const char*>(raster.cells.data()),
+        static_cast<std::streamsize>(raster.cells.size() * sizeof(float)));
+    out.close();
+    if (!out) throw runtime_error("Failed to write heatmap: " + path);
+}
+
+// Writes per-suburb summaries as suburb_id,suburb,cells,mean_density,peak_density,peak_lon,peak_lat
+//
+// Args:
+//    path: the CSV file to create
+//    suburbs: the loaded suburbs (for names)
+//    summary: per-suburb summaries from summariseSuburbs
+void writeSummaryCsv(const string& path, const vector<Suburb>& suburbs, const vector<SuburbDensity>& summary) {
+    CsvWriter out(path);
+    out.raw("suburb_id").raw("suburb").raw("cells").raw("mean_density")
+        .raw("peak_density").raw("peak_lon").raw("peak_lat").endRow();
+    for (const auto& d : summary) {
+        out.integer(d.id).text(suburbs[d.id].name).integer(d.cells)
+            .number(d.mean).number(d.peak).number(d.peakLon).number(d.peakLat).endRow();
+    }
+    out.close();
+}
+
+}  // namespace heatmap
@@ -0,0 +1,64 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_HEATMAP_HPP_
+#define TAWNY_DENSITY_HEATMAP_HPP_
+
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t
+#include <string>            // for string
+#include <vector>            // for vector
+#include "observations.hpp"  // for ObsPoint
+#include "suburb.hpp"        // for Suburb
+
+using std::string;
+using std::vector;
+using observations::ObsPoint;
+using suburb::Suburb;
+
+namespace heatmap {
+
+const char RASTER_MAGIC[] = "TAWNYHM1";
+const double METRES_PER_DEGREE = 111320.0;  // one degree of latitude (and of longitude at the equator)
+
+// lon/lat grid of float cells, row-major with row 0 along minLat (south)
+struct Raster {
+    size_t cols = 0, rows = 0;
+    double minLon{}, minLat{};
+    double cellLon{}, cellLat{};  // cell size in degrees
+    vector<float> cells;
+
+    float at(size_t col, size_t row) const { return cells[row * cols + col]; }
+    double centreLon(size_t col) const { return minLon + (static_cast<double>(col) + 0.5) * cellLon; }
+    double centreLat(size_t row) const { return minLat + (static_cast<double>(row) + 0.5) * cellLat; }
+};
+
+// kernel density summary of one suburb (cells whose centre lies inside it)
+struct SuburbDensity {
+    uint32_t id{};
+    size_t cells = 0;
+    double mean = 0, peak = 0;
+    double peakLon{}, peakLat{};
+};
+
+Raster makeRaster(double minLon, double minLat, double maxLon, double maxLat, double cellMetres);
+void rasterise(const vector<ObsPoint>& obs, Raster* raster, unsigned threads = 1);
+vector<float> gaussianKernel(double sigmaCells);
+void gaussianBlur(Raster* raster, double sigmaCells, unsigned threads = 1);
+vector<SuburbDensity> summariseSuburbs(const vector<Suburb>& suburbs, const Raster& raster, unsigned threads = 1);
+void writeRaster(const string& path, const Raster& raster);
+void writeSummaryCsv(const string& path, const vector<Suburb>& suburbs, const vector<SuburbDensity>& summary);
+
+}  // namespace heatmap
+
+#endif  // TAWNY_DENSITY_HEATMAP_HPP_
@@ -0,0 +1,176 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "hierarchy.hpp"
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t
+#include <stdexcept>         // for runtime_error
+#include <string>            // for string
+#include <utility>           // for move, pair
+#include <vector>            // for vector
+#include "csv_writer.hpp"    // for CsvWriter
+#include "parallel.hpp"      // for parallelFor
+#include "suburb.hpp"        // for Suburb, Point, pointInSuburb, NO_SUBURB
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::string;
+using std::vector;
+using std::pair;
+using std::runtime_error;
+
+using csv::CsvWriter;
+using parallel::parallelFor;
+using suburb::NO_SUBURB;
+using suburb::Point;
+using suburb::pointInSuburb;
+
+namespace hierarchy {
+
+// Starts a hierarchy whose finest level is the given index
+//
+// Args:
+//    finest: index over the finest units (shares the suburbs, no copy)
+//    finestName: level name used in outputs
+Hierarchy::Hierarchy(const SuburbIndex& finest, const string& finestName) {
+    levels_.push_back(Level{finestName, finest, {}});
+}
+
+// Adds a coarser level and maps every unit of the current coarsest level into it
+//
+// Args:
+//    name: level name used in outputs
+//    units: the level's boundaries
+//    threads: number of threads for the containment mapping
+void Hierarchy::addLevel(const string& name, vector<Suburb> units, unsigned threads) {
+    for (const auto& level : levels_) {
+        if (level.name == name) throw runtime_error("Duplicate level name: " + name);
+    }
+    SuburbIndex index(std::move(units));
+    levels_.back().parentOf = containment(levels_.back().index.suburbs(), index, threads);
+    levels_.push_back(Level{name, std::move(index), {}});
+}
+
+// Counts for every level, summed up the containment mapping
+//
+// Args:
+//    finestCounts: per-unit counts at the finest level
+// Returns:
+//    counts per level, finest first, each indexed by unit id
+vector<vector<uint64_t>> Hierarchy::rollUp(const vector<uint64_t>& finestCounts) const {
+    vector<vector<uint64_t>> out{finestCounts};
+    for (size_t i = 0; i + 1 < levels_.size(); ++i) {
+        out.push_back(hierarchy::rollUp(out.back(), levels_[i].parentOf, levels_[i + 1].index.size()));
+    }
+    return out;
+}
+
+// Maps each child unit to the parent holding most of it. The child's bbox is
+// sampled on a samplesPerAxis x samplesPerAxis lattice; samples inside the
+// child are located among the parents and the parent with the most samples
+// wins (lower id on ties). Children too small to catch a sample fall back to
+// the parent holding their bbox centre.
+//
+// Args:
+//    children: the finer units
+//    parents: index over the coarser units
+//    threads: number of threads to split the children over
+//    samplesPerAxis: lattice size
+// Returns:
+//    parent id per child, NO_SUBURB where no parent overlaps it
+vector<uint32_t> containment(const vector<Suburb>& children, const SuburbIndex& parents,
+    unsigned threads, int samplesPerAxis) {
+    vector<uint32_t> parentOf(children.size(), NO_SUBURB);
+    parallelFor(children.size(), threads, [&](size_t begin, size_t end, unsigned) {
+        vector<pair<uint32_t, int>> votes;
+        for (size_t c = begin; c < end; ++c) {
+            const Suburb& child = children[c];
+            if (child.polys.empty()) continue;
+            votes.clear();
+            for (int r = 0; r < samplesPerAxis; ++r) {
+                for (int k = 0; k < samplesPerAxis; ++k) {
+                    const Point p{
+                        child.minLon + (child.maxLon - child.minLon) * (k + 0.5) / samplesPerAxis,
+                        child.minLat + (child.maxLat - child.minLat) * (r + 0.5) / samplesPerAxis};
+                    if (!pointInSuburb(child, p)) continue;
+                    const uint32_t parent = parents.locate(p);
+                    if (parent == NO_SUBURB) continue;
+                    auto it = votes.begin();
+                    while (it != votes.end() && it->first != parent) ++it;
+                    if (it == votes.end()) {
+                        votes.emplace_back(parent, 1);
+                    } else {
+                        ++it->second;
+                    }
+                }
+            }
+            if (votes.empty()) {
+                const Point centre{(child.minLon + child.maxLon) / 2, (child.minLat + child.maxLat) / 2};
+                parentOf[c] = parents.locate(centre);
+                continue;
+            }
+            pair<uint32_t, int> best = votes.front();
+            for (const auto& v : votes) {
+                if (v.second > best.second || (v.second == best.second && v.first < best.first)) best = v;
+            }
+            parentOf[c] = best.first;
+        }
+    });
+    return parentOf;
+}
+
+// Sums child counts into their parents
+//
+// Args:
+//    counts: per-child counts
+//    parentOf: parent id per child (NO_SUBURB children are dropped)
+//    parents: number of parent units
+// Returns:
+//    per-parent counts
+vector<uint64_t> rollUp(const vector<uint64_t>& counts, const vector<uint32_t>& parentOf, size_t parents) {
+    if (counts.size() != parentOf.size()) throw runtime_error("Counts do not match the containment mapping");
+    vector<uint64_t> out(parents, 0);
+    for (size_t c = 0; c < counts.size(); ++c) {
+        if (parentOf[c] != NO_SUBURB) out[parentOf[c]] += counts[c];
+    }
+    return out;
+}
+
+// Writes the counts of every level as level,unit_id,unit,parent_id,count,
+// finest level first, skipping zero counts. parent_id is empty at the coarsest
+// level and for units outside every parent.
+//
+// Args:
+//    path: the CSV file to create
+//    hierarchy: the levels (for names and parents)
+//    counts: per-level counts, as returned by Hierarchy::rollUp
+void writeRollupCsv(const string& path, const Hierarchy& hierarchy, const vector<vector<uint64_t>>& counts) {
+    CsvWriter out(path);
+    out.raw("level").raw("unit_id").raw("unit").raw("parent_id").raw("count").endRow();
+    for (size_t l = 0; l < hierarchy.levels(); ++l) {
+        const Level& level = hierarchy.level(l);
+        for (size_t id = 0; id < counts[l].size(); ++id) {
+            if (counts[l][id] == 0) continue;
+            out.text(level.name).integer(id).text(level.index.suburbs()[id].name);
+            if (level.parentOf.empty() || level.parentOf[id] == NO_SUBURB) {
+                out.raw("");
+            } else {
+                out.integer(level.parentOf[id]);
+            }
+            out.integer(counts[l][id]).endRow();
+        }
+    }
+    out.close();
+}
+
+}  // namespace hierarchy
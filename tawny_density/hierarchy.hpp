@@ -0,0 +1,64 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_HIERARCHY_HPP_
+#define TAWNY_DENSITY_HIERARCHY_HPP_
+
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t
+#include <string>            // for string
+#include <vector>            // for vector
+#include "suburb.hpp"        // for Suburb
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::string;
+using std::vector;
+using suburb::Suburb;
+using suburb::SuburbIndex;
+
+namespace hierarchy {
+
+const int CONTAINMENT_SAMPLES_PER_AXIS = 8;  // child bbox is sampled on an 8 x 8 lattice
+
+// One boundary layer, e.g. suburbs, LGAs or regions
+struct Level {
+    string name;
+    SuburbIndex index;          // the level's units
+    vector<uint32_t> parentOf;  // unit id -> unit of the next coarser level (NO_SUBURB if none)
+};
+
+// Boundary layers from finest to coarsest, with each unit mapped to the unit
+// of the next level that holds it. Points are located once, at the finest
+// level; coarser counts are summed through the mapping.
+class Hierarchy {
+ public:
+    explicit Hierarchy(const SuburbIndex& finest, const string& finestName = "suburb");
+
+    void addLevel(const string& name, vector<Suburb> units, unsigned threads = 1);
+    size_t levels() const { return levels_.size(); }
+    const Level& level(size_t i) const { return levels_[i]; }
+    vector<vector<uint64_t>> rollUp(const vector<uint64_t>& finestCounts) const;
+
+ private:
+    vector<Level> levels_;
+};
+
+vector<uint32_t> containment(const vector<Suburb>& children, const SuburbIndex& parents,
+    unsigned threads = 1, int samplesPerAxis = CONTAINMENT_SAMPLES_PER_AXIS);
+vector<uint64_t> rollUp(const vector<uint64_t>& counts, const vector<uint32_t>& parentOf, size_t parents);
+void writeRollupCsv(const string& path, const Hierarchy& hierarchy, const vector<vector<uint64_t>>& counts);
+
+}  // namespace hierarchy
+
+#endif  // TAWNY_DENSITY_HIERARCHY_HPP_
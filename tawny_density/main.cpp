@@ -17,19 +17,35 @@
 #include "main.hpp"
 #include <algorithm>              // for max, min
 #include <cstddef>                // for size_t
+#include <csignal>                // for signal, SIGINT, SIGTERM
 #include <cstdint>                // for uint64_t
+#include <cstdlib>                // for strtol
 #include <exception>              // for exception
-#include <fstream>                // for basic_ostream, operator<<, basic_of...
+#include <fstream>                // for ifstream
 #include <iostream>               // for cerr, cout
+#include <memory>                 // for unique_ptr, make_unique
 #include <nlohmann/json_fwd.hpp>  // for json
 #include <optional>               // for optional
 #include <stdexcept>              // for runtime_error
 #include <string>                 // for basic_string, char_traits, allocator
-#include <unordered_map>          // for unordered_map
 #include <utility>                // for pair
 #include <vector>                 // for vector
-#include "observations.hpp"       // for ObsPoint, fetchINatPoints
-#include "suburb.hpp"             // for loadSuburbsGeoJSON, pointInSuburb
+#include "assign.hpp"             // for assignPoints, AssignStats
+#include "columnar.hpp"           // for writeSeriesArrow
+#include "counts.hpp"             // for CountMatrix, countObservations
+#include "hierarchy.hpp"          // for Hierarchy, writeRollupCsv
+#include "heatmap.hpp"            // for Raster, makeRaster, rasterise, gaussianBlur
+#include "csv_writer.hpp"         // for CsvWriter, writeCountsCsv, writeSeriesCsv, writeWeightedCsv
+#include "fractional.hpp"         // for countFractional, FractionalOptions
+#include "observations.hpp"       // for ObsPoint, fetchINatPointsSharded
+#include "query_stats.hpp"        // for reportQueryStats
+#include "ranking.hpp"            // for topK, orderSuburbs, SortOrder
+#include "server.hpp"             // for LookupServer
+#include "snapshot.hpp"           // for Snapshot, DeltaStats
+#include "stats.hpp"              // for ScopedTimer, global, setEnabled, writeStatsJson
+#include "suburb.hpp"             // for loadSuburbsGeoJSON
+#include "suburb_index.hpp"       // for SuburbIndex, IndexStrategy, parseIndexStrategy
+#include "trace.hpp"              // for start, stop, setThreadName, writeTrace
 #include "utils.hpp"              // for CurlHttpClient, HttpResponse, IHttpClient
 
 using std::string;
@@ -40,22 +56,99 @@ using std::min;
 using std::max;
 using std::runtime_error;
 using std::optional;
-using std::ofstream;
-using std::unordered_map;
 using std::exception;
+using std::ifstream;
 using json = nlohmann::json;
 
 using suburb::loadSuburbsGeoJSON;
-using suburb::Point;
+using suburb::SuburbIndex;
+using suburb::IndexStrategy;
+using suburb::Suburb;
 using utils::CurlHttpClient;
-using observations::fetchINatPoints;
+using observations::fetchINatPointsSharded;
+using observations::ShardOptions;
+using observations::DateWindow;
+using observations::formatIsoDate;
+using observations::parseIsoDate;
+using observations::utcTimestamp;
+using snapshot::Snapshot;
+using snapshot::DeltaStats;
+using counts::CountMatrix;
+using counts::countObservations;
+using counts::CountStats;
+using ranking::topK;
+using ranking::orderSuburbs;
+using ranking::SortOrder;
+using csv::writeCountsCsv;
+using csv::writeSeriesCsv;
+using csv::writeWeightedCsv;
+using fractional::countFractional;
+using fractional::FractionalOptions;
+using fractional::FractionalStats;
+using columnar::writeSeriesArrow;
+using hierarchy::Hierarchy;
+using hierarchy::writeRollupCsv;
+using heatmap::Raster;
+using heatmap::makeRaster;
+using heatmap::rasterise;
+using heatmap::gaussianBlur;
+using heatmap::summariseSuburbs;
+using heatmap::writeRaster;
+using heatmap::writeSummaryCsv;
+using observations::ObsPoint;
+using server::LookupServer;
+using assign::assignPoints;
+using stats::ScopedTimer;
+using assign::AssignStats;
+using csv::CsvWriter;
 
 // input args for main entry point
 struct Args {
+    string command;              // empty = fetch and count; "serve" = lookup server; "assign" = classify points
     string geojsonPath;
+    optional<string> socketPath;
+    optional<string> pointsPath;  // "-" = stdin
+    bool emitIds = false;         // assign: write a suburb id per point rather than counts
     optional<string> outCsv;
+    optional<string> seriesCsv;
+    optional<string> seriesArrow;
+    optional<string> snapshotPath;
+    optional<string> deletedIds;
+    bool fullRefresh = false;
+    optional<string> heatmapPath;
+    int heatmapCellMetres = 250;
+    int heatmapBandwidthMetres = 500;
+    optional<string> weightedCsv;
+    vector<std::pair<string, string>> levels;  // coarser boundary layers (name, GeoJSON path), finest first
+    optional<string> rollupCsv;
+    optional<string> statsPath;  // per-phase timings and counters as JSON
+    optional<string> tracePath;  // Chrome trace-event JSON of per-thread spans
+    FractionalOptions fractional;
+    int bucketDays = 7;
+    int nearestMetres = 0;  // 0 = points outside every suburb are dropped
+    IndexStrategy indexStrategy = IndexStrategy::Grid;
+    optional<string> indexCache;  // saved trapezoid map, reused while the suburbs are unchanged
+    SortOrder sort = SortOrder::Id;
+    ShardOptions shard;
+    int top = 1;
+    unsigned threads = 0;  // 0 = hardware concurrency
 };
 
+// Parses a positive integer option value
+//
+// Args:
+//    value: the text given on the command line
+//    out: set to the parsed value
+// Returns:
+//    false if value is not a positive integer
+bool parsePositive(const char* value, int* out) {
+    char* end = nullptr;
+    const long v = std::strtol(value, &end, 10);
+    if (end == value || *end != '\0' || v < 1 || v > 1000000) return false;
+    *out = static_cast<int>(v);
+    return true;
+}
+
 // Parses arguments from main entry point
 //
 // Args:
@@ -65,14 +158,90 @@ struct Args {
 bool parseArgs(int argc, char** argv, Args* out) {
     for (int i = 1; i < argc; ++i) {
         string a(argv[i]);
-        if (a == "--geojson" && i + 1 < argc) {
+        if (i == 1 && (a == "serve" || a == "assign")) {
+            (*out).command = a;
+        } else if (a == "--geojson" && i + 1 < argc) {
             (*out).geojsonPath = argv[++i];
+        } else if (a == "--points" && i + 1 < argc) {
+            (*out).pointsPath = argv[++i];
+        } else if (a == "--emit" && i + 1 < argc) {
+            const string emit(argv[++i]);
+            if (emit != "ids" && emit != "counts") return false;
+            (*out).emitIds = emit == "ids";
+        } else if (a == "--socket" && i + 1 < argc) {
+            (*out).socketPath = argv[++i];
         } else if (a == "--out" && i + 1 < argc) {
             (*out).outCsv = argv[++i];
+        } else if (a == "--series" && i + 1 < argc) {
+            (*out).seriesCsv = argv[++i];
+        } else if (a == "--arrow" && i + 1 < argc) {
+            (*out).seriesArrow = argv[++i];
+        } else if (a == "--snapshot" && i + 1 < argc) {
+            (*out).snapshotPath = argv[++i];
+        } else if (a == "--deleted" && i + 1 < argc) {
+            (*out).deletedIds = argv[++i];
+        } else if (a == "--full-refresh") {
+            (*out).fullRefresh = true;
+        } else if (a == "--heatmap" && i + 1 < argc) {
+            (*out).heatmapPath = argv[++i];
+        } else if (a == "--heatmap-cell-m" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], &(*out).heatmapCellMetres)) return false;
+        } else if (a == "--heatmap-bandwidth-m" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], &(*out).heatmapBandwidthMetres)) return false;
+        } else if (a == "--level" && i + 1 < argc) {
+            const string spec(argv[++i]);
+            const size_t eq = spec.find('=');
+            if (eq == string::npos || eq == 0 || eq + 1 == spec.size()) return false;
+            (*out).levels.emplace_back(spec.substr(0, eq), spec.substr(eq + 1));
+        } else if (a == "--rollup" && i + 1 < argc) {
+            (*out).rollupCsv = argv[++i];
+        } else if (a == "--stats" && i + 1 < argc) {
+            (*out).statsPath = argv[++i];
+        } else if (a == "--trace" && i + 1 < argc) {
+            (*out).tracePath = argv[++i];
+        } else if (a == "--weighted" && i + 1 < argc) {
+            (*out).weightedCsv = argv[++i];
+        } else if (a == "--weighted-samples" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], &(*out).fractional.samples)) return false;
+        } else if (a == "--sort" && i + 1 < argc) {
+            const string order(argv[++i]);
+            if (order == "id") {
+                (*out).sort = SortOrder::Id;
+            } else if (order == "count") {
+                (*out).sort = SortOrder::Count;
+            } else if (order == "name") {
+                (*out).sort = SortOrder::Name;
+            } else {
+                return false;
+            }
+        } else if (a == "--bucket-days" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], &(*out).bucketDays)) return false;
+        } else if (a == "--nearest-m" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], &(*out).nearestMetres)) return false;
+        } else if (a == "--index" && i + 1 < argc) {
+            const string name(argv[++i]);
+            if (name != "linear" && name != "grid" && name != "trapezoid") return false;
+            (*out).indexStrategy = suburb::parseIndexStrategy(name);
+        } else if (a == "--index-cache" && i + 1 < argc) {
+            (*out).indexCache = argv[++i];
+        } else if (a == "--window-days" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], &(*out).shard.windowDays)) return false;
+        } else if (a == "--fetch-concurrency" && i + 1 < argc) {
+            int n = 0;
+            if (!parsePositive(argv[++i], &n)) return false;
+            (*out).shard.concurrency = static_cast<unsigned>(n);
+        } else if (a == "--top" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], &(*out).top)) return false;
+        } else if (a == "--threads" && i + 1 < argc) {
+            int n = 0;
+            if (!parsePositive(argv[++i], &n)) return false;
+            (*out).threads = static_cast<unsigned>(n);
         } else if (a == "--help" || a == "-h") {
             return false;
         }
     }
+    if ((*out).command == "serve" && !(*out).socketPath) return false;
+    if ((*out).command == "assign" && !(*out).pointsPath) return false;
     return !(*out).geojsonPath.empty();
 }
 
@@ -83,7 +252,186 @@ bool parseArgs(int argc, char** argv, Args* out) {
 void usage(const char* exe) {
     cerr << "Usage:\n"
     << "  " << exe
-    << " --geojson /path/to/melbourne_suburbs.geojson [--out counts.csv]\n";
+    << " --geojson /path/to/melbourne_suburbs.geojson [--out counts.csv]\n"
+    << "      [--series series.csv] [--arrow series.arrow] [--bucket-days 7] [--sort id|count|name]\n"
+    << "      [--window-days 7] [--fetch-concurrency 4] [--top 1] [--threads N] [--nearest-m 0]\n"
+    << "      [--index linear|grid|trapezoid [--index-cache map.bin]] [--level lga=lga.geojson ...]\n"
+    << "      [--rollup rollup.csv]\n"
+    << "      [--snapshot state.snap [--deleted ids.txt] [--full-refresh]]\n"
+    << "      [--heatmap heat.bin [--heatmap-cell-m 250] [--heatmap-bandwidth-m 500]]\n"
+    << "      [--weighted weighted.csv [--weighted-samples 32]] [--stats stats.json] [--trace trace.json]\n"
+    << "  " << exe
+    << " serve --geojson /path/to/melbourne_suburbs.geojson --socket /run/tawny.sock [--threads N] [--index grid]\n"
+    << "  " << exe
+    << " assign --geojson /path/to/melbourne_suburbs.geojson --points points.csv|-\n"
+    << "      [--emit counts|ids] [--out out.csv|-] [--sort id|count|name] [--threads N] [--index grid]\n"
+    << "      [--level lga=lga.geojson ... --rollup rollup.csv] [--stats stats.json] [--trace trace.json]\n";
+}
+
+// Loads the suburbs GeoJSON and builds the index over it, timing the build
+//
+// Args:
+//     args: parsed arguments (geojsonPath, indexStrategy, indexCache)
+//     minLon, minLat, maxLon, maxLat: set to the union bbox of the suburbs
+// Returns:
+//     the suburb index
+SuburbIndex loadIndex(const Args& args, double* minLon, double* minLat, double* maxLon, double* maxLat) {
+    vector<Suburb> suburbs = loadSuburbsGeoJSON(args.geojsonPath, minLon, minLat, maxLon, maxLat);
+    ScopedTimer timer("index_build");
+    timer.setItems(suburbs.size());
+    return SuburbIndex(std::move(suburbs), args.indexStrategy, args.indexCache.value_or(""));
+}
+
+// Writes --stats as JSON and prints the human summary, adding the memory held
+// by the loaded geometry and index, and the per-query counters when built with
+// ENABLE_QUERY_STATS
+//
+// Args:
+//     args: parsed arguments (statsPath)
+//     index: the suburb index, for suburb names
+void reportStats(const Args& args, const SuburbIndex& index) {
+    if (!args.statsPath) return;
+    suburb::reportQueryStats(index.suburbs(), &stats::global());
+    const suburb::GeometryBytes geometry = suburb::geometryBytes(index.suburbs());
+    stats::global().recordBytes("suburb_names", geometry.names);
+    stats::global().recordBytes("suburb_vertices", geometry.vertices);
+    stats::global().recordBytes("suburb_chains", geometry.chains);
+    stats::global().recordBytes("suburb_rings", geometry.rings);
+    stats::global().recordBytes("suburb_polygons", geometry.polygons);
+    stats::global().recordBytes("suburb_array", geometry.suburbs);
+    stats::global().recordBytes("index", index.memoryBytes());
+    stats::writeStatsJson(*args.statsPath, stats::global());
+    cerr << stats::global().summary() << "Wrote run statistics to " << *args.statsPath << "\n";
+}
+
+// Writes --trace as Chrome trace-event JSON
+//
+// Args:
+//     args: parsed arguments (tracePath)
+void reportTrace(const Args& args) {
+    if (!args.tracePath) return;
+    trace::stop();
+    trace::writeTrace(*args.tracePath);
+    cerr << "Wrote trace to " << *args.tracePath << " (open in chrome://tracing or ui.perfetto.dev)\n";
+}
+
+// Reads observation ids, one per line (blank lines ignored)
+//
+// Args:
+//     path: the id list file
+// Returns:
+//     the ids
+vector<uint64_t> readIdList(const string& path) {
+    ifstream in(path);
+    if (!in) throw runtime_error("Failed to open id list: " + path);
+    vector<uint64_t> ids;
+    string line;
+    while (std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        ids.push_back(std::stoull(line));
+    }
+    return ids;
+}
+
+// server being run by serve(), for the signal handler
+LookupServer* g_server = nullptr;
+
+// Stops the lookup server on SIGINT/SIGTERM
+extern "C" void stopServer(int) {
+    if (g_server) g_server->stop();
+}
+
+// Loads the suburbs and index once and answers point lookups on a Unix-domain socket
+//
+// Args:
+//     args: parsed arguments (geojsonPath, socketPath, threads)
+// Returns:
+//     process exit code
+int serve(const Args& args) {
+    double minLon, minLat, maxLon, maxLat;
+    const SuburbIndex index = loadIndex(args, &minLon, &minLat, &maxLon, &maxLat);
+    const vector<Suburb>& suburbs = index.suburbs();
+    LookupServer lookupServer(index, *args.socketPath, args.threads);
+    g_server = &lookupServer;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    cerr << "Serving lookups for " << suburbs.size() << " suburbs on " << lookupServer.socketPath() << "\n";
+    lookupServer.run();
+    g_server = nullptr;
+    cerr << "Lookup server stopped\n";
+    return 0;
+}
+
+// Loads the --level layers above the suburbs and writes every level's counts
+// to --rollup, each coarser level summed from the suburb counts
+//
+// Args:
+//     args: parsed arguments (levels, rollupCsv, threads)
+//     index: the suburb index (finest level)
+//     counts: per-suburb counts
+void writeRollup(const Args& args, const SuburbIndex& index, const vector<uint64_t>& counts) {
+    ScopedTimer timer("rollup");
+    Hierarchy levels(index);
+    for (const auto& level : args.levels) {
+        double minLon, minLat, maxLon, maxLat;
+        levels.addLevel(level.first, loadSuburbsGeoJSON(level.second, &minLon, &minLat, &maxLon, &maxLat),
+            args.threads);
+        cerr << "Level " << level.first << " loaded: " << levels.level(levels.levels() - 1).index.size() << " units\n";
+    }
+    writeRollupCsv(*args.rollupCsv, levels, levels.rollUp(counts));
+    cerr << "Wrote " << levels.levels() << "-level rollup CSV to " << *args.rollupCsv << "\n";
+}
+
+// Assigns lon/lat rows from a file or stdin to suburbs, writing per-suburb
+// counts or one suburb id per row
+//
+// Args:
+//     args: parsed arguments (geojsonPath, pointsPath, emitIds, outCsv, sort, threads)
+// Returns:
+//     process exit code
+int assignCommand(const Args& args) {
+    double minLon, minLat, maxLon, maxLat;
+    const SuburbIndex index = loadIndex(args, &minLon, &minLat, &maxLon, &maxLat);
+    const vector<Suburb>& suburbs = index.suburbs();
+    const bool toStdout = !args.outCsv || *args.outCsv == "-";
+
+    std::ios::sync_with_stdio(false);
+    ifstream file;
+    if (*args.pointsPath != "-") {
+        file.open(*args.pointsPath, std::ios::binary);
+        if (!file) throw runtime_error("Failed to open points: " + *args.pointsPath);
+    }
+    std::istream& in = *args.pointsPath == "-" ? std::cin : file;
+
+    vector<uint64_t> counts;
+    AssignStats stats;
+    if (args.emitIds) {
+        ScopedTimer timer("assign");
+        std::unique_ptr<CsvWriter> ids = toStdout ? std::make_unique<CsvWriter>(std::cout)
+            : std::make_unique<CsvWriter>(*args.outCsv);
+        ids->raw("suburb_id").endRow();
+        stats = assignPoints(in, index, args.threads, &counts, ids.get());
+        ids->close();
+        timer.setItems(stats.rows);
+    } else {
+        {
+            ScopedTimer timer("assign");
+            stats = assignPoints(in, index, args.threads, &counts, nullptr);
+            timer.setItems(stats.rows);
+        }
+        ScopedTimer timer("write_outputs");
+        const vector<uint32_t> order = orderSuburbs(suburbs, counts, args.sort);
+        if (toStdout) writeCountsCsv(std::cout, suburbs, counts, order);
+        else writeCountsCsv(*args.outCsv, suburbs, counts, order);
+    }
+    stats::global().add("points_read", stats.rows);
+    stats::global().add("points_assigned", stats.assigned);
+    cerr << "Points read: " << stats.rows << ", assigned: " << stats.assigned
+        << ", skipped (no valid coordinates): " << stats.skipped << "\n";
+    if (args.rollupCsv) writeRollup(args, index, counts);
+    reportStats(args, index);
+    reportTrace(args);
+    return 0;
 }
 
 // Entry point
@@ -93,11 +441,26 @@ int main(int argc, char** argv) {
         usage(argv[0]);
         return 1;
     }
+    if (args.tracePath) {
+        trace::start();
+        trace::setThreadName("main");
+    }
+    stats::setEnabled(args.statsPath.has_value());
+
+    if (!args.command.empty()) {
+        try {
+            return args.command == "serve" ? serve(args) : assignCommand(args);
+        } catch (const exception& e) {
+            cerr << "Fatal: " << e.what() << "\n";
+            return 2;
+        }
+    }
 
     try {
         // 1) Load suburbs
         double minLon, minLat, maxLon, maxLat;  // collect bonding box for Victoria
-        auto suburbs = loadSuburbsGeoJSON(args.geojsonPath, &minLon, &minLat, &maxLon, &maxLat);
+        const SuburbIndex index = loadIndex(args, &minLon, &minLat, &maxLon, &maxLat);
+        const vector<Suburb>& suburbs = index.suburbs();
 
         // 2) Fetch iNaturalist sightings for Spring 2025
 
@@ -110,57 +473,161 @@ int main(int argc, char** argv) {
             << "] for " << TAWNY_TAXON << " from " << SPRING_2025_START_DATE
             << " to " << SPRING_2025_END_DATE << " ...\n";
 
+        const int firstDay = parseIsoDate(SPRING_2025_START_DATE);
+        const int lastDay = parseIsoDate(SPRING_2025_END_DATE);
+
+        // A previous snapshot means only observations updated since then are fetched
+        optional<Snapshot> snap;
+        if (args.snapshotPath && ifstream(*args.snapshotPath).good()) {
+            snap = Snapshot::load(*args.snapshotPath, suburbs);
+            if (snap->matrix().firstDay() != firstDay || snap->matrix().bucketDays() != args.bucketDays)
+                throw runtime_error("Snapshot bucket layout differs from --bucket-days: " + *args.snapshotPath);
+            if (!args.fullRefresh) args.shard.updatedSince = snap->fetchedAt();
+            cerr << "Loaded snapshot of " << snap->observations() << " observations fetched at "
+                << snap->fetchedAt() << "\n";
+        }
+
+        const string fetchedAt = utcTimestamp();
         CurlHttpClient client;
-        auto obs = fetchINatPoints(client, TAWNY_TAXON, SPRING_2025_START_DATE, SPRING_2025_END_DATE,
-            swlat, swlng, nelat, nelng);
+        vector<ObsPoint> obs;
+        vector<DateWindow> failedWindows;
+        {
+            ScopedTimer timer("fetch");
+            obs = fetchINatPointsSharded(client, TAWNY_TAXON, SPRING_2025_START_DATE, SPRING_2025_END_DATE,
+                swlat, swlng, nelat, nelng, args.shard, &failedWindows);
+            timer.setItems(obs.size());
+        }
+        if (!failedWindows.empty()) {
+            // a partial fetch must not reconcile away, or move fetchedAt past, what it missed
+            cerr << "Failed to fetch " << failedWindows.size() << " date window(s):";
+            for (const auto& w : failedWindows)
+                cerr << " " << formatIsoDate(w.firstDay) << ".." << formatIsoDate(w.lastDay);
+            cerr << "\n";
+            throw runtime_error(args.snapshotPath ? "Fetch incomplete; snapshot left unchanged: " + *args.snapshotPath
+                                                  : string("Fetch incomplete; no counts written"));
+        }
+        stats::global().add("observations_fetched", obs.size());
+        stats::global().recordBytes("observations", obs.capacity() * sizeof(ObsPoint));
         cerr << "Observations fetched (with coordinates): " << obs.size() << "\n";
 
-        // 3) Assign to suburb
-        unordered_map<std::string, std::uint64_t> counts;
-        counts.reserve(suburbs.size() * 2);
-
-        // Basic spatial filter: try suburb axis-aligned bounding boxs then precise PIP
-        size_t assigned = 0;
-        for (const auto& op : obs) {
-            // quick reject using global bbox is unnecessary here; obs already limited by bbox
-            // find first matching suburb (they should not overlap meaningfully)
-            for (const auto& s : suburbs) {
-                if (!pointInSuburb(s, Point{op.lon, op.lat})) continue;
-                counts[s.name] += 1;
-                ++assigned;
-                break;
+        // 3) Assign to suburb, counting densely by suburb id (index into suburbs) and time bucket
+        CountMatrix matrix;
+        ScopedTimer assignTimer("assign");
+        assignTimer.setItems(obs.size());
+        if (args.snapshotPath) {
+            // snapshot mode: apply the fetched observations as a delta
+            DeltaStats delta;
+            if (!snap) {
+                snap.emplace(suburbs, firstDay, lastDay, args.bucketDays);
+                delta = snap->apply(index, obs, {}, args.threads, args.nearestMetres);
+            } else if (args.fullRefresh) {
+                delta = snap->reconcile(index, obs, args.threads, args.nearestMetres);
+            } else {
+                const vector<uint64_t> deleted = args.deletedIds ? readIdList(*args.deletedIds) : vector<uint64_t>{};
+                delta = snap->apply(index, obs, deleted, args.threads, args.nearestMetres);
             }
+            cerr << "Snapshot delta: " << delta.inserted << " inserted, " << delta.updated << " updated, "
+                << delta.deleted << " deleted, " << delta.unchanged << " unchanged";
+            if (delta.relocated > 0) cerr << ", " << delta.relocated << " relocated for the new --nearest-m";
+            cerr << "\n";
+            snap->setFetchedAt(fetchedAt);
+            snap->save(*args.snapshotPath);
+            matrix = snap->matrix();
+            stats::global().add("observations_assigned", snap->assigned());
+            cerr << "Assigned observations: " << snap->assigned() << "\n";
+        } else {
+            CountStats stats;
+            matrix = countObservations(index, obs, firstDay, lastDay,
+                args.bucketDays, args.threads, &stats, args.nearestMetres);
+            stats::global().add("observations_assigned", stats.assigned);
+            cerr << "Assigned observations: " << stats.assigned << "\n";
+            if (stats.nearest > 0)
+                cerr << "  of which within " << args.nearestMetres << " m of a suburb: " << stats.nearest << "\n";
+            if (stats.undated > 0) cerr << "Skipped observations without a date in range: " << stats.undated << "\n";
         }
-        cerr << "Assigned observations: " << assigned << "\n";
-
-        // 4) Find the top suburb
-        string topSuburb;
-        uint64_t topCount = 0;
-        for (const auto& kv : counts) {
-            if (kv.second > topCount) {
-                topSuburb = kv.first;
-                topCount = kv.second;
-            }
+        const vector<uint64_t> counts = matrix.totals();
+        assignTimer.stop();
+        stats::global().recordBytes("count_matrix", matrix.size() * sizeof(uint64_t));
+
+        // Optional kernel density heatmap over the suburbs' bbox
+        if (args.heatmapPath) {
+            ScopedTimer timer("heatmap");
+            // a delta fetch only holds changed observations; the snapshot has them all
+            const vector<ObsPoint> points = snap ? snap->points() : obs;
+            Raster raster = makeRaster(minLon, minLat, maxLon, maxLat, args.heatmapCellMetres);
+            rasterise(points, &raster, args.threads);
+            gaussianBlur(&raster, static_cast<double>(args.heatmapBandwidthMetres) / args.heatmapCellMetres,
+                args.threads);
+            writeRaster(*args.heatmapPath, raster);
+            const string summaryPath = *args.heatmapPath + ".suburbs.csv";
+            writeSummaryCsv(summaryPath, suburbs, summariseSuburbs(suburbs, raster, args.threads));
+            cerr << "Wrote " << raster.cols << "x" << raster.rows << " heatmap to " << *args.heatmapPath
+                << " and suburb summaries to " << summaryPath << "\n";
         }
 
-        if (topCount == 0) {
+        // Optional accuracy-weighted counts: each observation spread over its uncertainty circle
+        vector<double> weighted;
+        if (args.weightedCsv) {
+            ScopedTimer timer("weighted");
+            const vector<ObsPoint> points = snap ? snap->points() : obs;
+            FractionalStats stats;
+            FractionalOptions options = args.fractional;
+            options.nearestMetres = args.nearestMetres;
+            weighted = countFractional(index, points, firstDay, lastDay, options, args.threads, &stats);
+            cerr << "Accuracy-weighted observations: " << stats.whole << " whole, " << stats.spread
+                << " split across suburbs, " << stats.unassigned << " outside every suburb\n";
+            if (stats.nearest > 0)
+                cerr << "  credited to the nearest suburb within " << args.nearestMetres << " m: " << stats.nearest
+                    << "\n";
+            if (stats.undated > 0)
+                cerr << "  skipped for lacking a date in range: " << stats.undated << "\n";
+        }
+
+        // 4) Rank the top suburbs (ties go to the suburb listed first in the GeoJSON)
+        vector<ranking::RankedSuburb> ranked;
+        {
+            ScopedTimer timer("rank");
+            ranked = topK(counts, static_cast<size_t>(args.top), args.threads);
+        }
+
+        if (ranked.empty()) {
             cout << "No Tawny Frogmouth observations found in Spring 2025 for the provided suburbs.\n";
+        } else if (args.top == 1) {
+            cout << "Top suburb (Spring 2025): " << suburbs[ranked[0].id].name
+                << " — " << ranked[0].count << " sightings\n";
         } else {
-            cout << "Top suburb (Spring 2025): " << topSuburb
-                << " — " << topCount << " sightings\n";
+            cout << "Top " << ranked.size() << " suburbs (Spring 2025):\n";
+            for (size_t i = 0; i < ranked.size(); ++i) {
+                cout << "  " << (i + 1) << ". " << suburbs[ranked[i].id].name
+                    << " — " << ranked[i].count << " sightings\n";
+            }
         }
 
-        // Optional CSV output
-        if (args.outCsv) {
-            ofstream out(*args.outCsv);
-            if (!out) throw runtime_error("Failed to open CSV for writing: " + *args.outCsv);
-            out << "suburb,count\n";
-            for (const auto& kv : counts) {
-                // Quote suburb in case of commas
-                out << "\"" << kv.first << "\"," << kv.second << "\n";
+        // Optional CSV / Arrow outputs
+        if (args.outCsv || args.seriesCsv || args.seriesArrow || args.weightedCsv) {
+            ScopedTimer timer("write_outputs");
+            const vector<uint32_t> order = orderSuburbs(suburbs, counts, args.sort);
+            if (args.outCsv) {
+                writeCountsCsv(*args.outCsv, suburbs, counts, order);
+                cerr << "Wrote counts CSV to " << *args.outCsv << "\n";
+            }
+            // time series: every bucket of each suburb with sightings
+            if (args.seriesCsv) {
+                writeSeriesCsv(*args.seriesCsv, suburbs, matrix, order);
+                cerr << "Wrote time series CSV to " << *args.seriesCsv << "\n";
+            }
+            if (args.seriesArrow) {
+                writeSeriesArrow(*args.seriesArrow, suburbs, matrix, order);
+                cerr << "Wrote time series Arrow file to " << *args.seriesArrow << "\n";
+            }
+            if (args.weightedCsv) {
+                writeWeightedCsv(*args.weightedCsv, suburbs, counts, weighted, order);
+                cerr << "Wrote accuracy-weighted counts CSV to " << *args.weightedCsv << "\n";
             }
-            cerr << "Wrote counts CSV to " << *args.outCsv << "\n";
         }
+        if (args.rollupCsv) writeRollup(args, index, counts);
+        reportStats(args, index);
+        reportTrace(args);
     } catch (const exception& e) {
         cerr << "Fatal: " << e.what() << "\n";
         return 2;
@@ -14,20 +14,29 @@
 
 #include "observations.hpp"
 #include <curl/curl.h>            // for curl_easy_setopt, curl_easy_cleanup
-#include <chrono>                 // for milliseconds
+#include <algorithm>              // for min, max, stable_sort, unique
+#include <chrono>                 // for milliseconds, steady_clock
 #include <cmath>                  // for isnan, NAN
+#include <condition_variable>     // for condition_variable
+#include <cstdint>                // for int64_t
+#include <cstdio>                 // for snprintf
+#include <ctime>                  // for time, gmtime_r, strftime
+#include <deque>                  // for deque
 #include <exception>              // for exception
 #include <iostream>               // for basic_ostream, operator<<, basic_os...
 #include <map>                    // for operator!=, operator==
+#include <mutex>                  // for mutex, lock_guard, unique_lock
 #include <nlohmann/json.hpp>      // for basic_json
 #include <nlohmann/json_fwd.hpp>  // for json
 #include <optional>               // for optional
-#include <sstream>                // for basic_ostringstream
+#include <sstream>                // for basic_ostringstream, basic_istringstream
 #include <stdexcept>              // for runtime_error
 #include <string>                 // for char_traits, basic_string, allocator
-#include <thread>                 // for sleep_for
+#include <thread>                 // for sleep_for, sleep_until, thread
 #include <unordered_map>          // for unordered_map
 #include <vector>                 // for vector
+#include "stats.hpp"              // for ScopedTimer, global, enabled, jsonBytes
+#include "trace.hpp"              // for Span, setThreadName
 #include "utils.hpp"              // for HttpResponse, CurlHttpClient, IHttpClient
 
 using std::string;
@@ -38,16 +47,30 @@ using std::isnan;
 using std::runtime_error;
 using std::exception;
 using std::this_thread::sleep_for;
+using std::this_thread::sleep_until;
 using std::optional;
 using std::ostringstream;
+using std::istringstream;
+using std::min;
+using std::max;
+using std::deque;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::condition_variable;
+using std::thread;
 using std::unordered_map;
 using std::chrono::milliseconds;
+using std::chrono::steady_clock;
 using json = nlohmann::json;
 
 using observations::ObsPoint;
+using observations::DateWindow;
+using observations::ShardOptions;
 using observations::URL_BASE;
 using observations::USER_AGENT;
 using observations::PER_PAGE;
+using observations::UNKNOWN_DAY;
 
 using utils::HttpResponse;
 using utils::IHttpClient;
@@ -55,6 +78,32 @@ using utils::CurlHttpClient;
 
 namespace observations {
 
+namespace {
+
+// client.get(url), recorded as one "http_request" with the bytes received
+HttpResponse timedGet(IHttpClient& client, const string& url) {
+    stats::ScopedTimer timer("http_request");
+    stats::global().add("http_requests");
+    HttpResponse resp = client.get(url);
+    timer.setItems(resp.body.size());
+    stats::global().add("http_bytes", resp.body.size());
+    return resp;
+}
+
+// json::parse(body), recorded as one "json_parse" of body's bytes
+json timedParse(const string& body) {
+    stats::ScopedTimer timer("json_parse");
+    timer.setItems(body.size());
+    json j = json::parse(body);
+    if (stats::enabled()) {
+        stats::global().recordBytes("http_page_body", body.capacity());
+        stats::global().recordBytes("http_page_dom", stats::jsonBytes(j));
+    }
+    return j;
+}
+
+}  // namespace
+
 // Returns encoded url for inaturalist API calls
 //
 // Args:
@@ -78,19 +127,203 @@ string urlEncode(const string& url) {
 //   response from the API call
 string httpGet(IHttpClient& client, const string& url) {
     try {
-        HttpResponse resp = client.get(url);
+        HttpResponse resp = timedGet(client, url);
 
         if (resp.status < 200 || resp.status >= 300) {
+            stats::global().add("http_failures");
             return "";
         }
 
         return resp.body;
     }
     catch (...) {
+        stats::global().add("http_failures");
         return "";
     }
 }
 
+// Converts an ISO yyyy-mm-dd date into days since 1970-01-01
+// (proleptic Gregorian calendar, see http://howardhinnant.github.io/date_algorithms.html)
+//
+// Args:
+//    ymd: the date, e.g. "2025-09-01"
+// Returns:
+//    number of days since the unix epoch (negative before 1970)
+int parseIsoDate(const string& ymd) {
+    int y = 0;
+    unsigned m = 0, d = 0;
+    char dash1 = 0, dash2 = 0;
+    istringstream in(ymd);
+    in >> y >> dash1 >> m >> dash2 >> d;
+    if (!in || dash1 != '-' || dash2 != '-' || m < 1 || m > 12 || d < 1 || d > 31)
+        throw runtime_error("Invalid date (expected yyyy-mm-dd): " + ymd);
+
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+// Converts days since 1970-01-01 back into an ISO yyyy-mm-dd date
+//
+// Args:
+//    days: number of days since the unix epoch
+// Returns:
+//    the date formatted as yyyy-mm-dd
+string formatIsoDate(int days) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    const int y = static_cast<int>(yoe) + era * 400 + (m <= 2);
+
+    char buf[36];  // room for any int year and unsigned month/day, so the output never truncates
+    snprintf(buf, sizeof(buf), "%04d-%02u-%02u", y, m, d);
+    return buf;
+}
+
+// Current UTC time as an ISO 8601 timestamp, e.g. for updated_since
+//
+// Returns:
+//    the time formatted as yyyy-mm-ddThh:mm:ssZ
+string utcTimestamp() {
+    const time_t now = time(nullptr);
+    tm utc{};
+    gmtime_r(&now, &utc);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buf;
+}
+
+// Splits the inclusive date range d1..d2 into consecutive windows
+//
+// Args:
+//    d1: first date of the range (yyyy-mm-dd)
+//    d2: last date of the range (yyyy-mm-dd)
+//    windowDays: width of each window in days; the final window may be shorter
+// Returns:
+//    windows covering d1..d2 without overlap, in date order
+vector<DateWindow> splitDateRange(const string& d1, const string& d2, int windowDays) {
+    if (windowDays < 1) throw runtime_error("windowDays must be at least 1");
+    const int first = parseIsoDate(d1);
+    const int last = parseIsoDate(d2);
+
+    vector<DateWindow> windows;
+    for (int start = first; start <= last; start += windowDays) {
+        windows.push_back(DateWindow{start, min(last, start + windowDays - 1)});
+    }
+    return windows;
+}
+
+namespace {
+
+// Builds the observations query url for one page
+string buildQueryUrl(
+    const string& taxonName, const string& d1, const string& d2,
+    double swlat, double swlng, double nelat, double nelng, int page,
+    const string& updatedSince = "") {
+    ostringstream url;
+    url << URL_BASE
+        << "?taxon_name=" << urlEncode(taxonName)
+        << "&d1=" << d1
+        << "&d2=" << d2
+        << "&swlat=" << fixed << swlat
+        << "&swlng=" << fixed << swlng
+        << "&nelat=" << fixed << nelat
+        << "&nelng=" << fixed << nelng
+        << "&geo=true"
+        << "&order_by=observed_on"
+        << "&per_page=" << PER_PAGE
+        << "&page=" << page;
+    if (!updatedSince.empty()) url << "&updated_since=" << urlEncode(updatedSince);
+    return url.str();
+}
+
+// Whether a page is the last one to fetch: pages past the end come back
+// empty, and counting kept observations is no guide because results without
+// coordinates are dropped and total_results can shrink during a fetch
+//
+// Args:
+//    j: the parsed page
+//    page: its 1-based page number
+//    total_results: total_results from the first page, -1 if it had none
+bool isLastPage(const json& j, int page, int total_results) {
+    return j["results"].empty() || static_cast<int64_t>(page) * PER_PAGE >= total_results;
+}
+
+// Appends the georeferenced results of one page to out
+//
+// Args:
+//    j: the parsed page
+//    out: observations found on the page are appended here
+// Returns:
+//    false if the page has no results array
+bool appendResults(const json& j, vector<ObsPoint>* out) {
+    if (!j.contains("results") || !j["results"].is_array()) return false;
+
+    for (auto& item : j["results"]) {
+        // Skip if no geojson or coordinates
+        if (!item.contains("geojson")) continue;
+        if (!item["geojson"].contains("coordinates")) continue;
+        // Skip if coordinates are not an array of size 2
+        auto coords = item["geojson"]["coordinates"];
+        if (!coords.is_array() || coords.size() != 2) continue;
+        // get the coordinates and add to output
+        ObsPoint p;
+        p.lon = coords[0].get<double>();
+        p.lat = coords[1].get<double>();
+        if (item.contains("id") && item["id"].is_number_integer()) p.id = item["id"].get<uint64_t>();
+        if (item.contains("positional_accuracy") && item["positional_accuracy"].is_number())
+            p.accuracy = max(0.0, item["positional_accuracy"].get<double>());
+        if (item.contains("observed_on") && item["observed_on"].is_string()) {
+            try {
+                p.day = parseIsoDate(item["observed_on"].get<string>());
+            } catch (const runtime_error&) {
+                p.day = UNKNOWN_DAY;
+            }
+        }
+        out->push_back(p);
+    }
+    return true;
+}
+
+// GET with retries on throttling (429), server errors and transport failures
+//
+// Args:
+//    client: the HTTP client to use for making the request
+//    url: the API url
+//    maxRetries: number of additional attempts
+//    delayMs: base backoff in milliseconds, doubled on each retry
+// Returns:
+//    response body, or empty string if every attempt failed
+string httpGetWithRetry(IHttpClient& client, const string& url, int maxRetries, int delayMs) {
+    for (int attempt = 0; ; ++attempt) {
+        bool transient = true;
+        try {
+            HttpResponse resp = timedGet(client, url);
+            if (resp.status >= 200 && resp.status < 300) return resp.body;
+            transient = resp.status == 429 || resp.status >= 500;
+        } catch (...) {
+            transient = true;
+        }
+        if (!transient || attempt >= maxRetries) {
+            stats::global().add("http_failures");
+            return "";
+        }
+        stats::global().add("http_retries");
+        trace::Span backoff("retry_backoff", "fetch");
+        sleep_for(milliseconds(static_cast<int64_t>(delayMs) << attempt));
+    }
+}
+
+}  // namespace
+
 // Fetches observation points from iNaturalist
 //
 // Args:
@@ -119,27 +352,14 @@ vector<ObsPoint> fetchINatPoints(
     int total_results = -1;
 
     while (true) {
-        ostringstream url;
-        url << URL_BASE
-            << "?taxon_name=" << urlEncode(taxonName)
-            << "&d1=" << d1
-            << "&d2=" << d2
-            << "&swlat=" << fixed << swlat
-            << "&swlng=" << fixed << swlng
-            << "&nelat=" << fixed << nelat
-            << "&nelng=" << fixed << nelng
-            << "&geo=true"
-            << "&order_by=observed_on"
-            << "&per_page=" << PER_PAGE
-            << "&page=" << page;
-
-        const string body = httpGet(client, url.str());
+        const string body = httpGet(client,
+            buildQueryUrl(taxonName, d1, d2, swlat, swlng, nelat, nelng, page));
 
         if (body.empty()) break;
 
         json j;
         try {
-            j = json::parse(body);
+            j = timedParse(body);
         } catch(...) {
             break;
         }
@@ -148,28 +368,178 @@ vector<ObsPoint> fetchINatPoints(
             total_results = j["total_results"];
         }
 
-        if (!j.contains("results") || !j["results"].is_array()) break;
-
-        for (auto& item : j["results"]) {
-            // Skip if no geojson or coordinates
-            if (!item.contains("geojson")) continue;
-            if (!item["geojson"].contains("coordinates")) continue;
-            // Skip if coordinates are not an array of size 2
-            auto coords = item["geojson"]["coordinates"];
-            if (!coords.is_array() || coords.size() != 2) continue;
-            // get the coordinates and add to output
-            ObsPoint p;
-            p.lon = coords[0].get<double>();
-            p.lat = coords[1].get<double>();
-            out.push_back(p);
-        }
+        if (!appendResults(j, &out)) break;
+        stats::global().add("pages");
 
         // If we've fetched all results, break
-        if (static_cast<int>(out.size()) >= total_results) break;
+        if (isLastPage(j, page, total_results)) break;
 
         ++page;
         sleep_for(milliseconds(1100));  // politeness delay
     }
     return out;
 }
+
+// Fetches observation points from iNaturalist, splitting d1..d2 into date windows
+// that are fetched concurrently with shallow pagination. Windows whose
+// total_results exceed options.maxResultsPerWindow are halved until they fit
+// (or are a single day). Results are merged and deduplicated by observation id.
+// A window whose page cannot be fetched (after retries) or parsed contributes
+// nothing and is reported, so callers never mistake a partial fetch for a full one.
+//
+// Args:
+//    client: the HTTP client to use; get() is called from several threads at once
+//    taxonName: the taxonomical name of the animal or plant species
+//    d1: must be observed on or after this date
+//    d2: must be observed on or before this date
+//    swlat: south-western latitude component of bounding box
+//    swlng: south-western longitude component of bounding box
+//    nelat: north-eastern lattitude component of bounding box
+//    nelng: north-eastern longitude component of bounding box
+//    options: window width, split threshold, concurrency and politeness settings
+//    failedWindows: if not null, set to the windows that failed (ordered by first day) and the
+//                   remaining windows are still fetched; if null, the first failure stops the
+//                   fetch and is thrown as runtime_error
+// Returns:
+//    vector of observation points, ordered by observation id
+vector<ObsPoint> fetchINatPointsSharded(
+    IHttpClient& client,
+    const string& taxonName,
+    const string& d1, const string& d2,
+    double swlat, double swlng, double nelat, double nelng,
+    const ShardOptions& options,
+    vector<DateWindow>* failedWindows) {
+
+    const vector<DateWindow> initial = splitDateRange(d1, d2, options.windowDays);
+    deque<DateWindow> queue(initial.begin(), initial.end());
+    size_t pending = queue.size();  // queued + in-flight windows
+    mutex mtx;
+    condition_variable cv;
+    vector<ObsPoint> merged;
+    vector<DateWindow> failed;
+    string firstError;
+    bool stopping = false;
+    steady_clock::time_point nextRequest = steady_clock::now();  // shared politeness limit
+
+    // Waits until the next request is allowed: requests from all workers
+    // together are spaced at least options.pageDelayMs apart
+    auto politenessDelay = [&]() {
+        steady_clock::time_point at;
+        {
+            lock_guard<mutex> lock(mtx);
+            at = max(steady_clock::now(), nextRequest);
+            nextRequest = at + milliseconds(options.pageDelayMs);
+        }
+        if (at > steady_clock::now()) {
+            trace::Span delay("politeness_delay", "fetch");
+            sleep_until(at);
+        }
+    };
+
+    // Fetches every page of one window into out.
+    // Returns false (and fetches nothing more) if the window should be split;
+    // throws runtime_error if a page cannot be fetched or parsed.
+    auto fetchWindow = [&](const DateWindow& w, vector<ObsPoint>* out) {
+        const string wd1 = formatIsoDate(w.firstDay);
+        const string wd2 = formatIsoDate(w.lastDay);
+        int total_results = -1;
+        for (int page = 1; ; ++page) {
+            politenessDelay();
+            const string where = wd1 + ".." + wd2 + " page " + std::to_string(page);
+            const string body = httpGetWithRetry(client,
+                buildQueryUrl(taxonName, wd1, wd2, swlat, swlng, nelat, nelng, page, options.updatedSince),
+                options.maxRetries, options.pageDelayMs);
+            if (body.empty()) throw runtime_error("Failed to fetch " + where);
+
+            json j;
+            try {
+                j = timedParse(body);
+            } catch (const exception& e) {
+                throw runtime_error("Failed to parse " + where + ": " + e.what());
+            }
+
+            if (total_results < 0 && j.contains("total_results")) {
+                total_results = j["total_results"];
+                if (total_results > options.maxResultsPerWindow && w.lastDay > w.firstDay) {
+                    stats::global().add("window_splits");
+                    return false;
+                }
+            }
+
+            if (!appendResults(j, out)) throw runtime_error("No results array in " + where);
+            stats::global().add("pages");
+            if (isLastPage(j, page, total_results)) break;
+        }
+        return true;
+    };
+
+    auto worker = [&]() {
+        trace::setThreadName("fetch worker");
+        vector<ObsPoint> local;
+        while (true) {
+            DateWindow w;
+            {
+                trace::Span wait("queue_wait", "fetch");
+                unique_lock<mutex> lock(mtx);
+                cv.wait(lock, [&] { return !queue.empty() || pending == 0 || stopping; });
+                if (queue.empty() || stopping) break;
+                w = queue.front();
+                queue.pop_front();
+            }
+
+            bool done = true;
+            const size_t before = local.size();
+            try {
+                trace::Span span("window", "fetch");
+                done = fetchWindow(w, &local);
+                span.setItems(static_cast<int64_t>(local.size() - before));
+            } catch (const exception& e) {
+                local.resize(before);  // a failed window contributes nothing
+                stats::global().add("failed_windows");
+                lock_guard<mutex> lock(mtx);
+                if (failed.empty()) firstError = e.what();
+                failed.push_back(w);
+            }
+
+            {
+                lock_guard<mutex> lock(mtx);
+                if (!done) {
+                    const int mid = w.firstDay + (w.lastDay - w.firstDay) / 2;
+                    queue.push_back(DateWindow{w.firstDay, mid});
+                    queue.push_back(DateWindow{mid + 1, w.lastDay});
+                    pending += 2;
+                }
+                --pending;
+                stopping = !failedWindows && !failed.empty();  // without a failure list the first one ends the fetch
+            }
+            cv.notify_all();
+        }
+        lock_guard<mutex> lock(mtx);
+        merged.insert(merged.end(), local.begin(), local.end());
+    };
+
+    const size_t nThreads = max<size_t>(1, min<size_t>(options.concurrency, initial.size()));
+    vector<thread> threads;
+    for (size_t i = 0; i < nThreads; ++i) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+    if (!failedWindows && !failed.empty()) throw runtime_error(firstError);
+    if (failedWindows) {
+        std::sort(failed.begin(), failed.end(),
+            [](const DateWindow& a, const DateWindow& b) { return a.firstDay < b.firstDay; });
+        *failedWindows = failed;
+    }
+
+    // Deduplicate by observation id (id-less observations are all kept)
+    trace::Span dedup("merge", "fetch");
+    dedup.setItems(static_cast<int64_t>(merged.size()));
+    std::stable_sort(merged.begin(), merged.end(),
+        [](const ObsPoint& a, const ObsPoint& b) { return a.id < b.id; });
+    auto firstWithId = std::find_if(merged.begin(), merged.end(),
+        [](const ObsPoint& p) { return p.id != 0; });
+    merged.erase(
+        std::unique(firstWithId, merged.end(),
+            [](const ObsPoint& a, const ObsPoint& b) { return a.id == b.id; }),
+        merged.end());
+    return merged;
+}
 }  // namespace observations
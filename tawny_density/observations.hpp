@@ -15,6 +15,8 @@
 #define TAWNY_DENSITY_OBSERVATIONS_HPP_
 
 #include <stddef.h>   // for size_t
+#include <climits>    // for INT_MIN
+#include <cstdint>    // for uint64_t
 #include <string>     // for string
 #include <vector>     // for vector
 #include "utils.hpp"  // for HttpResponse, IHttpClient
@@ -32,12 +34,37 @@ const char URL_BASE[] = "https://api.inaturalist.org/v1/observations";
 
 const int PER_PAGE = 200;  // v1: max 200 per page
 
+const int UNKNOWN_DAY = INT_MIN;  // ObsPoint::day when observed_on is missing
+
 // Structure for observation lat/lon
 // as per iNaturalist observation
-struct ObsPoint { double lon{}, lat{}; };
+struct ObsPoint {
+    double lon{}, lat{};
+    uint64_t id{};              // iNaturalist observation id (0 if not supplied)
+    int day = UNKNOWN_DAY;      // observed_on as days since 1970-01-01
+    double accuracy{};          // positional_accuracy radius in metres (0 if not supplied)
+};
+
+// Inclusive range of days (days since 1970-01-01) queried as one d1..d2 shard
+struct DateWindow { int firstDay{}, lastDay{}; };
+
+// Tuning for date-range sharded fetches
+struct ShardOptions {
+    int windowDays = 7;               // initial shard width in days (weekly)
+    int maxResultsPerWindow = 2000;   // shards reporting more results are halved (keeps paging shallow)
+    unsigned concurrency = 4;         // shards fetched at once
+    int pageDelayMs = 1100;           // politeness delay between requests, across all workers
+    int maxRetries = 2;               // retries for a page on 429/5xx/transport errors
+    string updatedSince;              // only observations created/updated since this ISO time (if set)
+};
 
 string urlEncode(const string& url);
 string httpGet(IHttpClient& client, const string& url);
+string utcTimestamp();
+
+int parseIsoDate(const string& ymd);
+string formatIsoDate(int days);
+vector<DateWindow> splitDateRange(const string& d1, const string& d2, int windowDays);
 
 vector<ObsPoint> fetchINatPoints(
     IHttpClient& client,
@@ -45,6 +72,14 @@ vector<ObsPoint> fetchINatPoints(
     const string& d1, const std::string& d2,
     double swlat, double swlng, double nelat, double nelng);
 
+vector<ObsPoint> fetchINatPointsSharded(
+    IHttpClient& client,
+    const string& taxonName,
+    const string& d1, const string& d2,
+    double swlat, double swlng, double nelat, double nelng,
+    const ShardOptions& options = ShardOptions(),
+    vector<DateWindow>* failedWindows = nullptr);
+
 }  // namespace observations
 
 #endif  // TAWNY_DENSITY_OBSERVATIONS_HPP_
@@ -0,0 +1,80 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_PARALLEL_HPP_
+#define TAWNY_DENSITY_PARALLEL_HPP_
+
+#include <algorithm>  // for min, max
+#include <cstddef>    // for size_t
+#include <exception>  // for exception_ptr, current_exception, rethrow_exception
+#include <mutex>      // for mutex, lock_guard
+#include <thread>     // for thread, hardware_concurrency
+#include <vector>     // for vector
+
+namespace parallel {
+
+// Number of worker threads to use when the caller asks for 0 (= all cores)
+//
+// Args:
+//    requested: requested thread count, 0 for hardware concurrency
+// Returns:
+//    at least 1
+inline unsigned resolveThreads(unsigned requested) {
+    if (requested > 0) return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Splits [0, n) into contiguous chunks, one per worker, and runs
+// fn(begin, end, worker) for each chunk. Chunk w covers a fixed range so
+// results depend only on n and the worker count, not on scheduling.
+// The calling thread runs the first chunk. The first exception thrown by any
+// chunk is rethrown once every chunk has finished.
+//
+// Args:
+//    n: number of items
+//    threads: number of workers (0 = hardware concurrency), capped at n
+//    fn: callable taking (size_t begin, size_t end, unsigned worker)
+// Returns:
+//    number of workers used (at least 1)
+template <typename Fn>
+unsigned parallelFor(size_t n, unsigned threads, Fn fn) {
+    const unsigned workers = static_cast<unsigned>(
+        std::max<size_t>(1, std::min<size_t>(resolveThreads(threads), n)));
+    if (workers == 1) {
+        fn(size_t{0}, n, 0u);
+        return 1;
+    }
+
+    std::exception_ptr failure;
+    std::mutex mtx;
+    auto run = [&](unsigned w) {
+        try {
+            fn(n * w / workers, n * (w + 1) / workers, w);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!failure) failure = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) pool.emplace_back(run, w);
+    run(0);
+    for (auto& t : pool) t.join();
+    if (failure) std::rethrow_exception(failure);
+    return workers;
+}
+
+}  // namespace parallel
+
+#endif  // TAWNY_DENSITY_PARALLEL_HPP_
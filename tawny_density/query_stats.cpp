@@ -0,0 +1,171 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query_stats.hpp"
+#include <algorithm>   // for min, partial_sort
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t, uint64_t
+#include <mutex>       // for mutex, lock_guard
+#include <numeric>     // for iota
+#include <string>      // for string
+#include <vector>      // for vector
+#include "stats.hpp"   // for Histogram, Registry
+#include "suburb.hpp"  // for Suburb, NO_SUBURB
+
+using std::string;
+using std::vector;
+using std::lock_guard;
+using std::mutex;
+
+namespace suburb {
+
+namespace {
+
+// Counts of threads that have exited (or been reset into)
+struct Totals {
+    mutex mtx;
+    QueryStats stats;
+};
+
+Totals& totals() {
+    static Totals t;
+    return t;
+}
+
+void addCounters(const QueryCounters& from, QueryCounters* to) {
+    to->queries += from.queries;
+    to->hits += from.hits;
+    to->misses += from.misses;
+    to->suburbBboxTests += from.suburbBboxTests;
+    to->polygonBboxRejects += from.polygonBboxRejects;
+    to->ringsTested += from.ringsTested;
+    to->holeTests += from.holeTests;
+    to->edgesVisited += from.edgesVisited;
+}
+
+// Adds one thread's counts to stats
+void merge(const detail::ThreadQueryStats& t, QueryStats* stats) {
+    addCounters(t.counters, &stats->counters);
+    stats->edgesPerQuery.merge(t.edgesPerQuery);
+    stats->candidatesPerQuery.merge(t.candidatesPerQuery);
+    if (t.suburbEdges.size() > stats->suburbEdges.size()) stats->suburbEdges.resize(t.suburbEdges.size());
+    for (size_t id = 0; id < t.suburbEdges.size(); ++id) stats->suburbEdges[id] += t.suburbEdges[id];
+}
+
+}  // namespace
+
+// True if the library was built with TAWNY_QUERY_STATS
+bool queryStatsEnabled() {
+#ifdef TAWNY_QUERY_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Query counts of every thread that has exited plus the calling thread.
+// Worker threads of parallelFor have exited by the time it returns.
+QueryStats collectQueryStats() {
+    lock_guard<mutex> lock(totals().mtx);
+    QueryStats out = totals().stats;
+    merge(detail::threadQueryStats(), &out);
+    return out;
+}
+
+// Clears the totals and the calling thread's counts
+void resetQueryStats() {
+    {
+        lock_guard<mutex> lock(totals().mtx);
+        totals().stats = QueryStats{};
+    }
+    detail::ThreadQueryStats& t = detail::threadQueryStats();
+    t.counters = QueryCounters{};
+    t.edgesPerQuery = stats::Histogram{};
+    t.candidatesPerQuery = stats::Histogram{};
+    t.suburbEdges.clear();
+}
+
+// Adds the query counts to a stats registry: query_* counters, the
+// query_edges and query_candidates per-query histograms, and one
+// "query_edges[name]" counter for each of the suburbs that cost the most edges.
+// Does nothing unless built with TAWNY_QUERY_STATS.
+//
+// Args:
+//    suburbs: the indexed suburbs, for names
+//    registry: where to record
+//    topSuburbs: how many of the costliest suburbs to list
+void reportQueryStats(const vector<Suburb>& suburbs, stats::Registry* registry, size_t topSuburbs) {
+    if (!queryStatsEnabled()) return;
+    const QueryStats q = collectQueryStats();
+    const QueryCounters& c = q.counters;
+    registry->add("query_locates", c.queries);
+    registry->add("query_hits", c.hits);
+    registry->add("query_misses", c.misses);
+    registry->add("query_suburb_bbox_tests", c.suburbBboxTests);
+    registry->add("query_polygon_bbox_rejects", c.polygonBboxRejects);
+    registry->add("query_rings_tested", c.ringsTested);
+    registry->add("query_hole_tests", c.holeTests);
+    registry->add("query_edges_visited", c.edgesVisited);
+    registry->mergeHistogram("query_edges", q.edgesPerQuery);
+    registry->mergeHistogram("query_candidates", q.candidatesPerQuery);
+
+    vector<uint32_t> ids(std::min(q.suburbEdges.size(), suburbs.size()));
+    std::iota(ids.begin(), ids.end(), 0u);
+    const size_t top = std::min(topSuburbs, ids.size());
+    std::partial_sort(ids.begin(), ids.begin() + top, ids.end(), [&](uint32_t a, uint32_t b) {
+        return q.suburbEdges[a] != q.suburbEdges[b] ? q.suburbEdges[a] > q.suburbEdges[b] : a < b;
+    });
+    for (size_t i = 0; i < top && q.suburbEdges[ids[i]] > 0; ++i)
+        registry->add("query_edges[" + suburbs[ids[i]].name + "]", q.suburbEdges[ids[i]]);
+}
+
+namespace detail {
+
+ThreadQueryStats::~ThreadQueryStats() {
+    lock_guard<mutex> lock(totals().mtx);
+    merge(*this, &totals().stats);
+}
+
+ThreadQueryStats& threadQueryStats() {
+    thread_local ThreadQueryStats t;
+    return t;
+}
+
+// Counts edges visited, against the suburb being tested if there is one
+void countEdges(uint64_t edges) {
+    ThreadQueryStats& t = threadQueryStats();
+    t.counters.edgesVisited += edges;
+    if (t.candidate == NO_SUBURB) return;
+    if (t.candidate >= t.suburbEdges.size()) t.suburbEdges.resize(t.candidate + 1);
+    t.suburbEdges[t.candidate] += edges;
+}
+
+// Counts so far, to diff against at the end of the query
+QueryCounters beginQuery() {
+    return threadQueryStats().counters;
+}
+
+// Records one locate: hit or miss, and its edges and candidates per query
+void endQuery(const QueryCounters& before, uint32_t id) {
+    ThreadQueryStats& t = threadQueryStats();
+    ++t.counters.queries;
+    ++(id == NO_SUBURB ? t.counters.misses : t.counters.hits);
+    t.edgesPerQuery.add(static_cast<double>(t.counters.edgesVisited - before.edgesVisited));
+    t.candidatesPerQuery.add(static_cast<double>(t.counters.suburbBboxTests - before.suburbBboxTests));
+    t.candidate = NO_SUBURB;
+}
+
+}  // namespace detail
+
+}  // namespace suburb
@@ -0,0 +1,94 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_QUERY_STATS_HPP_
+#define TAWNY_DENSITY_QUERY_STATS_HPP_
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t, uint64_t
+#include <vector>      // for vector
+#include "stats.hpp"   // for Histogram, Registry
+#include "suburb.hpp"  // for Suburb, NO_SUBURB
+
+using std::vector;
+
+namespace suburb {
+
+// Point-in-polygon work done by suburb lookups. Only counted when the library
+// is built with TAWNY_QUERY_STATS (cmake -DENABLE_QUERY_STATS=ON); otherwise
+// the counting macros compile to nothing and every count stays 0.
+struct QueryCounters {
+    uint64_t queries = 0;             // SuburbIndex::locate calls
+    uint64_t hits = 0;                // ... that found a suburb
+    uint64_t misses = 0;              // ... that found none
+    uint64_t suburbBboxTests = 0;     // pointInSuburb calls (candidates tested)
+    uint64_t polygonBboxRejects = 0;  // polygons skipped by their bbox
+    uint64_t ringsTested = 0;         // pointInRing calls, outer rings and holes
+    uint64_t holeTests = 0;           // of which hole rings
+    uint64_t edgesVisited = 0;        // ring edges tested
+};
+
+// Everything counted, summed over threads
+struct QueryStats {
+    QueryCounters counters;
+    stats::Histogram edgesPerQuery;
+    stats::Histogram candidatesPerQuery;
+    vector<uint64_t> suburbEdges;  // edges visited while testing each suburb id
+};
+
+bool queryStatsEnabled();
+QueryStats collectQueryStats();
+void resetQueryStats();
+void reportQueryStats(const vector<Suburb>& suburbs, stats::Registry* registry, size_t topSuburbs = 10);
+
+namespace detail {
+
+// One thread's counts; merged into the process totals when the thread exits
+struct ThreadQueryStats {
+    ThreadQueryStats() = default;
+    ThreadQueryStats(const ThreadQueryStats&) = delete;
+    ThreadQueryStats& operator=(const ThreadQueryStats&) = delete;
+    ~ThreadQueryStats();
+
+    QueryCounters counters;
+    stats::Histogram edgesPerQuery;
+    stats::Histogram candidatesPerQuery;
+    vector<uint64_t> suburbEdges;
+    uint32_t candidate = NO_SUBURB;  // suburb being tested, for suburbEdges
+};
+
+ThreadQueryStats& threadQueryStats();
+void countEdges(uint64_t edges);
+QueryCounters beginQuery();
+void endQuery(const QueryCounters& before, uint32_t id);
+
+}  // namespace detail
+
+}  // namespace suburb
+
+#ifdef TAWNY_QUERY_STATS
+#define TAWNY_QUERY_COUNT(field, n) (::suburb::detail::threadQueryStats().counters.field += (n))
+#define TAWNY_QUERY_EDGES(n) ::suburb::detail::countEdges(n)
+#define TAWNY_QUERY_CANDIDATE(id) (::suburb::detail::threadQueryStats().candidate = (id))
+#define TAWNY_QUERY_BEGIN() const ::suburb::QueryCounters tawnyQueryBefore = ::suburb::detail::beginQuery()
+#define TAWNY_QUERY_END(id) ::suburb::detail::endQuery(tawnyQueryBefore, (id))
+#else
+#define TAWNY_QUERY_COUNT(field, n) ((void)0)
+#define TAWNY_QUERY_EDGES(n) ((void)0)
+#define TAWNY_QUERY_CANDIDATE(id) ((void)0)
+#define TAWNY_QUERY_BEGIN() ((void)0)
+#define TAWNY_QUERY_END(id) ((void)0)
+#endif
+
+#endif  // TAWNY_DENSITY_QUERY_STATS_HPP_
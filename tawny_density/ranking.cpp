@@ -0,0 +1,138 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ranking.hpp"
+#include <algorithm>     // for nth_element, sort, stable_sort
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint32_t, uint64_t
+#include <numeric>       // for iota
+#include <vector>        // for vector
+#include "parallel.hpp"  // for parallelFor
+#include "suburb.hpp"    // for Suburb
+
+using std::vector;
+using std::nth_element;
+using std::sort;
+
+using parallel::parallelFor;
+
+namespace ranking {
+
+// Ranking order: higher count first, ties broken by lower suburb id
+// (i.e. GeoJSON feature order) so results never depend on hash or thread order
+//
+// Args:
+//    a: first ranked suburb
+//    b: second ranked suburb
+// Returns:
+//    true if a ranks ahead of b
+bool rankedBefore(const RankedSuburb& a, const RankedSuburb& b) {
+    if (a.count != b.count) return a.count > b.count;
+    return a.id < b.id;
+}
+
+namespace {
+
+// Keeps the best k candidates in rank order
+//
+// Args:
+//    candidates: candidates to select from, reduced in place to at most k
+//    k: number of candidates to keep
+void selectBest(vector<RankedSuburb>* candidates, size_t k) {
+    if (candidates->size() > k) {
+        nth_element(candidates->begin(), candidates->begin() + k, candidates->end(), rankedBefore);
+        candidates->resize(k);
+    }
+    sort(candidates->begin(), candidates->end(), rankedBefore);
+}
+
+}  // namespace
+
+// Selects the top k suburbs with non-zero counts from counts[begin, end)
+//
+// Args:
+//    counts: dense per-suburb counts indexed by suburb id
+//    k: number of suburbs to return
+//    begin: first suburb id to consider
+//    end: one past the last suburb id to consider
+// Returns:
+//    up to k suburbs in rank order
+vector<RankedSuburb> topK(const vector<uint64_t>& counts, size_t k, size_t begin, size_t end) {
+    vector<RankedSuburb> candidates;
+    if (k == 0) return candidates;
+    for (size_t id = begin; id < end; ++id) {
+        if (counts[id] == 0) continue;
+        candidates.push_back(RankedSuburb{static_cast<uint32_t>(id), counts[id]});
+    }
+    selectBest(&candidates, k);
+    return candidates;
+}
+
+// Selects the top k suburbs with non-zero counts, splitting the count array
+// into one contiguous id range per thread and merging the per-thread top k lists
+//
+// Args:
+//    counts: dense per-suburb counts indexed by suburb id
+//    k: number of suburbs to return
+//    threads: number of threads to use (0 = hardware concurrency)
+// Returns:
+//    up to k suburbs in rank order
+vector<RankedSuburb> topK(const vector<uint64_t>& counts, size_t k, unsigned threads) {
+    vector<vector<RankedSuburb>> partials(parallel::resolveThreads(threads));
+    const unsigned used = parallelFor(counts.size(), threads, [&](size_t begin, size_t end, unsigned worker) {
+        partials[worker] = topK(counts, k, begin, end);
+    });
+    partials.resize(used);
+    return mergeTopK(partials, k);
+}
+
+// Merges per-thread top k lists (each over disjoint suburb ids) into a global top k.
+// Cost is O(k) per partial list.
+//
+// Args:
+//    partials: top k lists to merge
+//    k: number of suburbs to return
+// Returns:
+//    up to k suburbs in rank order
+vector<RankedSuburb> mergeTopK(const vector<vector<RankedSuburb>>& partials, size_t k) {
+    vector<RankedSuburb> candidates;
+    for (const auto& partial : partials) candidates.insert(candidates.end(), partial.begin(), partial.end());
+    selectBest(&candidates, k);
+    return candidates;
+}
+
+// Orders all suburb ids for report output
+//
+// Args:
+//    suburbs: the loaded suburbs (for names)
+//    counts: dense per-suburb counts indexed by suburb id
+//    order: the requested order
+// Returns:
+//    every suburb id, in the requested order
+vector<uint32_t> orderSuburbs(const vector<Suburb>& suburbs, const vector<uint64_t>& counts, SortOrder order) {
+    vector<uint32_t> ids(suburbs.size());
+    std::iota(ids.begin(), ids.end(), 0u);
+    if (order == SortOrder::Count) {
+        sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+            return rankedBefore(RankedSuburb{a, counts[a]}, RankedSuburb{b, counts[b]});
+        });
+    } else if (order == SortOrder::Name) {
+        std::stable_sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) {
+            return suburbs[a].name < suburbs[b].name;
+        });
+    }
+    return ids;
+}
+
+}  // namespace ranking
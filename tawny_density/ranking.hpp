@@ -0,0 +1,48 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_RANKING_HPP_
+#define TAWNY_DENSITY_RANKING_HPP_
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t, uint64_t
+#include <vector>      // for vector
+#include "suburb.hpp"  // for Suburb
+
+using std::vector;
+using suburb::Suburb;
+
+namespace ranking {
+
+// suburb id (index into the loaded suburbs) with its sighting count
+struct RankedSuburb {
+    uint32_t id{};
+    uint64_t count{};
+};
+
+// output order for per-suburb reports
+enum class SortOrder {
+    Id,     // GeoJSON feature order
+    Count,  // most sightings first, ties by id
+    Name    // by suburb name, ties by id
+};
+
+bool rankedBefore(const RankedSuburb& a, const RankedSuburb& b);
+vector<RankedSuburb> topK(const vector<uint64_t>& counts, size_t k, size_t begin, size_t end);
+vector<RankedSuburb> topK(const vector<uint64_t>& counts, size_t k, unsigned threads = 1);
+vector<RankedSuburb> mergeTopK(const vector<vector<RankedSuburb>>& partials, size_t k);
+vector<uint32_t> orderSuburbs(const vector<Suburb>& suburbs, const vector<uint64_t>& counts, SortOrder order);
+
+}  // namespace ranking
+
+#endif  // TAWNY_DENSITY_RANKING_HPP_
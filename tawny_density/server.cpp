@@ -0,0 +1,465 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "server.hpp"
+#include <fcntl.h>           // for O_CLOEXEC, O_NONBLOCK
+#include <poll.h>            // for poll, pollfd, POLLIN, POLLOUT
+#include <sys/socket.h>      // for socket, bind, listen, accept4, connect, send, recv
+#include <sys/stat.h>        // for stat, S_ISSOCK
+#include <sys/un.h>          // for sockaddr_un
+#include <unistd.h>          // for close, unlink, pipe2, read, write
+#include <cerrno>            // for errno, EINTR, EAGAIN, EWOULDBLOCK
+#include <charconv>          // for from_chars, to_chars
+#include <chrono>            // for milliseconds, steady_clock
+#include <cmath>             // for isfinite
+#include <cstring>           // for strerror, memcpy
+#include <memory>            // for make_unique
+#include <mutex>             // for lock_guard, unique_lock
+#include <stdexcept>         // for runtime_error
+#include <string>            // for string
+#include <string_view>       // for string_view
+#include <thread>            // for thread
+#include <vector>            // for vector
+#include "parallel.hpp"      // for resolveThreads
+#include "suburb.hpp"        // for Point, NO_SUBURB
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::runtime_error;
+using std::thread;
+using std::lock_guard;
+using std::unique_lock;
+using std::mutex;
+using std::from_chars;
+using std::to_chars;
+
+using suburb::NO_SUBURB;
+
+namespace server {
+
+namespace {
+
+// Error text for the current errno
+string lastError(const string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+// Fills a Unix socket address, rejecting paths that do not fit
+sockaddr_un socketAddress(const string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) throw runtime_error("Invalid socket path: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+// Writes as much of pending as a non-blocking socket takes, removing what was sent
+//
+// Args:
+//    fd: a non-blocking socket
+//    pending: bytes to send; the unsent remainder is left in it
+//    progressed: set to true if any bytes were sent
+// Returns:
+//    false if the peer has gone
+bool sendSome(int fd, string* pending, bool* progressed) {
+    size_t sent = 0;
+    while (sent < pending->size()) {
+        const ssize_t n = ::send(fd, pending->data() + sent, pending->size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    pending->erase(0, sent);
+    if (sent > 0) *progressed = true;
+    return true;
+}
+
+// Queues a connection's finished answers and sends what the socket takes
+//
+// Returns:
+//    false if the peer has gone
+bool queueOutput(string* out, string* unsent, int fd) {
+    unsent->append(*out);
+    out->clear();
+    bool progressed = false;
+    return sendSome(fd, unsent, &progressed);
+}
+
+// Skips leading spaces and tabs
+string_view trimLeft(string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    return s;
+}
+
+}  // namespace
+
+// Parses a "lon lat" or "lon,lat" line
+//
+// Args:
+//    line: the request line, without its newline
+//    out: set to the point
+// Returns:
+//    false if the line is not two finite coordinates in range
+bool parsePoint(string_view line, Point* out) {
+    line = trimLeft(line);
+    while (!line.empty() && (line.back() == ' ' || line.back() == '\t')) line.remove_suffix(1);
+    const char* const end = line.data() + line.size();
+
+    double lon, lat;
+    auto r = from_chars(line.data(), end, lon);
+    if (r.ec != std::errc()) return false;
+    const char* p = r.ptr;
+    const char* const sep = p;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == ',')) ++p;
+    if (p == sep) return false;
+    r = from_chars(p, end, lat);
+    if (r.ec != std::errc() || r.ptr != end) return false;
+    if (!std::isfinite(lon) || !std::isfinite(lat) || lon < -180 || lon > 180 || lat < -90 || lat > 90) return false;
+    *out = Point{lon, lat};
+    return true;
+}
+
+// Appends the response line for one request line
+//
+// Args:
+//    index: the suburb index
+//    line: the request line, without its newline
+//    out: the response is appended here
+void answerLine(const SuburbIndex& index, string_view line, string* out) {
+    Point point;
+    if (!parsePoint(line, &point)) {
+        out->append("ERR malformed point\n");
+        return;
+    }
+    const uint32_t id = index.locate(point);
+    if (id == NO_SUBURB) {
+        out->append("-\t\n");
+        return;
+    }
+    char digits[16];
+    out->append(digits, static_cast<size_t>(to_chars(digits, digits + sizeof(digits), id).ptr - digits));
+    out->push_back('\t');
+    out->append(index.suburbs()[id].name);
+    out->push_back('\n');
+}
+
+// Binds and listens on socketPath, replacing a stale socket file left by an earlier run
+//
+// Args:
+//    index: the suburb index to answer from; must outlive the server
+//    socketPath: filesystem path of the Unix-domain socket
+//    threads: number of batches answered at once (0 = hardware concurrency)
+//    idleTimeoutMs: connections sending nothing for this long are closed
+LookupServer::LookupServer(const SuburbIndex& index, const string& socketPath, unsigned threads, int idleTimeoutMs)
+    : index_(index), socketPath_(socketPath), threads_(parallel::resolveThreads(threads)),
+      idleTimeoutMs_(idleTimeoutMs) {
+    const sockaddr_un addr = socketAddress(socketPath);
+    struct stat st;
+    if (::stat(socketPath.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) throw runtime_error("Refusing to replace non-socket file: " + socketPath);
+        // only a socket nobody accepts on is stale
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe < 0) throw runtime_error(lastError("socket"));
+        const bool live = ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        ::close(probe);
+        if (live) throw runtime_error("Socket is in use by a running server: " + socketPath);
+        ::unlink(socketPath.c_str());
+    }
+
+    if (::pipe2(wakeFds_, O_CLOEXEC | O_NONBLOCK) != 0) throw runtime_error(lastError("pipe"));
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0 || ::bind(listenFd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd_, SOMAXCONN) != 0) {
+        const string error = lastError("Failed to listen on " + socketPath);
+        if (listenFd_ >= 0) ::close(listenFd_);
+        ::close(wakeFds_[0]);
+        ::close(wakeFds_[1]);
+        throw runtime_error(error);
+    }
+}
+
+// Closes the listening socket and removes the socket file
+LookupServer::~LookupServer() {
+    ::close(listenFd_);
+    ::unlink(socketPath_.c_str());
+    ::close(wakeFds_[0]);
+    ::close(wakeFds_[1]);
+}
+
+// Ends the poll loop's current wait
+void LookupServer::wake() {
+    const char byte = 0;
+    // a full pipe already guarantees a wake-up
+    [[maybe_unused]] const ssize_t n = ::write(wakeFds_[1], &byte, 1);
+}
+
+// Polls the listening socket and every idle connection until stop() is called.
+// Complete request lines are handed to the worker pool; a connection goes back
+// to the poll set once its lines are answered, so a worker is never tied to
+// a client between batches.
+void LookupServer::run() {
+    auto worker = [&]() {
+        while (true) {
+            Connection* conn;
+            {
+                unique_lock<mutex> lock(mtx_);
+                // stop() may come from a signal handler, which cannot notify, so wake up periodically
+                while (ready_.empty() && !stopping_) {
+                    cv_.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS));
+                }
+                if (stopping_) break;
+                conn = ready_.front();
+                ready_.pop_front();
+            }
+            answerPending(conn);
+            {
+                lock_guard<mutex> lock(mtx_);
+                returned_.push_back(conn);
+            }
+            wake();
+        }
+    };
+    vector<thread> workers;
+    for (unsigned i = 0; i < threads_; ++i) workers.emplace_back(worker);
+
+    vector<pollfd> fds;
+    vector<Connection*> polled;
+    char buf[1 << 16];
+    while (!stopping_) {
+        {
+            lock_guard<mutex> lock(mtx_);
+            for (Connection* conn : returned_) conn->busy = false;
+            returned_.clear();
+        }
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        for (size_t i = 0; i < connections_.size();) {
+            const Connection& conn = *connections_[i];
+            // a client not reading its answers makes no progress either, so it times out too
+            if (!conn.busy && (conn.closing || (conn.draining && conn.unsent.empty()) ||
+                               now - conn.lastActiveMs > idleTimeoutMs_)) {
+                ::close(conn.fd);
+                connections_[i] = std::move(connections_.back());
+                connections_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        fds.assign({pollfd{listenFd_, POLLIN, 0}, pollfd{wakeFds_[0], POLLIN, 0}});
+        polled.clear();
+        for (const auto& conn : connections_) {
+            if (conn->busy) continue;
+            // while answers are waiting, stop reading so the client cannot queue more work
+            const short events = conn->unsent.empty() ? POLLIN : POLLOUT;
+            fds.push_back(pollfd{conn->fd, events, 0});
+            polled.push_back(conn.get());
+        }
+        if (::poll(fds.data(), fds.size(), POLL_INTERVAL_MS) <= 0) continue;
+
+        if (fds[1].revents) {
+            while (::read(wakeFds_[0], buf, sizeof(buf)) > 0) {}
+        }
+        for (size_t i = 0; i < polled.size(); ++i) {
+            if (!fds[i + 2].revents) continue;
+            Connection* conn = polled[i];
+            if (!conn->unsent.empty()) {
+                bool progressed = false;
+                if (!sendSome(conn->fd, &conn->unsent, &progressed)) {
+                    conn->closing = true;
+                    continue;
+                }
+                if (progressed) conn->lastActiveMs = now;
+                // answer the lines left waiting behind the flushed output
+                if (conn->unsent.empty() && !conn->draining && conn->in.find('\n') != string::npos) dispatch(conn);
+                continue;
+            }
+            const ssize_t n = ::recv(conn->fd, buf, sizeof(buf), 0);
+            if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+            if (n < 0) {
+                conn->closing = true;
+                continue;
+            }
+            if (n == 0) {
+                // answer an unterminated last batch before closing
+                if (!queueOutput(&conn->out, &conn->unsent, conn->fd)) conn->closing = true;
+                conn->draining = true;
+                continue;
+            }
+            conn->lastActiveMs = now;
+            const size_t searchFrom = conn->in.size();
+            conn->in.append(buf, static_cast<size_t>(n));
+            if (conn->in.find('\n', searchFrom) != string::npos) {
+                dispatch(conn);
+            } else if (conn->in.size() > MAX_LINE_BYTES) {
+                conn->closing = true;
+            }
+        }
+        if (fds[0].revents) {
+            const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd >= 0) {
+                connections_.push_back(std::make_unique<Connection>());
+                connections_.back()->fd = fd;
+                connections_.back()->lastActiveMs = now;
+            }
+        }
+    }
+
+    cv_.notify_all();
+    for (auto& t : workers) t.join();
+    for (const auto& conn : connections_) ::close(conn->fd);
+    connections_.clear();
+    ready_.clear();
+    returned_.clear();
+}
+
+// Hands a connection with complete request lines to the worker pool
+//
+// Args:
+//    conn: an idle connection owned by the poll loop
+void LookupServer::dispatch(Connection* conn) {
+    conn->busy = true;
+    {
+        lock_guard<mutex> lock(mtx_);
+        ready_.push_back(conn);
+    }
+    cv_.notify_one();
+}
+
+// Answers every complete line received on a connection, sending each finished
+// batch (and large partial ones in chunks); stops early, leaving the rest of
+// the lines, when the client is not reading, and sets closing when the client
+// has gone or sent an over-long line
+//
+// Args:
+//    conn: a connection owned by the calling worker
+void LookupServer::answerPending(Connection* conn) {
+    string& in = conn->in;
+    string& out = conn->out;
+    size_t start = 0, newline;
+    while ((newline = in.find('\n', start)) != string::npos) {
+        string_view line(in.data() + start, newline - start);
+        start = newline + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) {
+            // end of batch
+            out.push_back('\n');
+        } else {
+            answerLine(index_, line, &out);
+            if (out.size() < RESPONSE_FLUSH_BYTES) continue;
+        }
+        if (!queueOutput(&out, &conn->unsent, conn->fd)) {
+            conn->closing = true;
+            return;
+        }
+        // the poll loop flushes the rest and hands the connection back
+        if (!conn->unsent.empty()) break;
+    }
+    in.erase(0, start);
+    if (in.size() > MAX_LINE_BYTES && in.find('\n') == string::npos) conn->closing = true;
+}
+
+// Connects to a LookupServer
+//
+// Args:
+//    socketPath: the server's socket path
+LookupClient::LookupClient(const string& socketPath) {
+    const sockaddr_un addr = socketAddress(socketPath);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) throw runtime_error(lastError("socket"));
+    if (::connect(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const string error = lastError("Failed to connect to " + socketPath);
+        ::close(fd_);
+        throw runtime_error(error);
+    }
+}
+
+// Closes the connection
+LookupClient::~LookupClient() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+// Looks up one batch of points
+//
+// Args:
+//    points: the points to locate
+// Returns:
+//    suburb id for each point, NO_SUBURB where it is in no suburb
+vector<uint32_t> LookupClient::lookup(const vector<Point>& points) {
+    string request;
+    request.reserve(points.size() * 40 + 1);
+    char number[32];
+    for (const auto& p : points) {
+        request.append(number, static_cast<size_t>(to_chars(number, number + sizeof(number), p.lon).ptr - number));
+        request.push_back(' ');
+        request.append(number, static_cast<size_t>(to_chars(number, number + sizeof(number), p.lat).ptr - number));
+        request.push_back('\n');
+    }
+    request.push_back('\n');
+
+    // the server stops reading while its answers go unread, so answers are
+    // read as they arrive, interleaved with writing the request
+    vector<uint32_t> ids;
+    ids.reserve(points.size());
+    size_t sent = 0;
+    char buf[1 << 16];
+    while (true) {
+        size_t start = 0;
+        size_t newline;
+        while ((newline = pending_.find('\n', start)) != string::npos) {
+            const string_view line(pending_.data() + start, newline - start);
+            start = newline + 1;
+            if (line.empty()) {
+                pending_.erase(0, start);
+                if (ids.size() != points.size() || sent < request.size())
+                    throw runtime_error("Lookup server answered the wrong number of points");
+                return ids;
+            }
+            uint32_t id = NO_SUBURB;
+            if (line.front() != '-') {
+                auto r = from_chars(line.data(), line.data() + line.size(), id);
+                if (r.ec != std::errc()) throw runtime_error("Lookup server error: " + string(line));
+            }
+            ids.push_back(id);
+        }
+        pending_.erase(0, start);
+
+        pollfd pfd{fd_, static_cast<short>(sent < request.size() ? POLLIN | POLLOUT : POLLIN), 0};
+        if (::poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            throw runtime_error(lastError("Failed to wait for the lookup server"));
+        }
+        if (sent < request.size() && (pfd.revents & POLLOUT)) {
+            const ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n >= 0) {
+                sent += static_cast<size_t>(n);
+            } else if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+                throw runtime_error(lastError("Failed to send lookup batch"));
+            }
+        }
+        if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+            const ssize_t n = ::recv(fd_, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+            if (n <= 0) throw runtime_error("Lookup server closed the connection");
+            pending_.append(buf, static_cast<size_t>(n));
+        }
+    }
+}
+
+}  // namespace server
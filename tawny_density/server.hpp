@@ -0,0 +1,117 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_SERVER_HPP_
+#define TAWNY_DENSITY_SERVER_HPP_
+
+#include <atomic>              // for atomic
+#include <condition_variable>  // for condition_variable
+#include <cstdint>             // for uint32_t, int64_t
+#include <deque>               // for deque
+#include <memory>              // for unique_ptr
+#include <mutex>               // for mutex
+#include <string>              // for string
+#include <string_view>         // for string_view
+#include <vector>              // for vector
+#include "suburb.hpp"          // for Point
+#include "suburb_index.hpp"    // for SuburbIndex
+
+using std::string;
+using std::string_view;
+using std::vector;
+using suburb::Point;
+using suburb::SuburbIndex;
+
+namespace server {
+
+// Line protocol, over a Unix-domain stream socket:
+//   request:  one "lon lat" (or "lon,lat") line per point, then an empty line ending the batch
+//   response: one "id<TAB>name" line per point ("-" + TAB when in no suburb,
+//             "ERR <reason>" for a malformed line), then an empty line
+// A connection may send any number of batches.
+const int POLL_INTERVAL_MS = 100;             // how often idle loops check for stop()
+const int IDLE_TIMEOUT_MS = 60000;            // connections making no progress for longer are closed
+const size_t MAX_LINE_BYTES = 4096;           // longer request lines close the connection
+const size_t RESPONSE_FLUSH_BYTES = 1 << 16;  // large batches are answered in chunks of about this size
+
+bool parsePoint(string_view line, Point* out);
+void answerLine(const SuburbIndex& index, string_view line, string* out);
+
+// Resident point-to-suburb lookup service. The socket is bound and listening
+// once constructed; run() polls every connection from one thread and hands
+// received lines to a pool of worker threads, until stop() is called
+// (stop() is async-signal-safe).
+class LookupServer {
+ public:
+    LookupServer(const SuburbIndex& index, const string& socketPath, unsigned threads = 0,
+                 int idleTimeoutMs = IDLE_TIMEOUT_MS);
+    ~LookupServer();
+    LookupServer(const LookupServer&) = delete;
+    LookupServer& operator=(const LookupServer&) = delete;
+
+    const string& socketPath() const { return socketPath_; }
+    void run();
+    void stop() { stopping_ = true; }
+
+ private:
+    // One client connection. While busy it belongs to a worker; otherwise to the poll loop.
+    // The socket is non-blocking: answers the client is not reading wait in unsent,
+    // and the connection is neither read nor answered until they are flushed.
+    struct Connection {
+        int fd = -1;
+        string in;                  // received bytes not yet answered
+        string out;                 // answers of the current, unfinished batch
+        string unsent;              // finished answers the socket has not taken yet
+        int64_t lastActiveMs = 0;   // when bytes last arrived or were sent
+        bool busy = false;
+        bool closing = false;       // set when the connection must be dropped
+        bool draining = false;      // the client has finished sending; close once unsent is flushed
+    };
+
+    void answerPending(Connection* conn);
+    void dispatch(Connection* conn);
+    void wake();
+
+    const SuburbIndex& index_;
+    string socketPath_;
+    unsigned threads_;
+    int idleTimeoutMs_;
+    int listenFd_ = -1;
+    int wakeFds_[2] = {-1, -1};  // workers write a byte to end the poll loop's wait
+    std::atomic<bool> stopping_{false};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Connection*> ready_;     // connections with complete lines to answer
+    std::deque<Connection*> returned_;  // connections workers have finished with
+    vector<std::unique_ptr<Connection>> connections_;
+};
+
+// Client for LookupServer keeping one connection open across batches
+class LookupClient {
+ public:
+    explicit LookupClient(const string& socketPath);
+    ~LookupClient();
+    LookupClient(const LookupClient&) = delete;
+    LookupClient& operator=(const LookupClient&) = delete;
+
+    vector<uint32_t> lookup(const vector<Point>& points);
+
+ private:
+    int fd_ = -1;
+    string pending_;  // bytes received past the last complete response
+};
+
+}  // namespace server
+
+#endif  // TAWNY_DENSITY_SERVER_HPP_
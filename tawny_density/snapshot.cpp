@@ -0,0 +1,351 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot.hpp"
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t, int32_t
+#include <cstdio>            // for rename
+#include <cstring>           // for memcmp
+#include <fstream>           // for ifstream, ofstream
+#include <stdexcept>         // for runtime_error
+#include <string>            // for string
+#include <unordered_set>     // for unordered_set
+#include <utility>           // for move
+#include <vector>            // for vector
+#include "counts.hpp"        // for CountMatrix
+#include "observations.hpp"  // for ObsPoint
+#include "parallel.hpp"      // for parallelFor
+#include "suburb.hpp"        // for Point, Suburb, NO_SUBURB
+#include "suburb_index.hpp"  // for SuburbIndex
+#include "trapezoid_map.hpp"  // for geometryFingerprint
+
+using std::string;
+using std::vector;
+using std::runtime_error;
+using std::ifstream;
+using std::ofstream;
+using std::unordered_set;
+
+using parallel::parallelFor;
+using suburb::Point;
+
+namespace snapshot {
+
+namespace {
+
+// FNV-1a over raw bytes
+void fnv(uint64_t* h, const void* data, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        *h ^= p[i];
+        *h *= 1099511628211ULL;
+    }
+}
+
+// Suburb a point is counted in: the one holding it, else the nearest within
+// nearestMetres (0 = off), else NO_SUBURB
+uint32_t locateWithFallback(const SuburbIndex& index, const Point& point, double nearestMetres) {
+    const uint32_t id = index.locate(point);
+    if (id != NO_SUBURB || !(nearestMetres > 0)) return id;
+    return index.nearest(point, nearestMetres);
+}
+
+template <typename T>
+void writeValue(ofstream* out, const T& value) {
+    out->write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readValue(ifstream* in) {
+    T value{};
+    in->read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (!*in) throw runtime_error("Truncated snapshot");
+    return value;
+}
+
+}  // namespace
+
+// Identifies a suburb layer by names and every ring vertex, so a snapshot is
+// never applied to suburbs it was not built from, even when a boundary moves
+// without changing any bounding box
+//
+// Args:
+//    suburbs: the loaded suburbs
+// Returns:
+//    64-bit fingerprint
+uint64_t suburbsFingerprint(const vector<Suburb>& suburbs) {
+    uint64_t h = 14695981039346656037ULL;
+    for (const auto& s : suburbs) fnv(&h, s.name.data(), s.name.size() + 1);
+    const uint64_t geometry = suburb::geometryFingerprint(suburbs);
+    fnv(&h, &geometry, sizeof(geometry));
+    return h;
+}
+
+// Creates an empty snapshot for the given suburbs and bucket layout
+//
+// Args:
+//    suburbs: the loaded suburbs
+//    firstDay: first day of the first bucket (days since 1970-01-01)
+//    lastDay: last day to count
+//    bucketDays: bucket width in days
+Snapshot::Snapshot(const vector<Suburb>& suburbs, int firstDay, int lastDay, int bucketDays)
+    : fingerprint_(suburbsFingerprint(suburbs)),
+      matrix_(suburbs.size(), firstDay, lastDay, bucketDays) {}
+
+// Removes a contribution from the counts
+void Snapshot::uncount(const Contribution& c) {
+    if (c.suburb == NO_SUBURB) return;
+    matrix_.remove(c.suburb, c.day);
+    --assigned_;
+}
+
+// Locates every tracked observation again under a new nearest-suburb distance
+//
+// Args:
+//    index: the suburb index (must match the snapshot)
+//    threads: number of threads to locate with
+//    nearestMetres: the new nearest-suburb fallback distance
+// Returns:
+//    number of observations located
+size_t Snapshot::relocate(const SuburbIndex& index, unsigned threads, double nearestMetres) {
+    vector<Contribution*> all;
+    all.reserve(contributions_.size());
+    for (auto& kv : contributions_) all.push_back(&kv.second);
+    vector<uint32_t> located(all.size(), NO_SUBURB);
+    parallelFor(all.size(), threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            located[i] = locateWithFallback(index, Point{all[i]->lon, all[i]->lat}, nearestMetres);
+        }
+    });
+    for (size_t i = 0; i < all.size(); ++i) {
+        Contribution& c = *all[i];
+        uncount(c);
+        c.suburb = NO_SUBURB;
+        if (located[i] != NO_SUBURB && matrix_.add(located[i], c.day)) {
+            c.suburb = located[i];
+            ++assigned_;
+        }
+    }
+    nearestMetres_ = nearestMetres;
+    return all.size();
+}
+
+// Applies inserted/updated observations and deleted ids. Only observations
+// that are new or whose position, date or accuracy changed are located, in
+// parallel, unless nearestMetres differs from the distance the snapshot was
+// counted with: then every observation is located again, so the counts match
+// a fresh run.
+//
+// Args:
+//    index: the suburb index (must match the snapshot)
+//    upserts: new or updated observations (id 0 observations are ignored)
+//    deletedIds: ids of observations that no longer exist or no longer qualify
+//    threads: number of threads to locate changed observations with
+//    nearestMetres: assign points outside every suburb to the nearest one within this distance (0 = off)
+// Returns:
+//    counts of what the delta changed
+DeltaStats Snapshot::apply(const SuburbIndex& index, const vector<ObsPoint>& upserts,
+    const vector<uint64_t>& deletedIds, unsigned threads, double nearestMetres) {
+    if (index.size() != matrix_.suburbs()) throw runtime_error("Snapshot does not match the loaded suburbs");
+    DeltaStats stats;
+    if (nearestMetres != nearestMetres_) stats.relocated = relocate(index, threads, nearestMetres);
+
+    for (uint64_t id : deletedIds) {
+        auto it = contributions_.find(id);
+        if (it == contributions_.end()) {
+            ++stats.ignored;
+            continue;
+        }
+        uncount(it->second);
+        contributions_.erase(it);
+        ++stats.deleted;
+    }
+
+    // pick out what changed (the last upsert of an id wins)
+    vector<const ObsPoint*> changed;
+    for (const auto& op : upserts) {
+        if (op.id == 0) {
+            ++stats.ignored;
+            continue;
+        }
+        auto it = contributions_.find(op.id);
+        if (it != contributions_.end() && it->second.lon == op.lon &&
+            it->second.lat == op.lat && it->second.day == op.day && it->second.accuracy == op.accuracy) {
+            ++stats.unchanged;
+            continue;
+        }
+        changed.push_back(&op);
+    }
+
+    vector<uint32_t> located(changed.size(), NO_SUBURB);
+    parallelFor(changed.size(), threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            located[i] = locateWithFallback(index, Point{changed[i]->lon, changed[i]->lat}, nearestMetres);
+        }
+    });
+
+    for (size_t i = 0; i < changed.size(); ++i) {
+        const ObsPoint& op = *changed[i];
+        auto it = contributions_.find(op.id);
+        if (it == contributions_.end()) {
+            it = contributions_.emplace(op.id, Contribution{}).first;
+            ++stats.inserted;
+        } else {
+            uncount(it->second);
+            ++stats.updated;
+        }
+        Contribution& c = it->second;
+        c.lon = op.lon;
+        c.lat = op.lat;
+        c.day = op.day;
+        c.accuracy = op.accuracy;
+        c.suburb = NO_SUBURB;
+        if (located[i] != NO_SUBURB && matrix_.add(located[i], op.day)) {
+            c.suburb = located[i];
+            ++assigned_;
+        }
+    }
+    return stats;
+}
+
+// Applies a complete result set: every observation is upserted and known ids
+// missing from it are deleted
+//
+// Args:
+//    index: the suburb index (must match the snapshot)
+//    all: every observation that currently qualifies
+//    threads: number of threads to locate changed observations with
+//    nearestMetres: nearest-suburb fallback distance, as for apply
+// Returns:
+//    counts of what changed
+DeltaStats Snapshot::reconcile(const SuburbIndex& index, const vector<ObsPoint>& all, unsigned threads,
+    double nearestMetres) {
+    unordered_set<uint64_t> present;
+    present.reserve(all.size());
+    for (const auto& op : all) present.insert(op.id);
+    vector<uint64_t> gone;
+    for (const auto& kv : contributions_) {
+        if (!present.count(kv.first)) gone.push_back(kv.first);
+    }
+    return apply(index, all, gone, threads, nearestMetres);
+}
+
+// Every tracked observation, e.g. to rebuild outputs that need positions
+//
+// Returns:
+//    the observations in no particular order
+vector<ObsPoint> Snapshot::points() const {
+    vector<ObsPoint> out;
+    out.reserve(contributions_.size());
+    for (const auto& kv : contributions_) {
+        ObsPoint p;
+        p.id = kv.first;
+        p.lon = kv.second.lon;
+        p.lat = kv.second.lat;
+        p.day = kv.second.day;
+        p.accuracy = kv.second.accuracy;
+        out.push_back(p);
+    }
+    return out;
+}
+
+// Writes the snapshot as a little-endian binary file:
+// magic, version, fingerprint, bucket layout, nearest-suburb distance, matrix
+// cells, fetchedAt, contributions
+//
+// Args:
+//    path: the file to write (replaced atomically via a temporary file)
+void Snapshot::save(const string& path) const {
+    const string tmp = path + ".tmp";
+    {
+        ofstream out(tmp, std::ios::binary);
+        if (!out) throw runtime_error("Failed to open snapshot for writing: " + tmp);
+        out.write(SNAPSHOT_MAGIC, 8);
+        writeValue(&out, SNAPSHOT_VERSION);
+        writeValue(&out, fingerprint_);
+        writeValue(&out, static_cast<uint64_t>(matrix_.suburbs()));
+        writeValue(&out, static_cast<uint64_t>(matrix_.buckets()));
+        writeValue(&out, static_cast<int32_t>(matrix_.firstDay()));
+        writeValue(&out, static_cast<int32_t>(matrix_.bucketDays()));
+        writeValue(&out, nearestMetres_);
+        out.write(reinterpret_cast<const char*>(matrix_.data()),
+            static_cast<std::streamsize>(matrix_.size() * sizeof(uint64_t)));
+        writeValue(&out, static_cast<uint32_t>(fetchedAt_.size()));
+        out.write(fetchedAt_.data(), static_cast<std::streamsize>(fetchedAt_.size()));
+        writeValue(&out, static_cast<uint64_t>(contributions_.size()));
+        for (const auto& kv : contributions_) {
+            writeValue(&out, kv.first);
+            writeValue(&out, kv.second.lon);
+            writeValue(&out, kv.second.lat);
+            writeValue(&out, static_cast<int32_t>(kv.second.day));
+            writeValue(&out, kv.second.accuracy);
+            writeValue(&out, kv.second.suburb);
+        }
+        out.close();
+        if (!out) throw runtime_error("Failed to write snapshot: " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) throw runtime_error("Failed to replace snapshot: " + path);
+}
+
+// Reads a snapshot written by save()
+//
+// Args:
+//    path: the snapshot file
+//    suburbs: the loaded suburbs; must be the layer the snapshot was built from
+// Returns:
+//    the snapshot
+Snapshot Snapshot::load(const string& path, const vector<Suburb>& suburbs) {
+    ifstream in(path, std::ios::binary);
+    if (!in) throw runtime_error("Failed to open snapshot: " + path);
+    char magic[8];
+    in.read(magic, 8);
+    if (!in || std::memcmp(magic, SNAPSHOT_MAGIC, 8) != 0) throw runtime_error("Not a snapshot file: " + path);
+    if (readValue<uint32_t>(&in) != SNAPSHOT_VERSION) throw runtime_error("Unsupported snapshot version: " + path);
+    const auto fingerprint = readValue<uint64_t>(&in);
+    const auto nSuburbs = readValue<uint64_t>(&in);
+    if (fingerprint != suburbsFingerprint(suburbs) || nSuburbs != suburbs.size())
+        throw runtime_error("Snapshot was built from different suburbs: " + path);
+    const auto buckets = readValue<uint64_t>(&in);
+    const auto firstDay = readValue<int32_t>(&in);
+    const auto bucketDays = readValue<int32_t>(&in);
+    const auto nearestMetres = readValue<double>(&in);
+    if (buckets == 0 || bucketDays < 1 || !(nearestMetres >= 0)) throw runtime_error("Corrupt snapshot: " + path);
+
+    Snapshot snap(suburbs, firstDay, firstDay + static_cast<int>(buckets) * bucketDays - 1, bucketDays);
+    in.read(reinterpret_cast<char*>(snap.matrix_.data()),
+        static_cast<std::streamsize>(snap.matrix_.size() * sizeof(uint64_t)));
+    snap.nearestMetres_ = nearestMetres;
+    snap.fetchedAt_.resize(readValue<uint32_t>(&in));
+    in.read(&snap.fetchedAt_[0], static_cast<std::streamsize>(snap.fetchedAt_.size()));
+
+    const auto n = readValue<uint64_t>(&in);
+    snap.contributions_.reserve(n);
+    for (uint64_t i = 0; i < n; ++i) {
+        const auto id = readValue<uint64_t>(&in);
+        Contribution c;
+        c.lon = readValue<double>(&in);
+        c.lat = readValue<double>(&in);
+        c.day = readValue<int32_t>(&in);
+        c.accuracy = readValue<double>(&in);
+        c.suburb = readValue<uint32_t>(&in);
+        if (c.suburb != NO_SUBURB) {
+            if (c.suburb >= suburbs.size()) throw runtime_error("Corrupt snapshot: " + path);
+            ++snap.assigned_;
+        }
+        snap.contributions_.emplace(id, c);
+    }
+    return snap;
+}
+
+}  // namespace snapshot
@@ -0,0 +1,97 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_SNAPSHOT_HPP_
+#define TAWNY_DENSITY_SNAPSHOT_HPP_
+
+#include <cstddef>           // for size_t
+#include <cstdint>           // for uint32_t, uint64_t
+#include <string>            // for string
+#include <unordered_map>     // for unordered_map
+#include <vector>            // for vector
+#include "counts.hpp"        // for CountMatrix
+#include "observations.hpp"  // for ObsPoint
+#include "suburb.hpp"        // for Suburb, NO_SUBURB
+#include "suburb_index.hpp"  // for SuburbIndex
+
+using std::string;
+using std::unordered_map;
+using std::vector;
+using counts::CountMatrix;
+using observations::ObsPoint;
+using suburb::Suburb;
+using suburb::NO_SUBURB;
+using suburb::SuburbIndex;
+
+namespace snapshot {
+
+const char SNAPSHOT_MAGIC[] = "TAWNYSNP";
+const uint32_t SNAPSHOT_VERSION = 2;  // 2 fingerprints every ring vertex
+
+// What an observation contributed to the counts when last seen
+struct Contribution {
+    double lon{}, lat{};
+    int day{};
+    double accuracy{};            // positional accuracy radius in metres
+    uint32_t suburb = NO_SUBURB;  // row it is counted in, NO_SUBURB if not counted
+};
+
+// Outcome of applying a delta
+struct DeltaStats {
+    size_t inserted = 0;   // ids not seen before
+    size_t updated = 0;    // known ids whose position, date or accuracy changed
+    size_t unchanged = 0;  // known ids with nothing changed (no work done)
+    size_t deleted = 0;    // known ids removed
+    size_t ignored = 0;    // observations without an id, or deletes of unknown ids
+    size_t relocated = 0;  // known ids located again because the nearest-suburb distance changed
+};
+
+// Persisted count state: the suburb x bucket matrix plus every contributing
+// observation, so later runs only pay for inserted, updated or deleted observations.
+class Snapshot {
+ public:
+    Snapshot(const vector<Suburb>& suburbs, int firstDay, int lastDay, int bucketDays);
+
+    const CountMatrix& matrix() const { return matrix_; }
+    size_t observations() const { return contributions_.size(); }
+    size_t assigned() const { return assigned_; }
+    double nearestMetres() const { return nearestMetres_; }
+    const string& fetchedAt() const { return fetchedAt_; }
+    void setFetchedAt(const string& timestamp) { fetchedAt_ = timestamp; }
+    vector<ObsPoint> points() const;
+
+    DeltaStats apply(const SuburbIndex& index, const vector<ObsPoint>& upserts,
+        const vector<uint64_t>& deletedIds, unsigned threads = 1, double nearestMetres = 0);
+    DeltaStats reconcile(const SuburbIndex& index, const vector<ObsPoint>& all, unsigned threads = 1,
+        double nearestMetres = 0);
+
+    void save(const string& path) const;
+    static Snapshot load(const string& path, const vector<Suburb>& suburbs);
+
+ private:
+    void uncount(const Contribution& c);
+    size_t relocate(const SuburbIndex& index, unsigned threads, double nearestMetres);
+
+    uint64_t fingerprint_ = 0;
+    double nearestMetres_ = 0;  // nearest-suburb fallback distance the counts were assigned with
+    CountMatrix matrix_;
+    unordered_map<uint64_t, Contribution> contributions_;
+    size_t assigned_ = 0;
+    string fetchedAt_;
+};
+
+uint64_t suburbsFingerprint(const vector<Suburb>& suburbs);
+
+}  // namespace snapshot
+
+#endif  // TAWNY_DENSITY_SNAPSHOT_HPP_
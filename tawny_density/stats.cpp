@@ -0,0 +1,402 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "stats.hpp"
+#include <algorithm>          // for find_if, max, min
+#include <atomic>             // for atomic
+#include <chrono>             // for steady_clock, duration
+#include <cmath>              // for ceil, exp2, floor, log2
+#include <cstdint>            // for uint64_t
+#include <cstdio>             // for snprintf
+#include <cstdlib>            // for strtoull
+#include <cstring>            // for strlen
+#include <fstream>            // for ofstream, ifstream
+#include <mutex>              // for mutex, lock_guard
+#include <nlohmann/json.hpp>  // for json
+#include <stdexcept>          // for runtime_error
+#include <string>             // for string
+#include <utility>            // for pair
+#include <vector>             // for vector
+#include "trace.hpp"          // for enabled, record, intern
+
+using std::string;
+using std::vector;
+using std::lock_guard;
+using std::mutex;
+using std::runtime_error;
+using std::chrono::steady_clock;
+using json = nlohmann::json;
+
+namespace stats {
+
+namespace {
+
+const double HISTOGRAM_FLOOR = 1e-9;  // values below this share bucket 0
+const int BUCKETS_PER_DOUBLING = 8;
+const size_t MAX_BUCKETS = 1 + 100 * BUCKETS_PER_DOUBLING;  // up to 1e-9 * 2^100
+const double MIB = 1024.0 * 1024.0;
+const size_t MAP_NODE_OVERHEAD = 32;  // std::map red-black node links and colour
+
+std::atomic<bool> g_enabled{false};
+
+// Value of a "Key:   1234 kB" line of /proc/self/status, in bytes; 0 if unavailable
+uint64_t procStatusBytes(const char* key) {
+    std::ifstream in("/proc/self/status");
+    string line;
+    const size_t keyLen = std::strlen(key);
+    while (std::getline(in, line)) {
+        if (line.compare(0, keyLen, key) == 0 && line.size() > keyLen && line[keyLen] == ':')
+            return std::strtoull(line.c_str() + keyLen + 1, nullptr, 10) * 1024;
+    }
+    return 0;
+}
+
+// Heap bytes a string owns beyond its own object (none while it fits the small-string buffer)
+uint64_t heapBytes(const string& s) {
+    return s.capacity() > string().capacity() ? s.capacity() + 1 : 0;
+}
+
+// Entry for name in entries, appended (default-valued) if missing
+template <typename T>
+T& entry(vector<std::pair<string, T>>* entries, const string& name) {
+    auto it = std::find_if(entries->begin(), entries->end(), [&](const auto& e) { return e.first == name; });
+    if (it != entries->end()) return it->second;
+    entries->emplace_back(name, T{});
+    return entries->back().second;
+}
+
+// Bucket of a value: 0 below HISTOGRAM_FLOOR, else 1 + floor(8 * log2(value / floor))
+size_t bucketOf(double value) {
+    if (!(value >= HISTOGRAM_FLOOR)) return 0;
+    const double b = 1 + std::floor(BUCKETS_PER_DOUBLING * std::log2(value / HISTOGRAM_FLOOR));
+    return std::min(MAX_BUCKETS - 1, static_cast<size_t>(b));
+}
+
+// Upper edge of a bucket
+double bucketTop(size_t bucket) {
+    return HISTOGRAM_FLOOR * std::exp2(static_cast<double>(bucket) / BUCKETS_PER_DOUBLING);
+}
+
+// {"count", "min", "mean", "p50", "p90", "p99", "max"} of a histogram
+json histogramJson(const Histogram& h) {
+    return {{"count", h.count()}, {"min", h.min()}, {"mean", h.mean()}, {"p50", h.percentile(50)},
+        {"p90", h.percentile(90)}, {"p99", h.percentile(99)}, {"max", h.max()}};
+}
+
+}  // namespace
+
+// Adds one value (negative values count as 0)
+void Histogram::add(double value) {
+    value = std::max(0.0, value);
+    const size_t b = bucketOf(value);
+    if (b >= buckets_.size()) buckets_.resize(b + 1);
+    ++buckets_[b];
+    min_ = count_ ? std::min(min_, value) : value;
+    max_ = count_ ? std::max(max_, value) : value;
+    sum_ += value;
+    ++count_;
+}
+
+// Adds every value of other, as if each had been added here
+void Histogram::merge(const Histogram& other) {
+    if (other.count_ == 0) return;
+    if (other.buckets_.size() > buckets_.size()) buckets_.resize(other.buckets_.size());
+    for (size_t b = 0; b < other.buckets_.size(); ++b) buckets_[b] += other.buckets_[b];
+    min_ = count_ ? std::min(min_, other.min_) : other.min_;
+    max_ = count_ ? std::max(max_, other.max_) : other.max_;
+    sum_ += other.sum_;
+    count_ += other.count_;
+}
+
+// Approximate p-th percentile: the top of the bucket holding it, kept within [min, max]
+//
+// Args:
+//    p: percentile, 0..100
+// Returns:
+//    the value, 0 if the histogram is empty
+double Histogram::percentile(double p) const {
+    if (count_ == 0) return 0;
+    const double rank = std::max(1.0, std::ceil(std::min(100.0, std::max(0.0, p)) / 100 * count_));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < buckets_.size(); ++b) {
+        seen += buckets_[b];
+        if (static_cast<double>(seen) >= rank) return std::min(max_, std::max(min_, bucketTop(b)));
+    }
+    return max_;
+}
+
+Registry::Registry() : start_(steady_clock::now()) {}
+
+// Records one run of a phase
+//
+// Args:
+//    name: phase name, e.g. "geojson_parse"
+//    seconds: wall time of this run
+//    items: work done in this run (points, bytes, ...), 0 if not counted
+void Registry::addPhase(const string& name, double seconds, uint64_t items) {
+    const uint64_t rss = peakRssBytes();
+    lock_guard<mutex> lock(mtx_);
+    PhaseStats& p = entry(&phases_, name);
+    ++p.runs;
+    p.seconds += seconds;
+    p.maxSeconds = std::max(p.maxSeconds, seconds);
+    p.items += items;
+    p.peakRssBytes = rss;
+}
+
+// Adds n to a named counter (created at 0)
+void Registry::add(const string& counter, uint64_t n) {
+    lock_guard<mutex> lock(mtx_);
+    entry(&counters_, counter) += n;
+}
+
+// Adds a value to a named histogram (created empty)
+void Registry::record(const string& histogram, double value) {
+    lock_guard<mutex> lock(mtx_);
+    entry(&histograms_, histogram).add(value);
+}
+
+// Adds every value of a histogram to a named histogram (created empty)
+void Registry::mergeHistogram(const string& histogram, const Histogram& values) {
+    lock_guard<mutex> lock(mtx_);
+    entry(&histograms_, histogram).merge(values);
+}
+
+// Records the size of a named structure or buffer, keeping the largest
+// recorded under that name (so per-page buffers report their worst case)
+void Registry::recordBytes(const string& name, uint64_t bytes) {
+    lock_guard<mutex> lock(mtx_);
+    uint64_t& b = entry(&bytes_, name);
+    b = std::max(b, bytes);
+}
+
+// Largest size recorded under name; 0 if none
+uint64_t Registry::bytes(const string& name) const {
+    lock_guard<mutex> lock(mtx_);
+    for (const auto& b : bytes_) {
+        if (b.first == name) return b.second;
+    }
+    return 0;
+}
+
+// Totals for a phase; all zero if it never ran
+PhaseStats Registry::phase(const string& name) const {
+    lock_guard<mutex> lock(mtx_);
+    for (const auto& p : phases_) {
+        if (p.first == name) return p.second;
+    }
+    return PhaseStats{};
+}
+
+// Value of a counter; 0 if never added to
+uint64_t Registry::counter(const string& name) const {
+    lock_guard<mutex> lock(mtx_);
+    for (const auto& c : counters_) {
+        if (c.first == name) return c.second;
+    }
+    return 0;
+}
+
+// Copy of a histogram; empty if never recorded into
+Histogram Registry::histogram(const string& name) const {
+    lock_guard<mutex> lock(mtx_);
+    for (const auto& h : histograms_) {
+        if (h.first == name) return h.second;
+    }
+    return Histogram{};
+}
+
+// Seconds since construction or the last reset
+double Registry::wallSeconds() const {
+    lock_guard<mutex> lock(mtx_);
+    const std::chrono::duration<double> took = steady_clock::now() - start_;
+    return took.count();
+}
+
+// Forgets every phase and counter and restarts the wall clock
+void Registry::reset() {
+    lock_guard<mutex> lock(mtx_);
+    phases_.clear();
+    counters_.clear();
+    histograms_.clear();
+    bytes_.clear();
+    start_ = steady_clock::now();
+}
+
+// The report as JSON:
+// {"wall_seconds": s, "phases": {name: {runs, seconds, max_seconds[, items, items_per_second]}},
+//  "counters": {name: n}, "histograms": {name: {count, min, mean, p50, p90, p99, max}},
+//  "memory": {name: bytes, ..., "peak_rss": bytes, "current_rss": bytes}}
+json Registry::toJson() const {
+    lock_guard<mutex> lock(mtx_);
+    const std::chrono::duration<double> wall = steady_clock::now() - start_;
+    json out;
+    out["wall_seconds"] = wall.count();
+    out["phases"] = json::object();
+    for (const auto& [name, p] : phases_) {
+        json phase = {{"runs", p.runs}, {"seconds", p.seconds}, {"max_seconds", p.maxSeconds},
+            {"peak_rss_bytes", p.peakRssBytes}};
+        if (p.items > 0) {
+            phase["items"] = p.items;
+            phase["items_per_second"] = p.seconds > 0 ? static_cast<double>(p.items) / p.seconds : 0.0;
+        }
+        out["phases"][name] = phase;
+    }
+    out["counters"] = json::object();
+    for (const auto& [name, n] : counters_) out["counters"][name] = n;
+    out["histograms"] = json::object();
+    for (const auto& [name, h] : histograms_) out["histograms"][name] = histogramJson(h);
+    out["memory"] = json::object();
+    for (const auto& [name, b] : bytes_) out["memory"][name] = b;
+    out["memory"]["peak_rss"] = peakRssBytes();
+    out["memory"]["current_rss"] = currentRssBytes();
+    return out;
+}
+
+// The report as aligned text lines: one per phase (with its share of the
+// wall time, peak RSS at its end and throughput), one per counter, one per
+// histogram, then one per memory size
+string Registry::summary() const {
+    lock_guard<mutex> lock(mtx_);
+    const std::chrono::duration<double> took = steady_clock::now() - start_;
+    const double wall = took.count();
+    char line[160];
+    std::snprintf(line, sizeof(line), "Run statistics (%.3f s wall):\n", wall);
+    string out = line;
+    for (const auto& [name, p] : phases_) {
+        std::snprintf(line, sizeof(line), "  %-28s %10.3f s %5.1f%% %6llu run%s %8.1f MiB peak", name.c_str(),
+            p.seconds, wall > 0 ? 100 * p.seconds / wall : 0.0, static_cast<unsigned long long>(p.runs),
+            p.runs == 1 ? " " : "s", static_cast<double>(p.peakRssBytes) / MIB);
+        out += line;
+        if (p.items > 0 && p.seconds > 0) {
+            std::snprintf(line, sizeof(line), " %14.0f items/s", static_cast<double>(p.items) / p.seconds);
+            out += line;
+        }
+        out += "\n";
+    }
+    for (const auto& [name, n] : counters_) {
+        std::snprintf(line, sizeof(line), "  %-28s %10llu\n", name.c_str(), static_cast<unsigned long long>(n));
+        out += line;
+    }
+    for (const auto& [name, h] : histograms_) {
+        std::snprintf(line, sizeof(line), "  %-28s %10llu  p50 %.4g  p90 %.4g  p99 %.4g  max %.4g\n", name.c_str(),
+            static_cast<unsigned long long>(h.count()), h.percentile(50), h.percentile(90), h.percentile(99), h.max());
+        out += line;
+    }
+    for (const auto& [name, b] : bytes_) {
+        std::snprintf(line, sizeof(line), "  %-28s %10.1f MiB\n", name.c_str(), static_cast<double>(b) / MIB);
+        out += line;
+    }
+    std::snprintf(line, sizeof(line), "  %-28s %10.1f MiB (now %.1f MiB)\n", "peak_rss",
+        static_cast<double>(peakRssBytes()) / MIB, static_cast<double>(currentRssBytes()) / MIB);
+    out += line;
+    return out;
+}
+
+Registry& global() {
+    static Registry registry;
+    return registry;
+}
+
+// Turns the costly measurements on or off
+void setEnabled(bool on) {
+    g_enabled.store(on, std::memory_order_relaxed);
+}
+
+// Whether a statistics report was asked for
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+ScopedTimer::ScopedTimer(const string& phase, Registry* registry)
+    : phase_(phase), registry_(registry), start_(steady_clock::now()), traced_(trace::enabled()) {}
+
+ScopedTimer::~ScopedTimer() {
+    stop();
+}
+
+// Records the phase now rather than at scope exit; later calls do nothing
+void ScopedTimer::stop() {
+    if (stopped_) return;
+    stopped_ = true;
+    const steady_clock::time_point end = steady_clock::now();
+    const std::chrono::duration<double> took = end - start_;
+    registry_->addPhase(phase_, took.count(), items_);
+    if (traced_) {
+        using std::chrono::nanoseconds;
+        trace::record(trace::intern(phase_), "phase",
+            std::chrono::duration_cast<nanoseconds>(start_.time_since_epoch()).count(),
+            std::chrono::duration_cast<nanoseconds>(end.time_since_epoch()).count(),
+            items_ > 0 ? static_cast<int64_t>(items_) : -1);
+    }
+}
+
+// Process peak resident set size (VmHWM) in bytes; 0 where /proc is unavailable
+uint64_t peakRssBytes() {
+    return procStatusBytes("VmHWM");
+}
+
+// Process resident set size now (VmRSS) in bytes; 0 where /proc is unavailable
+uint64_t currentRssBytes() {
+    return procStatusBytes("VmRSS");
+}
+
+// Estimated heap bytes held by a parsed JSON document: every value, the
+// strings, arrays and objects it points to, and their spare capacity
+//
+// Args:
+//    j: the document (or any value in it)
+// Returns:
+//    bytes, including j itself
+uint64_t jsonBytes(const json& j) {
+    uint64_t bytes = sizeof(json);
+    switch (j.type()) {
+        case json::value_t::string: {
+            const auto& s = j.get_ref<const json::string_t&>();
+            bytes += sizeof(json::string_t) + heapBytes(s);
+            break;
+        }
+        case json::value_t::array: {
+            const auto& a = j.get_ref<const json::array_t&>();
+            // elements count their own sizeof(json) below; add the spare slots
+            bytes += sizeof(json::array_t) + (a.capacity() - a.size()) * sizeof(json);
+            for (const auto& e : a) bytes += jsonBytes(e);
+            break;
+        }
+        case json::value_t::object: {
+            const auto& o = j.get_ref<const json::object_t&>();
+            bytes += sizeof(json::object_t);
+            for (const auto& [key, value] : o)
+                bytes += MAP_NODE_OVERHEAD + sizeof(json::string_t) + heapBytes(key) + jsonBytes(value);
+            break;
+        }
+        default:
+            break;
+    }
+    return bytes;
+}
+
+// Writes the registry's JSON report to path
+//
+// Args:
+//    path: output file
+//    registry: the statistics to write
+void writeStatsJson(const string& path, const Registry& registry) {
+    std::ofstream file(path);
+    if (!file) throw runtime_error("Failed to open stats file: " + path);
+    file << registry.toJson().dump(2) << "\n";
+    if (!file) throw runtime_error("Failed to write stats file: " + path);
+}
+
+}  // namespace stats
@@ -0,0 +1,127 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_STATS_HPP_
+#define TAWNY_DENSITY_STATS_HPP_
+
+#include <chrono>                 // for steady_clock
+#include <cstdint>                // for uint64_t
+#include <mutex>                  // for mutex
+#include <nlohmann/json_fwd.hpp>  // for json
+#include <string>                 // for string
+#include <utility>                // for pair
+#include <vector>                 // for vector
+
+using std::string;
+using std::vector;
+
+namespace stats {
+
+// Wall time of one named phase, summed over every time it ran
+struct PhaseStats {
+    uint64_t runs = 0;
+    double seconds = 0;
+    double maxSeconds = 0;
+    uint64_t items = 0;  // work done (points, bytes, ...) for a throughput figure; 0 if not counted
+    uint64_t peakRssBytes = 0;  // process peak RSS when the phase last ended
+};
+
+// Distribution of non-negative values (latencies in seconds, byte counts) in
+// log-spaced buckets eight to a doubling, so a percentile is within about 9%
+// of the exact one while memory stays fixed however many values are added.
+class Histogram {
+ public:
+    void add(double value);
+    void merge(const Histogram& other);
+    uint64_t count() const { return count_; }
+    double min() const { return count_ ? min_ : 0; }
+    double max() const { return count_ ? max_ : 0; }
+    double mean() const { return count_ ? sum_ / static_cast<double>(count_) : 0; }
+    double percentile(double p) const;
+
+ private:
+    vector<uint64_t> buckets_;  // grown on demand
+    uint64_t count_ = 0;
+    double sum_ = 0, min_ = 0, max_ = 0;
+};
+
+// Per-phase timings, named counters, histograms and memory sizes for one run. Each kind is
+// kept in the order first recorded, so reports read in pipeline order. Every
+// method is safe to call from any number of threads at once.
+class Registry {
+ public:
+    Registry();
+
+    void addPhase(const string& name, double seconds, uint64_t items = 0);
+    void add(const string& counter, uint64_t n = 1);
+    void record(const string& histogram, double value);
+    void mergeHistogram(const string& histogram, const Histogram& values);
+    void recordBytes(const string& name, uint64_t bytes);
+    PhaseStats phase(const string& name) const;
+    uint64_t counter(const string& name) const;
+    Histogram histogram(const string& name) const;
+    uint64_t bytes(const string& name) const;
+    double wallSeconds() const;
+    void reset();
+
+    nlohmann::json toJson() const;
+    string summary() const;
+
+ private:
+    mutable std::mutex mtx_;
+    std::chrono::steady_clock::time_point start_;
+    vector<std::pair<string, PhaseStats>> phases_;
+    vector<std::pair<string, uint64_t>> counters_;
+    vector<std::pair<string, Histogram>> histograms_;
+    vector<std::pair<string, uint64_t>> bytes_;
+};
+
+// Registry the library and the command line tool record into
+Registry& global();
+
+// Whether a statistics report was asked for. Recording into a Registry is
+// always on, but measurements that cost real work (jsonBytes) are skipped
+// unless this is set.
+void setEnabled(bool on);
+bool enabled();
+
+// Times its own lifetime (or until stop()) and records it as one run of a phase,
+// and as a trace event when tracing is on
+class ScopedTimer {
+ public:
+    explicit ScopedTimer(const string& phase, Registry* registry = &global());
+    ~ScopedTimer();
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    void setItems(uint64_t items) { items_ = items; }
+    void stop();
+
+ private:
+    string phase_;
+    Registry* registry_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t items_ = 0;
+    bool stopped_ = false;
+    bool traced_;
+};
+
+void writeStatsJson(const string& path, const Registry& registry);
+uint64_t peakRssBytes();
+uint64_t currentRssBytes();
+uint64_t jsonBytes(const nlohmann::json& j);
+
+}  // namespace stats
+
+#endif  // TAWNY_DENSITY_STATS_HPP_
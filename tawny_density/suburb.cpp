@@ -14,7 +14,9 @@
 #include "suburb.hpp"
 #include <algorithm>                                // for max, min, find_if
 #include <cstddef>                                  // for size_t
+#include <cstdint>                                  // for uint64_t
 #include <fstream>                                  // for basic_ifstream
+#include <ios>                                      // for streamoff
 #include <map>                                      // for operator!=, opera...
 #include <nlohmann/detail/iterators/iter_impl.hpp>  // for iter_impl
 #include <nlohmann/json.hpp>                        // for basic_json, opera...
@@ -24,6 +26,8 @@
 #include <unordered_map>                            // for unordered_map
 #include <utility>                                  // for move
 #include <vector>                                   // for vector
+#include "query_stats.hpp"                          // for TAWNY_QUERY_COUNT, TAWNY_QUERY_EDGES, ...
+#include "stats.hpp"                                // for ScopedTimer, global, enabled, jsonBytes
 
 using std::string;
 using std::vector;
@@ -86,13 +90,107 @@ void ringBounds(const Ring& ring, double* minLon, double* minLat, double* maxLon
 //     return inside;
 // }
 
+// Splits a ring's edges into y-monotone chains: maximal runs of consecutive
+// edges whose latitude never changes direction (flat edges join the run they
+// are in). Must be called again whenever the ring's points change.
+//
+// Args:
+//    ring: the ring; its chains and chainLats are replaced
+void buildChains(Ring* ring) {
+    ring->chains.clear();
+    ring->chainLats.clear();
+    const size_t n = ring->points.size();
+    int direction = 0;  // of the current chain: 1 rising, -1 falling, 0 flat so far
+    for (size_t i = 0; i < n; ++i) {
+        const double from = ring->points[i].lat;
+        const double to = ring->points[(i + 1) % n].lat;
+        const int d = (to > from) - (to < from);
+        if (i == 0 || (d != 0 && direction != 0 && d != direction)) {
+            ring->chains.push_back(static_cast<uint32_t>(i));
+            direction = d;
+        } else if (direction == 0) {
+            direction = d;
+        }
+    }
+    ring->chains.shrink_to_fit();
+    ring->chainLats.reserve(ring->chains.size() + 1);
+    for (uint32_t first : ring->chains) ring->chainLats.push_back(ring->points[first].lat);
+    if (n > 0) ring->chainLats.push_back(ring->points[0].lat);
+}
+
+namespace {
+
+// Whether the eastward ray from point crosses edge p1-p2 (one step of the
+// ray-casting test)
+inline bool crossesEdge(const Point& p1, const Point& p2, const Point& point) {
+    // Check if the point's y-coordinate/lat is within the
+    // edge's y-range and if the point is to the left of
+    // the edge
+    if ((point.lat > min(p1.lat, p2.lat)) &&
+        (point.lat <= max(p1.lat, p2.lat)) &&
+        (point.lon <= max(p1.lon, p2.lon))) {
+        // Calculate the x-coordinate/lat of the
+        // intersection of the edge with a horizontal
+        // line through the point
+        double xIntersect = (point.lat - p1.lat) * (p2.lon - p1.lon)
+            / (p2.lat - p1.lat) + p1.lon;
+        // If the edge is vertical or the point's
+        // x-coordinate is less than or equal to the
+        // intersection x-coordinate, the ray crosses it
+        return p1.lon == p2.lon || point.lon <= xIntersect;
+    }
+    return false;
+}
+
+// Ray-casting over a ring's monotone chains. An edge can only count if
+// min lat < point.lat <= max lat, and those half-open ranges tile each
+// chain's latitude span without overlap, so each chain holds at most one such
+// edge and a binary search over its vertices finds it. Testing that edge
+// exactly as the full scan does gives the same count.
+bool pointInRingChains(const Ring& ring, const Point& point) {
+    const auto& points = ring.points;
+    const size_t n = points.size();
+    const size_t chains = ring.chains.size();
+    int count = 0;
+    for (size_t c = 0; c < chains; ++c) {
+        const double fromLat = ring.chainLats[c];
+        const double toLat = ring.chainLats[c + 1];
+        if (!(point.lat > min(fromLat, toLat) && point.lat <= max(fromLat, toLat))) continue;
+        const size_t first = ring.chains[c];
+        const size_t last = c + 1 < chains ? ring.chains[c + 1] : n;  // chain edges are [first, last)
+        const bool rising = fromLat < toLat;
+        // first vertex j in (first, last] on or past point.lat; edge j - 1 spans it
+        size_t lo = first + 1, hi = last;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            const double lat = points[mid < n ? mid : 0].lat;
+            if (rising ? lat >= point.lat : lat < point.lat) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        TAWNY_QUERY_EDGES(1);
+        if (crossesEdge(points[lo - 1], points[lo < n ? lo : 0], point)) count++;
+    }
+    return count % 2 == 1;
+}
+
+}  // namespace
+
 // Function to check if a point is inside a polygon using
 // the ray-casting algorithm
 // see https://www.geeksforgeeks.org/cpp/point-in-polygon-in-cpp/
 //    #c-program-to-check-point-in-polygon-using-raycasting-algorithm
+// Rings with monotone chains (see buildChains) skip the chains outside the
+// point's latitude and binary-search one edge in each of the rest, in
+// O(chains + spanning chains x log n) instead of O(n), with the same result.
 bool pointInRing(const Ring& ring, const Point& point) {
+    TAWNY_QUERY_COUNT(ringsTested, 1);
+    if (!ring.chains.empty()) return pointInRingChains(ring, point);
     // Number of vertices in the polygon
     int n = ring.points.size();
+    TAWNY_QUERY_EDGES(n);
     // Count of intersections
     int count = 0;
 
@@ -101,25 +199,7 @@ bool pointInRing(const Ring& ring, const Point& point) {
         Point p1 = ring.points[i];
         // Ensure the last point connects to the first point
         Point p2 = ring.points[(i + 1) % n];
-
-        // Check if the point's y-coordinate/lat is within the
-        // edge's y-range and if the point is to the left of
-        // the edge
-        if ((point.lat > min(p1.lat, p2.lat)) &&
-            (point.lat <= max(p1.lat, p2.lat)) &&
-            (point.lon <= max(p1.lon, p2.lon))) {
-            // Calculate the x-coordinate/lat of the
-            // intersection of the edge with a horizontal
-            // line through the point
-            double xIntersect = (point.lat - p1.lat) * (p2.lon - p1.lon)
-                / (p2.lat - p1.lat) + p1.lon;
-            // If the edge is vertical or the point's
-            // x-coordinate is less than or equal to the
-            // intersection x-coordinate, increment count
-            if (p1.lon == p2.lon || point.lon <= xIntersect) {
-                count++;
-            }
-        }
+        if (crossesEdge(p1, p2, point)) count++;
     }
     // If the number of intersections is odd, the point is
     // inside the polygon
@@ -139,13 +219,16 @@ bool pointInPolygon(const Polygon& poly, const Point& point) {
     if (point.lon < poly.minLon + 1e-12 ||
         point.lon > poly.maxLon + 1e-12||
         point.lat < poly.minLat + 1e-12||
-        point.lat > poly.maxLat + 1e-12)
+        point.lat > poly.maxLat + 1e-12) {
+        TAWNY_QUERY_COUNT(polygonBboxRejects, 1);
         return false;
+    }
     if (poly.rings.empty()) return false;
     // Inside outer?
     if (!pointInRing(poly.rings.front(), point)) return false;
     // Not inside any hole
     for (size_t i = 1; i < poly.rings.size(); ++i) {
+        TAWNY_QUERY_COUNT(holeTests, 1);
         if (pointInRing(poly.rings[i], point)) return false;
     }
     return true;
@@ -159,6 +242,7 @@ bool pointInPolygon(const Polygon& poly, const Point& point) {
 // Returns:
 //     true if point sits inside bounding box
 bool pointInSuburb(const Suburb& suburb, const Point& point) {
+    TAWNY_QUERY_COUNT(suburbBboxTests, 1);
     // Suburb-level bounding box
     if (point.lon < suburb.minLon + 1e-12 ||
         point.lon > suburb.maxLon + 1e-12 ||
@@ -174,6 +258,44 @@ bool pointInSuburb(const Suburb& suburb, const Point& point) {
         });
 }
 
+// Finds the suburb containing point by testing every suburb in order
+//
+// Args:
+//     suburbs: the loaded suburbs
+//     point: the point lat/lon to locate
+// Returns:
+//     id (index into suburbs) of the first suburb containing point, or NO_SUBURB
+uint32_t findSuburb(const vector<Suburb>& suburbs, const Point& point) {
+    for (size_t id = 0; id < suburbs.size(); ++id) {
+        TAWNY_QUERY_CANDIDATE(static_cast<uint32_t>(id));
+        if (pointInSuburb(suburbs[id], point)) return static_cast<uint32_t>(id);
+    }
+    return NO_SUBURB;
+}
+
+// Counts the heap bytes held by loaded suburbs
+//
+// Args:
+//     suburbs: the loaded suburbs
+// Returns:
+//     bytes by category, counting vector capacity rather than size
+GeometryBytes geometryBytes(const vector<Suburb>& suburbs) {
+    GeometryBytes b;
+    b.suburbs = suburbs.capacity() * sizeof(Suburb);
+    for (const auto& s : suburbs) {
+        if (s.name.capacity() > string().capacity()) b.names += s.name.capacity() + 1;
+        b.polygons += s.polys.capacity() * sizeof(Polygon);
+        for (const auto& poly : s.polys) {
+            b.rings += poly.rings.capacity() * sizeof(Ring);
+            for (const auto& ring : poly.rings) {
+                b.vertices += ring.points.capacity() * sizeof(Point);
+                b.chains += ring.chains.capacity() * sizeof(uint32_t) + ring.chainLats.capacity() * sizeof(double);
+            }
+        }
+    }
+    return b;
+}
+
 // Generic detector for suburb name in json
 //
 // Args:
@@ -226,9 +348,22 @@ string detectNameField(const json& props) {
 vector<Suburb> loadSuburbsGeoJSON(
     const string& path, double* outMinLon, double* outMinLat,
     double* outMaxLon, double* outMaxLat) {
-    ifstream in(path);
+    ifstream in(path, std::ios::binary | std::ios::ate);
     if (!in) throw runtime_error("Failed to open GeoJSON: " + path);
-    json gj; in >> gj;
+    const std::streamoff bytes = std::max<std::streamoff>(0, in.tellg());
+    in.seekg(0);
+    stats::global().add("geojson_bytes", static_cast<uint64_t>(bytes));
+    json gj;
+    {
+        // parsed from the stream so the file's text is never held in memory
+        stats::ScopedTimer timer("geojson_parse");
+        timer.setItems(static_cast<uint64_t>(bytes));
+        gj = json::parse(in);
+    }
+    if (stats::enabled()) stats::global().recordBytes("geojson_dom", stats::jsonBytes(gj));
+    // rings, polygon and suburb bounding boxes, and the union bbox
+    stats::ScopedTimer buildTimer("geojson_build");
+    size_t vertices = 0;
 
     if (!gj.contains("features") || !gj["features"].is_array())
         throw runtime_error("Invalid GeoJSON (no features array)");
@@ -273,6 +408,8 @@ vector<Suburb> loadSuburbsGeoJSON(
                         ring.points.front().lat != ring.points.back().lat)) {
                     ring.points.push_back(ring.points.front());
                 }
+                vertices += ring.points.size();
+                buildChains(&ring);
                 poly.rings.push_back(std::move(ring));
             }
             // compute poly axis-aligned bounding box
@@ -316,6 +453,8 @@ vector<Suburb> loadSuburbsGeoJSON(
     }
 
     if (suburbs.empty()) throw runtime_error("No suburb polygons loaded from GeoJSON");
+    buildTimer.setItems(vertices);
+    stats::global().add("geojson_vertices", vertices);
     return suburbs;
 }
 }  // namespace suburb
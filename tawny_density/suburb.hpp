@@ -15,7 +15,9 @@
 #define TAWNY_DENSITY_SUBURB_HPP_
 
 #include <nlohmann/json_fwd.hpp>  // for json
+#include <cstdint>                // for uint32_t, UINT32_MAX
 #include <string>                 // for string, basic_string
+#include <utility>                // for move
 #include <vector>                 // for vector
 
 using std::string;
@@ -23,6 +25,9 @@ using std::vector;
 using json = nlohmann::json;
 
 namespace suburb {
+// suburb id returned when a point is not inside any suburb
+const uint32_t NO_SUBURB = UINT32_MAX;
+
 // -------------------------------------
 // structures for holding suburb polygon
 // -------------------------------------
@@ -32,8 +37,17 @@ struct Point { double lon{}, lat{}; };
 
 // polygon ring
 struct Ring {
+    Ring() = default;
+    explicit Ring(vector<Point> ringPoints) : points(std::move(ringPoints)) {}
+
     // Closed or open ring of lon/lat points
     vector<Point> points;
+    // First edge of each run of edges whose latitude only rises or only falls
+    // (edge i joins points i and i + 1, the last wrapping to the first), and
+    // the latitude each run starts at, plus where the last one ends. Built by
+    // buildChains; when empty, pointInRing scans every edge.
+    vector<uint32_t> chains;
+    vector<double> chainLats;
 };
 
 // polygon shape
@@ -52,10 +66,24 @@ struct Suburb {
     double minLon{}, minLat{}, maxLon{}, maxLat{};
 };
 
+// Heap bytes held by loaded suburbs, by what they hold
+struct GeometryBytes {
+    uint64_t names = 0;     // suburb name strings beyond the small-string buffer
+    uint64_t vertices = 0;  // ring point arrays (capacity)
+    uint64_t chains = 0;    // ring monotone chain starts and latitudes (capacity)
+    uint64_t rings = 0;     // Ring objects in each polygon's ring array
+    uint64_t polygons = 0;  // Polygon objects (ring lists and bboxes) in each suburb
+    uint64_t suburbs = 0;   // the Suburb array itself
+    uint64_t total() const { return names + vertices + chains + rings + polygons + suburbs; }
+};
+
 void ringBounds(const Ring& ring, double* minLon, double* minLat, double* maxLon, double* maxLat);
+void buildChains(Ring* ring);
 bool pointInRing(const Ring& ring, const Point& point);
 bool pointInPolygon(const Polygon& poly, const Point& point);
 bool pointInSuburb(const Suburb& suburb, const Point& point);
+uint32_t findSuburb(const vector<Suburb>& suburbs, const Point& point);
+GeometryBytes geometryBytes(const vector<Suburb>& suburbs);
 string detectNameField(const json& props);
 vector<Suburb> loadSuburbsGeoJSON(
     const string& path, double* outMinLon, double* outMinLat,
@@ -0,0 +1,336 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "suburb_grid.hpp"
+#include <algorithm>        // for min, max, sort, unique
+#include <cmath>            // for ceil, cos, floor, hypot, sqrt, HUGE_VAL
+#include <cstddef>          // for size_t
+#include <cstdint>          // for uint32_t
+#include <utility>          // for pair
+#include <vector>           // for vector
+#include "query_stats.hpp"  // for TAWNY_QUERY_CANDIDATE
+#include "suburb.hpp"       // for Suburb, Ring, Point, pointInSuburb, NO_SUBURB
+
+using std::vector;
+using std::min;
+using std::max;
+using std::pair;
+
+namespace suburb {
+
+const double GRID_EPSILON = 1e-9;  // degrees; pads suburb boxes so boundary points keep their cell
+const double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+namespace {
+
+// Distance in metres from point to a bounding box (0 inside), lon scaled by lonScale metres/degree
+double boxMetres(const Point& p, double minLon, double minLat, double maxLon, double maxLat, double lonScale) {
+    const double dx = max({0.0, minLon - p.lon, p.lon - maxLon}) * lonScale;
+    const double dy = max({0.0, minLat - p.lat, p.lat - maxLat}) * METRES_PER_DEGREE_LAT;
+    return std::hypot(dx, dy);
+}
+
+// Distance up to which boxes, chains and edges must still be searched to find
+// everything within metres: edge distances near a long segment carry rounding
+// error that box distances do not, so the limit gets a micrometre of slack
+inline double pruneLimit(double metres) {
+    return metres * (1 + 1e-12) + 1e-6;
+}
+
+}  // namespace
+
+// Builds the grid
+//
+// Args:
+//    suburbs: the loaded suburbs; must outlive the grid
+//    suburbsPerCell: target average number of suburbs per cell (smaller = finer grid)
+SuburbGrid::SuburbGrid(const vector<Suburb>& suburbs, double suburbsPerCell) : suburbs_(&suburbs) {
+    double minLon = 1e300, minLat = 1e300, maxLon = -1e300, maxLat = -1e300;
+    for (const auto& s : suburbs) {
+        if (s.polys.empty() || s.minLon > s.maxLon) continue;
+        minLon = min(minLon, s.minLon);
+        minLat = min(minLat, s.minLat);
+        maxLon = max(maxLon, s.maxLon);
+        maxLat = max(maxLat, s.maxLat);
+    }
+    if (minLon > maxLon) {
+        cellStart_.assign(1, 0);
+        return;
+    }
+
+    minLon_ = minLon - GRID_EPSILON;
+    minLat_ = minLat - GRID_EPSILON;
+    const double width = maxLon - minLon + 2 * GRID_EPSILON;
+    const double height = maxLat - minLat + 2 * GRID_EPSILON;
+    const double cells = max(1.0, static_cast<double>(suburbs.size()) / max(suburbsPerCell, 1e-3));
+    cols_ = max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(cells * width / height))));
+    rows_ = max<size_t>(1, static_cast<size_t>(std::ceil(cells / static_cast<double>(cols_))));
+    cols_ = min<size_t>(cols_, 1 << 14);
+    rows_ = min<size_t>(rows_, 1 << 14);
+    cellLon_ = width / static_cast<double>(cols_);
+    cellLat_ = height / static_cast<double>(rows_);
+
+    // two passes: count each cell's suburbs, then fill (in id order) at prefix-summed offsets
+    cellStart_.assign(cols_ * rows_ + 1, 0);
+    for (int pass = 0; pass < 2; ++pass) {
+        vector<uint32_t> fill;
+        if (pass == 1) {
+            for (size_t c = 1; c < cellStart_.size(); ++c) cellStart_[c] += cellStart_[c - 1];
+            cellIds_.resize(cellStart_.back());
+            fill.assign(cellStart_.begin(), cellStart_.end() - 1);
+        }
+        for (size_t id = 0; id < suburbs.size(); ++id) {
+            const Suburb& s = suburbs[id];
+            if (s.polys.empty() || s.minLon > s.maxLon) continue;
+            size_t c0, c1, r0, r1;
+            cellRange(s.minLon - GRID_EPSILON, s.maxLon + GRID_EPSILON, minLon_, cellLon_, cols_, &c0, &c1);
+            cellRange(s.minLat - GRID_EPSILON, s.maxLat + GRID_EPSILON, minLat_, cellLat_, rows_, &r0, &r1);
+            for (size_t r = r0; r <= r1; ++r) {
+                for (size_t c = c0; c <= c1; ++c) {
+                    const size_t cell = r * cols_ + c;
+                    if (pass == 0) {
+                        ++cellStart_[cell + 1];
+                    } else {
+                        cellIds_[fill[cell]++] = static_cast<uint32_t>(id);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Clamped range of cells overlapping [lo, hi] along one axis
+void SuburbGrid::cellRange(double lo, double hi, double origin, double cell, size_t n,
+    size_t* first, size_t* last) const {
+    const double a = std::floor((lo - origin) / cell);
+    const double b = std::floor((hi - origin) / cell);
+    const double top = static_cast<double>(n - 1);
+    *first = static_cast<size_t>(min(max(a, 0.0), top));
+    *last = static_cast<size_t>(min(max(b, 0.0), top));
+}
+
+// Cell holding point
+//
+// Returns:
+//    false if point is outside the grid
+bool SuburbGrid::cellOf(const Point& point, size_t* col, size_t* row) const {
+    if (cols_ == 0) return false;
+    const double c = std::floor((point.lon - minLon_) / cellLon_);
+    const double r = std::floor((point.lat - minLat_) / cellLat_);
+    if (!(c >= 0 && r >= 0 && c < static_cast<double>(cols_) && r < static_cast<double>(rows_))) return false;
+    *col = static_cast<size_t>(c);
+    *row = static_cast<size_t>(r);
+    return true;
+}
+
+// Suburbs whose bounding box overlaps the cell holding point, in id order
+//
+// Args:
+//    point: the point lat/lon
+//    count: set to the number of candidates (0 outside the grid)
+// Returns:
+//    pointer to the first candidate id
+const uint32_t* SuburbGrid::candidates(const Point& point, size_t* count) const {
+    size_t col, row;
+    if (!cellOf(point, &col, &row)) {
+        *count = 0;
+        return cellIds_.data();
+    }
+    const size_t cell = row * cols_ + col;
+    *count = cellStart_[cell + 1] - cellStart_[cell];
+    return cellIds_.data() + cellStart_[cell];
+}
+
+// Finds the suburb containing point; same answer as findSuburb, testing only
+// the suburbs listed in the point's cell
+//
+// Args:
+//    point: the point lat/lon to locate
+// Returns:
+//    id of the lowest-id suburb containing point, or NO_SUBURB
+uint32_t SuburbGrid::locate(const Point& point) const {
+    size_t col, row;
+    if (!cellOf(point, &col, &row)) return NO_SUBURB;
+    const size_t cell = row * cols_ + col;
+    for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+        TAWNY_QUERY_CANDIDATE(cellIds_[i]);
+        if (pointInSuburb((*suburbs_)[cellIds_[i]], point)) return cellIds_[i];
+    }
+    return NO_SUBURB;
+}
+
+// Finds the suburb whose boundary is nearest to point, within maxMetres.
+// Candidates come from the grid cells around point; they are visited in order
+// of bounding box distance and the search stops once no box can beat the
+// best edge found. Polygons whose box is farther than the best are skipped,
+// and so are ring chains and edges whose latitude span is (see pointRingMetres).
+//
+// Args:
+//    point: the point lat/lon
+//    maxMetres: search radius in metres
+//    outMetres: if not null, set to the distance found
+// Returns:
+//    id of the nearest suburb (lowest id on ties), or NO_SUBURB if none within maxMetres
+uint32_t SuburbGrid::nearest(const Point& point, double maxMetres, double* outMetres) const {
+    if (cols_ == 0 || !(maxMetres > 0)) return NO_SUBURB;
+    const double lonScale = METRES_PER_DEGREE_LAT * std::cos(point.lat * DEG_TO_RAD);
+    const double dLon = maxMetres / max(lonScale, 1e-6);
+    const double dLat = maxMetres / METRES_PER_DEGREE_LAT;
+
+    const double gridMaxLon = minLon_ + cellLon_ * static_cast<double>(cols_);
+    const double gridMaxLat = minLat_ + cellLat_ * static_cast<double>(rows_);
+    if (point.lon + dLon < minLon_ || point.lon - dLon > gridMaxLon ||
+        point.lat + dLat < minLat_ || point.lat - dLat > gridMaxLat)
+        return NO_SUBURB;
+
+    size_t c0, c1, r0, r1;
+    cellRange(point.lon - dLon, point.lon + dLon, minLon_, cellLon_, cols_, &c0, &c1);
+    cellRange(point.lat - dLat, point.lat + dLat, minLat_, cellLat_, rows_, &r0, &r1);
+    vector<uint32_t> ids;
+    for (size_t r = r0; r <= r1; ++r) {
+        for (size_t c = c0; c <= c1; ++c) {
+            const size_t cell = r * cols_ + c;
+            ids.insert(ids.end(), cellIds_.begin() + cellStart_[cell], cellIds_.begin() + cellStart_[cell + 1]);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    vector<pair<double, uint32_t>> candidates;
+    for (uint32_t id : ids) {
+        const Suburb& s = (*suburbs_)[id];
+        const double d = boxMetres(point, s.minLon, s.minLat, s.maxLon, s.maxLat, lonScale);
+        if (d <= pruneLimit(maxMetres)) candidates.emplace_back(d, id);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    double best = maxMetres;
+    uint32_t bestId = NO_SUBURB;
+    for (const auto& candidate : candidates) {
+        if (candidate.first > pruneLimit(best)) break;
+        const double d = pointSuburbMetres((*suburbs_)[candidate.second], point, best);
+        if (d < best || (d == best && candidate.second < bestId)) {
+            best = d;
+            bestId = candidate.second;
+        }
+    }
+    if (outMetres && bestId != NO_SUBURB) *outMetres = best;
+    return bestId;
+}
+
+// Distance in metres from p to segment ab, using a local equirectangular projection around p
+//
+// Args:
+//    p: the point
+//    a: segment start
+//    b: segment end
+//    lonScale: metres per degree of longitude at p
+// Returns:
+//    the distance in metres
+double pointSegmentMetres(const Point& p, const Point& a, const Point& b, double lonScale) {
+    const double ax = (a.lon - p.lon) * lonScale, ay = (a.lat - p.lat) * METRES_PER_DEGREE_LAT;
+    const double bx = (b.lon - p.lon) * lonScale, by = (b.lat - p.lat) * METRES_PER_DEGREE_LAT;
+    const double dx = bx - ax, dy = by - ay;
+    const double len2 = dx * dx + dy * dy;
+    double t = len2 > 0 ? -(ax * dx + ay * dy) / len2 : 0;
+    t = min(1.0, max(0.0, t));
+    return std::hypot(ax + t * dx, ay + t * dy);
+}
+
+namespace {
+
+// Distance in metres from point to the nearest edge of ring, skipping edges
+// whose latitude span is more than limit metres from the point (they cannot
+// be within limit). With monotone chains (see buildChains) only chains whose
+// latitude span comes within limit are visited, and in each a binary search
+// over its vertices finds the run of edges inside that band, so a point near
+// a long ring tests a few edges rather than all of them.
+//
+// Args:
+//    ring: the ring
+//    point: the point
+//    lonScale: metres per degree of longitude at point
+//    limit: edges farther than this may be skipped
+// Returns:
+//    the distance if it is at most limit; otherwise larger than limit
+double pointRingMetres(const Ring& ring, const Point& point, double lonScale, double limit) {
+    const auto& points = ring.points;
+    const size_t n = points.size();
+    double best = HUGE_VAL;
+    if (ring.chains.empty()) {
+        for (size_t i = 0; i + 1 < n; ++i) {
+            best = min(best, pointSegmentMetres(point, points[i], points[i + 1], lonScale));
+        }
+        // rings built by hand may be open
+        if (n > 1) best = min(best, pointSegmentMetres(point, points[n - 1], points[0], lonScale));
+        return best;
+    }
+
+    const size_t chains = ring.chains.size();
+    for (size_t c = 0; c < chains; ++c) {
+        // latitude band that can hold an edge within the limit
+        const double band = pruneLimit(min(best, limit)) / METRES_PER_DEGREE_LAT;
+        const double fromLat = ring.chainLats[c];
+        const double toLat = ring.chainLats[c + 1];
+        if (point.lat + band < min(fromLat, toLat) || point.lat - band > max(fromLat, toLat)) continue;
+        const size_t first = ring.chains[c];
+        const size_t last = c + 1 < chains ? ring.chains[c + 1] : n;  // chain edges are [first, last)
+        // latitudes along the chain, negated on falling chains, never decrease
+        const bool rising = fromLat < toLat;
+        auto key = [&](size_t v) { return rising ? points[v < n ? v : 0].lat : -points[v < n ? v : 0].lat; };
+        const double lo = rising ? point.lat - band : -(point.lat + band);
+        const double hi = rising ? point.lat + band : -(point.lat - band);
+        // first edge whose far end reaches the band
+        size_t begin = first, end = last;
+        while (begin < end) {
+            const size_t mid = begin + (end - begin) / 2;
+            if (key(mid + 1) >= lo) {
+                end = mid;
+            } else {
+                begin = mid + 1;
+            }
+        }
+        // edges from there on until one starts past the band
+        for (size_t i = begin; i < last && key(i) <= hi; ++i) {
+            best = min(best, pointSegmentMetres(point, points[i], points[i + 1 < n ? i + 1 : 0], lonScale));
+        }
+    }
+    return best;
+}
+
+}  // namespace
+
+// Distance in metres from point to the nearest edge of any ring of suburb
+//
+// Args:
+//    suburb: the suburb
+//    point: the point
+//    bestSoFar: polygons and edges farther than this may be skipped
+// Returns:
+//    the distance if it is at most bestSoFar; otherwise larger than bestSoFar
+//    (HUGE_VAL if everything was skipped)
+double pointSuburbMetres(const Suburb& suburb, const Point& point, double bestSoFar) {
+    const double lonScale = METRES_PER_DEGREE_LAT * std::cos(point.lat * DEG_TO_RAD);
+    double best = HUGE_VAL;
+    for (const auto& poly : suburb.polys) {
+        const double limit = pruneLimit(min(best, bestSoFar));
+        if (boxMetres(point, poly.minLon, poly.minLat, poly.maxLon, poly.maxLat, lonScale) > limit) continue;
+        for (const auto& ring : poly.rings) {
+            best = min(best, pointRingMetres(ring, point, lonScale, min(best, bestSoFar)));
+        }
+    }
+    return best;
+}
+
+}  // namespace suburb
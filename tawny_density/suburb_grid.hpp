@@ -0,0 +1,63 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TAWNY_DENSITY_SUBURB_GRID_HPP_
+#define TAWNY_DENSITY_SUBURB_GRID_HPP_
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t
+#include <vector>      // for vector
+#include "suburb.hpp"  // for Suburb, Point
+
+using std::vector;
+
+namespace suburb {
+
+const double METRES_PER_DEGREE_LAT = 111320.0;
+
+// Uniform grid over the suburbs' bounding box. Each cell lists (in id order)
+// the suburbs whose bounding box overlaps it, so a lookup only tests the few
+// suburbs near the point. The grid refers to the suburbs vector, which must
+// outlive it and stay unchanged. All queries are const and thread-safe.
+class SuburbGrid {
+ public:
+    explicit SuburbGrid(const vector<Suburb>& suburbs, double suburbsPerCell = 0.25);
+
+    const vector<Suburb>& suburbs() const { return *suburbs_; }
+    size_t cols() const { return cols_; }
+    size_t rows() const { return rows_; }
+    size_t memoryBytes() const {
+        return (cellStart_.capacity() + cellIds_.capacity()) * sizeof(uint32_t);
+    }
+
+    uint32_t locate(const Point& point) const;
+    const uint32_t* candidates(const Point& point, size_t* count) const;
+    uint32_t nearest(const Point& point, double maxMetres, double* outMetres = nullptr) const;
+
+ private:
+    bool cellOf(const Point& point, size_t* col, size_t* row) const;
+    void cellRange(double lo, double hi, double origin, double cell, size_t n, size_t* first, size_t* last) const;
+
+    const vector<Suburb>* suburbs_;
+    double minLon_ = 0, minLat_ = 0, cellLon_ = 1, cellLat_ = 1;
+    size_t cols_ = 0, rows_ = 0;
+    vector<uint32_t> cellStart_;  // cell c lists cellIds_[cellStart_[c] .. cellStart_[c + 1])
+    vector<uint32_t> cellIds_;
+};
+
+double pointSegmentMetres(const Point& p, const Point& a, const Point& b, double lonScale);
+double pointSuburbMetres(const Suburb& suburb, const Point& point, double bestSoFar);
+
+}  // namespace suburb
+
+#endif  // TAWNY_DENSITY_SUBURB_GRID_HPP_
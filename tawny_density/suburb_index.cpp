@@ -0,0 +1,155 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "suburb_index.hpp"
+#include <cstddef>          // for size_t
+#include <cstdint>            // for uint32_t
+#include <fstream>            // for ifstream
+#include <memory>             // for make_shared
+#include <stdexcept>          // for runtime_error
+#include <string>             // for string
+#include <utility>            // for move
+#include <vector>             // for vector
+#include "parallel.hpp"       // for parallelFor
+#include "query_stats.hpp"    // for TAWNY_QUERY_BEGIN, TAWNY_QUERY_END
+#include "stats.hpp"          // for ScopedTimer
+#include "suburb.hpp"         // for Suburb, Point, findSuburb
+#include "suburb_grid.hpp"    // for SuburbGrid
+#include "trapezoid_map.hpp"  // for TrapezoidMap
+
+using std::string;
+using std::vector;
+using std::runtime_error;
+
+namespace suburb {
+
+// Parses a strategy name as given on the command line
+//
+// Args:
+//    name: "linear", "grid" or "trapezoid"
+// Returns:
+//    the strategy; throws runtime_error for unknown names
+IndexStrategy parseIndexStrategy(const string& name) {
+    if (name == "linear") return IndexStrategy::Linear;
+    if (name == "grid") return IndexStrategy::Grid;
+    if (name == "trapezoid") return IndexStrategy::Trapezoid;
+    throw runtime_error("Unknown index strategy: " + name);
+}
+
+// Name of a strategy, as accepted by parseIndexStrategy
+//
+// Args:
+//    strategy: the strategy
+// Returns:
+//    its name
+const char* indexStrategyName(IndexStrategy strategy) {
+    switch (strategy) {
+        case IndexStrategy::Linear: return "linear";
+        case IndexStrategy::Grid: return "grid";
+        case IndexStrategy::Trapezoid: return "trapezoid";
+    }
+    return "unknown";
+}
+
+// Builds the index. The grid is built for every strategy since nearest() uses it.
+//
+// Args:
+//    suburbs: the loaded suburbs, taken over by the index
+//    strategy: how locate() finds candidate suburbs
+//    mapCachePath: Trapezoid only; if not empty, the map is loaded from this file when it was
+//                  built from the same suburbs, and otherwise built and saved there
+SuburbIndex::SuburbIndex(vector<Suburb> suburbs, IndexStrategy strategy, const string& mapCachePath)
+    : suburbs_(std::make_shared<const vector<Suburb>>(std::move(suburbs))),
+      strategy_(strategy),
+      grid_(std::make_shared<const SuburbGrid>(*suburbs_)) {
+    if (strategy_ != IndexStrategy::Trapezoid) return;
+    if (!mapCachePath.empty() && std::ifstream(mapCachePath).good()) {
+        try {
+            stats::ScopedTimer timer("trapezoid_load");
+            map_ = std::make_shared<const TrapezoidMap>(TrapezoidMap::load(mapCachePath, *suburbs_));
+            return;
+        } catch (const runtime_error&) {
+            // stale or damaged: rebuild below and overwrite it
+        }
+    }
+    stats::ScopedTimer timer("trapezoid_build");
+    map_ = std::make_shared<const TrapezoidMap>(*suburbs_, *grid_);
+    if (!mapCachePath.empty()) map_->save(mapCachePath);
+}
+
+// Bytes held by the index structures (not the suburbs themselves)
+size_t SuburbIndex::memoryBytes() const {
+    return sizeof(SuburbGrid) + grid_->memoryBytes() + (map_ ? sizeof(TrapezoidMap) + map_->memoryBytes() : 0);
+}
+
+// Finds the suburb containing point
+//
+// Args:
+//    point: the point lat/lon to locate
+// Returns:
+//    id of the lowest-id suburb containing point, or NO_SUBURB
+uint32_t SuburbIndex::locate(const Point& point) const {
+    TAWNY_QUERY_BEGIN();
+    uint32_t id = NO_SUBURB;
+    if (strategy_ == IndexStrategy::Linear) {
+        id = findSuburb(*suburbs_, point);
+    } else if (strategy_ == IndexStrategy::Trapezoid) {
+        id = map_->locate(point);
+        if (id == TrapezoidMap::AMBIGUOUS) id = grid_->locate(point);
+    } else {
+        id = grid_->locate(point);
+    }
+    TAWNY_QUERY_END(id);
+    return id;
+}
+
+// Locates many points
+//
+// Args:
+//    points: the points to locate
+//    count: number of points
+//    out: receives count suburb ids (NO_SUBURB where a point is in no suburb)
+//    threads: number of threads to split the points over (0 = hardware concurrency)
+void SuburbIndex::locateBatch(const Point* points, size_t count, uint32_t* out, unsigned threads) const {
+    parallel::parallelFor(count, threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) out[i] = locate(points[i]);
+    });
+}
+
+// Locates many points
+//
+// Args:
+//    points: the points to locate
+//    threads: number of threads to split the points over (0 = hardware concurrency)
+// Returns:
+//    suburb id per point (NO_SUBURB where a point is in no suburb)
+vector<uint32_t> SuburbIndex::locateBatch(const vector<Point>& points, unsigned threads) const {
+    vector<uint32_t> out(points.size());
+    locateBatch(points.data(), points.size(), out.data(), threads);
+    return out;
+}
+
+// Finds the suburb whose boundary is nearest to point, within maxMetres
+//
+// Args:
+//    point: the point lat/lon
+//    maxMetres: search radius in metres
+//    outMetres: if not null, set to the distance found
+// Returns:
+//    id of the nearest suburb (lowest id on ties), or NO_SUBURB if none within maxMetres
+uint32_t SuburbIndex::nearest(const Point& point, double maxMetres, double* outMetres) const {
+    return grid_->nearest(point, maxMetres, outMetres);
+}
+
+}  // namespace suburb
@@ -0,0 +1,73 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_SUBURB_INDEX_HPP_
+#define TAWNY_DENSITY_SUBURB_INDEX_HPP_
+
+#include <cstddef>          // for size_t
+#include <cstdint>            // for uint32_t
+#include <memory>             // for shared_ptr
+#include <string>             // for string
+#include <vector>             // for vector
+#include "suburb.hpp"         // for Suburb, Point
+#include "suburb_grid.hpp"    // for SuburbGrid
+#include "trapezoid_map.hpp"  // for TrapezoidMap
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace suburb {
+
+// How SuburbIndex::locate finds candidate suburbs
+enum class IndexStrategy {
+    Linear,     // test every suburb in id order (reference behaviour)
+    Grid,       // test only the suburbs listed in the point's grid cell
+    Trapezoid,  // walk a trapezoidal map of every edge; the grid answers points on an edge
+};
+
+IndexStrategy parseIndexStrategy(const string& name);
+const char* indexStrategyName(IndexStrategy strategy);
+
+// Point-to-suburb lookup over a set of loaded suburbs. The index owns the
+// suburbs and never changes after construction, so every method may be called
+// from any number of threads at once. Whatever the strategy, locate() returns
+// what findSuburb would: the lowest-id suburb containing the point.
+class SuburbIndex {
+ public:
+    explicit SuburbIndex(vector<Suburb> suburbs, IndexStrategy strategy = IndexStrategy::Grid,
+        const string& mapCachePath = "");
+
+    const vector<Suburb>& suburbs() const { return *suburbs_; }
+    size_t size() const { return suburbs_->size(); }
+    IndexStrategy strategy() const { return strategy_; }
+    const TrapezoidMap* trapezoidMap() const { return map_.get(); }  // null unless the Trapezoid strategy
+    size_t memoryBytes() const;
+
+    uint32_t locate(const Point& point) const;
+    void locateBatch(const Point* points, size_t count, uint32_t* out, unsigned threads = 1) const;
+    vector<uint32_t> locateBatch(const vector<Point>& points, unsigned threads = 1) const;
+    uint32_t nearest(const Point& point, double maxMetres, double* outMetres = nullptr) const;
+
+ private:
+    // shared so the index stays movable while the grid points into the vector
+    shared_ptr<const vector<Suburb>> suburbs_;
+    IndexStrategy strategy_;
+    shared_ptr<const SuburbGrid> grid_;
+    shared_ptr<const TrapezoidMap> map_;
+};
+
+}  // namespace suburb
+
+#endif  // TAWNY_DENSITY_SUBURB_INDEX_HPP_
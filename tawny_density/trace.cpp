@@ -0,0 +1,196 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "trace.hpp"
+#include <algorithm>          // for max, min
+#include <atomic>             // for atomic
+#include <cstdint>            // for int64_t, uint32_t, uint64_t
+#include <fstream>            // for ofstream
+#include <memory>             // for shared_ptr, make_shared
+#include <mutex>              // for mutex, lock_guard
+#include <nlohmann/json.hpp>  // for json
+#include <set>                // for set
+#include <stdexcept>          // for runtime_error
+#include <string>             // for string
+#include <vector>             // for vector
+
+using std::string;
+using std::vector;
+using std::lock_guard;
+using std::mutex;
+using std::runtime_error;
+using std::shared_ptr;
+using json = nlohmann::json;
+
+namespace trace {
+
+namespace {
+
+// Events recorded by one thread. Only the owning thread writes it; once full,
+// the oldest events are overwritten.
+struct ThreadBuffer {
+    uint32_t tid = 0;
+    const char* name = nullptr;
+    size_t capacity = 0;
+    vector<Event> events;
+    size_t next = 0;  // slot overwritten next once full (the oldest event)
+    uint64_t dropped = 0;
+};
+
+// Every thread's buffer for the current trace, kept after the thread exits
+struct TraceState {
+    mutex mtx;
+    vector<shared_ptr<ThreadBuffer>> buffers;
+    std::set<string> names;
+    size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD;
+    int64_t originNs = 0;
+};
+
+TraceState& state() {
+    static TraceState s;
+    return s;
+}
+
+std::atomic<bool> g_enabled{false};
+std::atomic<uint64_t> g_generation{0};  // bumped by start(), so threads drop buffers of earlier traces
+
+// The calling thread's buffer for the current trace, registered on first use
+ThreadBuffer& localBuffer() {
+    thread_local uint64_t generation = 0;
+    thread_local shared_ptr<ThreadBuffer> buffer;
+    const uint64_t current = g_generation.load(std::memory_order_acquire);
+    if (!buffer || generation != current) {
+        auto fresh = std::make_shared<ThreadBuffer>();
+        TraceState& s = state();
+        lock_guard<mutex> lock(s.mtx);
+        fresh->tid = static_cast<uint32_t>(s.buffers.size() + 1);
+        fresh->capacity = s.eventsPerThread;
+        fresh->events.reserve(std::min<size_t>(s.eventsPerThread, 1024));
+        s.buffers.push_back(fresh);
+        buffer = fresh;
+        generation = current;
+    }
+    return *buffer;
+}
+
+}  // namespace
+
+// Starts a new trace, discarding any earlier one
+//
+// Args:
+//    eventsPerThread: ring buffer size; a thread's oldest events are dropped beyond this
+void start(size_t eventsPerThread) {
+    TraceState& s = state();
+    lock_guard<mutex> lock(s.mtx);
+    s.buffers.clear();
+    s.eventsPerThread = std::max<size_t>(1, eventsPerThread);
+    s.originNs = nowNs();
+    g_generation.fetch_add(1, std::memory_order_acq_rel);
+    g_enabled.store(true, std::memory_order_release);
+}
+
+// Stops recording; the events so far are kept for toJson() and writeTrace()
+void stop() {
+    g_enabled.store(false, std::memory_order_release);
+}
+
+// Whether events are being recorded
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+// Records one complete event on the calling thread
+//
+// Args:
+//    name: event name; must outlive the trace (a literal or intern()ed)
+//    category: event category, likewise
+//    startNs: start time from nowNs()
+//    endNs: end time from nowNs()
+//    items: work done, shown as args.items; negative if not counted
+void record(const char* name, const char* category, int64_t startNs, int64_t endNs, int64_t items) {
+    if (!enabled()) return;
+    ThreadBuffer& b = localBuffer();
+    const Event event{name, category, startNs, endNs, items};
+    if (b.events.size() < b.capacity) {
+        b.events.push_back(event);
+    } else {
+        b.events[b.next] = event;
+        b.next = (b.next + 1) % b.capacity;
+        ++b.dropped;
+    }
+}
+
+// Names the calling thread's track in the viewer
+//
+// Args:
+//    name: thread name; must outlive the trace
+void setThreadName(const char* name) {
+    if (!enabled()) return;
+    localBuffer().name = name;
+}
+
+// A copy of name that lives until the process exits, for event names built at run time
+//
+// Args:
+//    name: the name
+// Returns:
+//    a stable pointer to the same text
+const char* intern(const string& name) {
+    TraceState& s = state();
+    lock_guard<mutex> lock(s.mtx);
+    return s.names.insert(name).first->c_str();
+}
+
+// The trace in Chrome trace-event format: one complete ("X") event per span
+// with microsecond times from start(), plus thread_name metadata. Call once the
+// traced work has finished, as buffers are read without stopping their threads.
+//
+// Returns:
+//    {"traceEvents": [...], "displayTimeUnit": "ms", "otherData": {"dropped_events": n}}
+json toJson() {
+    TraceState& s = state();
+    lock_guard<mutex> lock(s.mtx);
+    json events = json::array();
+    uint64_t dropped = 0;
+    for (const auto& b : s.buffers) {
+        if (b->name) {
+            events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", b->tid},
+                {"args", {{"name", b->name}}}});
+        }
+        // oldest first
+        for (size_t k = 0; k < b->events.size(); ++k) {
+            const Event& e = b->events[(b->next + k) % b->events.size()];
+            json event = {{"name", e.name}, {"cat", e.category}, {"ph", "X"}, {"pid", 1}, {"tid", b->tid},
+                {"ts", static_cast<double>(e.startNs - s.originNs) / 1e3},
+                {"dur", static_cast<double>(e.endNs - e.startNs) / 1e3}};
+            if (e.items >= 0) event["args"] = {{"items", e.items}};
+            events.push_back(event);
+        }
+        dropped += b->dropped;
+    }
+    return {{"traceEvents", events}, {"displayTimeUnit", "ms"}, {"otherData", {{"dropped_events", dropped}}}};
+}
+
+// Writes toJson() to path, for chrome://tracing or ui.perfetto.dev
+//
+// Args:
+//    path: output file
+void writeTrace(const string& path) {
+    std::ofstream file(path);
+    if (!file) throw runtime_error("Failed to open trace file: " + path);
+    file << toJson().dump() << "\n";
+    if (!file) throw runtime_error("Failed to write trace file: " + path);
+}
+
+}  // namespace trace
@@ -0,0 +1,77 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_TRACE_HPP_
+#define TAWNY_DENSITY_TRACE_HPP_
+
+#include <chrono>                 // for steady_clock, nanoseconds
+#include <cstddef>                // for size_t
+#include <cstdint>                // for int64_t
+#include <nlohmann/json_fwd.hpp>  // for json
+#include <string>                 // for string
+
+using std::string;
+
+namespace trace {
+
+const size_t DEFAULT_EVENTS_PER_THREAD = 1 << 16;
+
+// One span on one thread. Names and categories are string literals (or
+// intern()ed), so recording never allocates.
+struct Event {
+    const char* name;
+    const char* category;
+    int64_t startNs, endNs;  // steady clock
+    int64_t items;           // shown as args.items; negative if not counted
+};
+
+void start(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+void stop();
+bool enabled();
+void record(const char* name, const char* category, int64_t startNs, int64_t endNs, int64_t items = -1);
+void setThreadName(const char* name);
+const char* intern(const string& name);
+nlohmann::json toJson();
+void writeTrace(const string& path);
+
+// Steady clock now, in nanoseconds
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Records its own lifetime as one event on the calling thread, if tracing was
+// enabled when it was constructed; otherwise costs one atomic load
+class Span {
+ public:
+    Span(const char* name, const char* category) : name_(name), category_(category),
+        startNs_(enabled() ? nowNs() : -1) {}
+    ~Span() {
+        if (startNs_ >= 0) record(name_, category_, startNs_, nowNs(), items_);
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    void setItems(int64_t items) { items_ = items; }
+
+ private:
+    const char* name_;
+    const char* category_;
+    int64_t startNs_;
+    int64_t items_ = -1;
+};
+
+}  // namespace trace
+
+#endif  // TAWNY_DENSITY_TRACE_HPP_
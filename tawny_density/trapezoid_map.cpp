@@ -0,0 +1,580 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "trapezoid_map.hpp"
+#include <algorithm>        // for sort, unique, lower_bound, shuffle, min, max
+#include <cmath>            // for fabs, hypot, HUGE_VAL
+#include <cstdint>          // for uint32_t, uint64_t
+#include <cstring>          // for memcmp
+#include <fstream>          // for ifstream, ofstream
+#include <random>           // for mt19937_64
+#include <stdexcept>        // for runtime_error
+#include <string>           // for string
+#include <utility>          // for pair
+#include <vector>           // for vector
+#include "suburb.hpp"       // for Suburb, Point, NO_SUBURB
+#include "suburb_grid.hpp"  // for SuburbGrid
+
+using std::string;
+using std::vector;
+using std::ifstream;
+using std::ofstream;
+using std::runtime_error;
+
+namespace suburb {
+
+namespace {
+
+const uint32_t NONE = 0xFFFFFFFF;
+const uint32_t X_NODE = 0, Y_NODE = 1, LEAF = 2;
+
+using Node = TrapezoidMap::Node;
+using Segment = TrapezoidMap::Segment;
+
+// Points are ordered by lon, then lat: a symbolic shear, so no two distinct
+// points share an x and vertical edges need no special case
+bool lexLess(const Point& p, const Point& q) {
+    return p.lon < q.lon || (p.lon == q.lon && p.lat < q.lat);
+}
+
+bool samePoint(const Point& p, const Point& q) {
+    return p.lon == q.lon && p.lat == q.lat;
+}
+
+// Twice the signed area of abc: positive if c is left of (above) a->b
+double orient(const Point& a, const Point& b, const Point& c) {
+    return (b.lon - a.lon) * (c.lat - a.lat) - (b.lat - a.lat) * (c.lon - a.lon);
+}
+
+// Whether c, collinear with ab, lies within the segment
+bool withinSegment(const Point& a, const Point& b, const Point& c) {
+    return std::min(a.lon, b.lon) <= c.lon && c.lon <= std::max(a.lon, b.lon) &&
+        std::min(a.lat, b.lat) <= c.lat && c.lat <= std::max(a.lat, b.lat);
+}
+
+// Latitude of segment ab at lon x, clamped to its extent
+double latAt(const Point& a, const Point& b, double x) {
+    if (b.lon == a.lon) return std::max(a.lat, b.lat);
+    const double t = std::min(1.0, std::max(0.0, (x - a.lon) / (b.lon - a.lon)));
+    return a.lat + t * (b.lat - a.lat);
+}
+
+// Distance from p to segment ab in degrees
+double pointSegmentDegrees(const Point& p, const Point& a, const Point& b) {
+    const double dx = b.lon - a.lon, dy = b.lat - a.lat;
+    const double len2 = dx * dx + dy * dy;
+    double t = len2 > 0 ? ((p.lon - a.lon) * dx + (p.lat - a.lat) * dy) / len2 : 0;
+    t = std::min(1.0, std::max(0.0, t));
+    return std::hypot(p.lon - a.lon - t * dx, p.lat - a.lat - t * dy);
+}
+
+// FNV-1a over raw bytes
+void fnv(uint64_t* h, const void* data, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        *h ^= p[i];
+        *h *= 1099511628211ULL;
+    }
+}
+
+template <typename T>
+void writeValue(ofstream* out, const T& value) {
+    out->write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readValue(ifstream* in) {
+    T value{};
+    in->read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (!*in) throw runtime_error("Truncated trapezoid map");
+    return value;
+}
+
+template <typename T>
+void writeVector(ofstream* out, const vector<T>& values) {
+    writeValue(out, static_cast<uint64_t>(values.size()));
+    out->write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template <typename T>
+vector<T> readVector(ifstream* in, uint64_t maxSize) {
+    const auto n = readValue<uint64_t>(in);
+    if (n > maxSize) throw runtime_error("Corrupt trapezoid map");
+    vector<T> values(n);
+    in->read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(n * sizeof(T)));
+    if (!*in) throw runtime_error("Truncated trapezoid map");
+    return values;
+}
+
+// A trapezoid of the map under construction: bounded above and below by
+// segments (NONE = unbounded), left and right by vertical walls through points
+// (NONE = infinite). upperLeft is the neighbour across the part of the left
+// wall above leftp, lowerLeft across the part below it, and likewise on the
+// right; so t.upperLeft == u exactly when u.upperRight == t.
+struct Trapezoid {
+    uint32_t top = NONE, bottom = NONE, leftp = NONE, rightp = NONE;
+    uint32_t upperLeft = NONE, lowerLeft = NONE, upperRight = NONE, lowerRight = NONE;
+    uint32_t node = NONE;  // its leaf in the DAG; NONE once replaced
+};
+
+// Randomized incremental construction of the map and its search DAG
+class Builder {
+ public:
+    Builder(const vector<Point>& points, const vector<Segment>& segments, vector<Node>* nodes)
+        : points_(points), segments_(segments), nodes_(*nodes) {
+        nodes_.clear();
+        newTrapezoid(Trapezoid{});  // the whole plane, leaf at the root
+    }
+
+    bool insert(uint32_t s);
+    const vector<Trapezoid>& trapezoids() const { return traps_; }
+
+ private:
+    const Point& point(uint32_t i) const { return points_[i]; }
+    double orientSeg(uint32_t s, const Point& c) const {
+        return orient(point(segments_[s].a), point(segments_[s].b), c);
+    }
+    bool compatible(uint32_t s, uint32_t e) const;
+    uint32_t newTrapezoid(const Trapezoid& t);
+    uint32_t pushNode(const Node& n) {
+        nodes_.push_back(n);
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    const vector<Point>& points_;
+    const vector<Segment>& segments_;
+    vector<Node>& nodes_;
+    vector<Trapezoid> traps_;
+};
+
+uint32_t Builder::newTrapezoid(const Trapezoid& t) {
+    traps_.push_back(t);
+    const auto id = static_cast<uint32_t>(traps_.size() - 1);
+    traps_[id].node = pushNode(Node{LEAF, id, NONE, NONE});
+    return id;
+}
+
+// Whether segment s can lie alongside segment e (NONE = no segment) in a
+// planar map: they meet at most at a shared endpoint and do not overlap
+bool Builder::compatible(uint32_t s, uint32_t e) const {
+    if (e == NONE) return true;
+    const Point& a = point(segments_[s].a);
+    const Point& b = point(segments_[s].b);
+    const Point& c = point(segments_[e].a);
+    const Point& d = point(segments_[e].b);
+    const bool shareA = samePoint(a, c) || samePoint(a, d);
+    const bool shareB = samePoint(b, c) || samePoint(b, d);
+    if (shareA || shareB) {
+        // sharing an endpoint, they overlap only if collinear and pointing the same way from it
+        const Point& shared = shareA ? a : b;
+        const Point& sOther = shareA ? b : a;
+        const Point& eOther = samePoint(shared, c) ? d : c;
+        if (orient(shared, sOther, eOther) != 0) return true;
+        return (sOther.lon - shared.lon) * (eOther.lon - shared.lon) +
+            (sOther.lat - shared.lat) * (eOther.lat - shared.lat) < 0;
+    }
+    const double o1 = orient(a, b, c), o2 = orient(a, b, d);
+    const double o3 = orient(c, d, a), o4 = orient(c, d, b);
+    // an endpoint of one touching the other
+    if ((o1 == 0 && withinSegment(a, b, c)) || (o2 == 0 && withinSegment(a, b, d)) ||
+        (o3 == 0 && withinSegment(c, d, a)) || (o4 == 0 && withinSegment(c, d, b))) return false;
+    return !(o1 != 0 && o2 != 0 && o3 != 0 && o4 != 0 && (o1 > 0) != (o2 > 0) && (o3 > 0) != (o4 > 0));
+}
+
+// Adds segment s, splitting the trapezoids it passes through and replacing
+// their leaves with the nodes that tell the new pieces apart
+//
+// Args:
+//    s: the segment
+// Returns:
+//    false (with nothing changed) if s crosses, touches or overlaps a segment already in the map
+bool Builder::insert(uint32_t s) {
+    const uint32_t sa = segments_[s].a, sb = segments_[s].b;
+    const Point& left = point(sa);
+    const Point& right = point(sb);
+
+    // the trapezoid just right of s's left endpoint, on s's side of any segment leaving it
+    uint32_t n = 0;
+    while (nodes_[n].kind != LEAF) {
+        const Node& node = nodes_[n];
+        if (node.kind == X_NODE) {
+            n = lexLess(left, point(node.index)) ? node.left : node.right;
+            continue;
+        }
+        double o = orientSeg(node.index, left);
+        if (o == 0) {
+            if (segments_[node.index].a != sa) return false;
+            o = orientSeg(node.index, right);
+            if (o == 0) return false;
+        }
+        n = o > 0 ? node.left : node.right;
+    }
+
+    // follow s rightwards through the trapezoids it crosses
+    vector<uint32_t> crossed{nodes_[n].index};
+    while (true) {
+        const Trapezoid& t = traps_[crossed.back()];
+        if (!compatible(s, t.top) || !compatible(s, t.bottom)) return false;
+        if (t.rightp == NONE || !lexLess(point(t.rightp), right)) break;
+        const double o = orientSeg(s, point(t.rightp));
+        if (o == 0) return false;
+        const uint32_t next = o > 0 ? t.lowerRight : t.upperRight;
+        if (next == NONE) return false;
+        crossed.push_back(next);
+    }
+
+    // relinks neighbour pointers that pointed at a replaced trapezoid
+    auto setUpperLeft = [&](uint32_t t, uint32_t u) {
+        traps_[t].upperLeft = u;
+        if (u != NONE) traps_[u].upperRight = t;
+    };
+    auto setLowerLeft = [&](uint32_t t, uint32_t u) {
+        traps_[t].lowerLeft = u;
+        if (u != NONE) traps_[u].lowerRight = t;
+    };
+    auto setUpperRight = [&](uint32_t t, uint32_t u) {
+        traps_[t].upperRight = u;
+        if (u != NONE) traps_[u].upperLeft = t;
+    };
+    auto setLowerRight = [&](uint32_t t, uint32_t u) {
+        traps_[t].lowerRight = u;
+        if (u != NONE) traps_[u].lowerLeft = t;
+    };
+
+    // left end: the part left of s's endpoint, then the pieces above and below s
+    const Trapezoid first = traps_[crossed.front()];
+    uint32_t leftPart = NONE;
+    if (first.leftp != sa) {
+        leftPart = newTrapezoid(Trapezoid{first.top, first.bottom, first.leftp, sa});
+        setUpperLeft(leftPart, first.upperLeft);
+        setLowerLeft(leftPart, first.lowerLeft);
+    }
+    uint32_t above = newTrapezoid(Trapezoid{first.top, s, sa, NONE});
+    uint32_t below = newTrapezoid(Trapezoid{s, first.bottom, sa, NONE});
+    if (leftPart != NONE) {
+        setUpperRight(leftPart, above);
+        setLowerRight(leftPart, below);
+    } else {
+        setUpperLeft(above, first.upperLeft);
+        setLowerLeft(below, first.lowerLeft);
+    }
+    vector<uint32_t> aboveOf{above}, belowOf{below};
+
+    // the walls s passes are cut at s: the side away from the wall's point merges
+    for (size_t i = 1; i < crossed.size(); ++i) {
+        const Trapezoid prev = traps_[crossed[i - 1]];
+        const Trapezoid cur = traps_[crossed[i]];
+        const uint32_t q = prev.rightp;
+        if (orientSeg(s, point(q)) > 0) {
+            traps_[above].rightp = q;
+            const uint32_t next = newTrapezoid(Trapezoid{cur.top, s, q, NONE});
+            setLowerRight(above, next);
+            setUpperRight(above, prev.upperRight);
+            setUpperLeft(next, cur.upperLeft);
+            above = next;
+        } else {
+            traps_[below].rightp = q;
+            const uint32_t next = newTrapezoid(Trapezoid{s, cur.bottom, q, NONE});
+            setUpperRight(below, next);
+            setLowerRight(below, prev.lowerRight);
+            setLowerLeft(next, cur.lowerLeft);
+            below = next;
+        }
+        aboveOf.push_back(above);
+        belowOf.push_back(below);
+    }
+
+    // right end
+    const Trapezoid last = traps_[crossed.back()];
+    traps_[above].rightp = sb;
+    traps_[below].rightp = sb;
+    uint32_t rightPart = NONE;
+    if (last.rightp != sb) {
+        rightPart = newTrapezoid(Trapezoid{last.top, last.bottom, sb, last.rightp});
+        setUpperRight(rightPart, last.upperRight);
+        setLowerRight(rightPart, last.lowerRight);
+        setUpperLeft(rightPart, above);
+        setLowerLeft(rightPart, below);
+    } else {
+        setUpperRight(above, last.upperRight);
+        setLowerRight(below, last.lowerRight);
+    }
+
+    // each replaced leaf becomes Y(s), under X(left) and X(right) at the ends
+    for (size_t i = 0; i < crossed.size(); ++i) {
+        const uint32_t leaf = traps_[crossed[i]].node;
+        traps_[crossed[i]].node = NONE;
+        Node top{Y_NODE, s, traps_[aboveOf[i]].node, traps_[belowOf[i]].node};
+        if (i + 1 == crossed.size() && rightPart != NONE)
+            top = Node{X_NODE, sb, pushNode(top), traps_[rightPart].node};
+        if (i == 0 && leftPart != NONE)
+            top = Node{X_NODE, sa, traps_[leftPart].node, pushNode(top)};
+        nodes_[leaf] = top;
+    }
+    return true;
+}
+
+}  // namespace
+
+// Identifies suburb geometry down to every vertex, so a saved map is only
+// used with the exact boundaries it was built from
+//
+// Args:
+//    suburbs: the loaded suburbs
+// Returns:
+//    64-bit fingerprint
+uint64_t geometryFingerprint(const vector<Suburb>& suburbs) {
+    uint64_t h = 14695981039346656037ULL;
+    const uint64_t count = suburbs.size();
+    fnv(&h, &count, sizeof(count));
+    for (const auto& s : suburbs) {
+        const uint64_t polys = s.polys.size();
+        fnv(&h, &polys, sizeof(polys));
+        for (const auto& poly : s.polys) {
+            const uint64_t rings = poly.rings.size();
+            fnv(&h, &rings, sizeof(rings));
+            for (const auto& ring : poly.rings) {
+                const uint64_t n = ring.points.size();
+                fnv(&h, &n, sizeof(n));
+                fnv(&h, ring.points.data(), n * sizeof(Point));
+            }
+        }
+    }
+    return h;
+}
+
+// Builds the map over every ring edge of every suburb (shared edges once)
+//
+// Args:
+//    suburbs: the loaded suburbs
+//    grid: a grid over the same suburbs, used to label each trapezoid
+//    seed: insertion order shuffle; any seed gives the same answers
+TrapezoidMap::TrapezoidMap(const vector<Suburb>& suburbs, const SuburbGrid& grid, uint64_t seed)
+    : fingerprint_(geometryFingerprint(suburbs)) {
+    // unique vertices, then each ring edge (closing edge included, as pointInRing does) by vertex ids
+    for (const auto& s : suburbs) {
+        for (const auto& poly : s.polys) {
+            for (const auto& ring : poly.rings) points_.insert(points_.end(), ring.points.begin(), ring.points.end());
+        }
+    }
+    std::sort(points_.begin(), points_.end(), lexLess);
+    points_.erase(std::unique(points_.begin(), points_.end(), samePoint), points_.end());
+    auto vertexId = [&](const Point& p) {
+        return static_cast<uint32_t>(std::lower_bound(points_.begin(), points_.end(), p, lexLess) - points_.begin());
+    };
+    vector<std::pair<uint32_t, uint32_t>> edges;
+    for (const auto& s : suburbs) {
+        for (const auto& poly : s.polys) {
+            for (const auto& ring : poly.rings) {
+                const size_t n = ring.points.size();
+                for (size_t i = 0; i < n; ++i) {
+                    const uint32_t a = vertexId(ring.points[i]), b = vertexId(ring.points[(i + 1) % n]);
+                    if (a != b) edges.emplace_back(std::min(a, b), std::max(a, b));
+                }
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    for (const auto& e : edges) segments_.push_back(Segment{e.first, e.second});
+
+    vector<uint32_t> order(segments_.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    std::mt19937_64 rng(seed);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    Builder builder(points_, segments_, &nodes_);
+    vector<uint32_t> skipped;
+    for (uint32_t s : order) {
+        if (!builder.insert(s)) skipped.push_back(s);
+    }
+    skipped_ = skipped.size();
+
+    // label each trapezoid by a point well inside it; thin ones and those a
+    // skipped segment may pass through are left to the caller
+    std::sort(skipped.begin(), skipped.end(), [&](uint32_t x, uint32_t y) {
+        return points_[segments_[x].a].lon < points_[segments_[y].a].lon;
+    });
+    for (const Trapezoid& t : builder.trapezoids()) {
+        if (t.node == NONE) continue;
+        uint32_t label = NO_SUBURB;
+        double minLon = -HUGE_VAL, maxLon = HUGE_VAL, minLat = -HUGE_VAL, maxLat = HUGE_VAL;
+        if (t.leftp != NONE) minLon = points_[t.leftp].lon;
+        if (t.rightp != NONE) maxLon = points_[t.rightp].lon;
+        if (t.top != NONE && t.bottom != NONE && t.leftp != NONE && t.rightp != NONE) {
+            const Point& ta = points_[segments_[t.top].a];
+            const Point& tb = points_[segments_[t.top].b];
+            const Point& ba = points_[segments_[t.bottom].a];
+            const Point& bb = points_[segments_[t.bottom].b];
+            const double x = (minLon + maxLon) / 2;
+            const double yTop = latAt(ta, tb, x), yBottom = latAt(ba, bb, x);
+            const Point sample{x, (yTop + yBottom) / 2};
+            maxLat = std::max(latAt(ta, tb, minLon), latAt(ta, tb, maxLon));
+            minLat = std::min(latAt(ba, bb, minLon), latAt(ba, bb, maxLon));
+            if (maxLon - minLon <= 4 * TRAPEZOID_EPSILON || yTop - yBottom <= 4 * TRAPEZOID_EPSILON ||
+                pointSegmentDegrees(sample, ta, tb) <= 2 * TRAPEZOID_EPSILON ||
+                pointSegmentDegrees(sample, ba, bb) <= 2 * TRAPEZOID_EPSILON) {
+                label = AMBIGUOUS;
+            } else {
+                label = grid.locate(sample);
+            }
+        }
+        for (uint32_t s : skipped) {
+            const Point& a = points_[segments_[s].a];
+            const Point& b = points_[segments_[s].b];
+            if (a.lon > maxLon + TRAPEZOID_EPSILON) break;
+            if (b.lon >= minLon - TRAPEZOID_EPSILON && std::max(a.lat, b.lat) >= minLat - TRAPEZOID_EPSILON &&
+                std::min(a.lat, b.lat) <= maxLat + TRAPEZOID_EPSILON) {
+                label = AMBIGUOUS;
+                break;
+            }
+        }
+        if (label == AMBIGUOUS) ++ambiguousLeaves_;
+        nodes_[t.node].index = label;
+    }
+}
+
+// Finds the suburb containing point
+//
+// Args:
+//    point: the point lat/lon to locate
+//    outSteps: if not null, set to the number of DAG nodes visited
+// Returns:
+//    id of the lowest-id suburb containing point, NO_SUBURB, or AMBIGUOUS if
+//    point is too close to an edge or vertex to say
+uint32_t TrapezoidMap::locate(const Point& point, size_t* outSteps) const {
+    uint32_t n = 0;
+    size_t steps = 1;
+    uint32_t result = AMBIGUOUS;
+    while (true) {
+        const Node& node = nodes_[n];
+        if (node.kind == LEAF) {
+            result = node.index;
+            break;
+        }
+        ++steps;
+        if (node.kind == X_NODE) {
+            const double dx = point.lon - points_[node.index].lon;
+            if (std::fabs(dx) <= TRAPEZOID_EPSILON) break;
+            n = dx < 0 ? node.left : node.right;
+        } else {
+            const Point& a = points_[segments_[node.index].a];
+            const Point& b = points_[segments_[node.index].b];
+            const double o = orient(a, b, point);
+            // |o| / |ab| is the distance to the edge's line; |dx| + |dy| >= |ab|
+            if (std::fabs(o) <= TRAPEZOID_EPSILON * (std::fabs(b.lon - a.lon) + std::fabs(b.lat - a.lat))) break;
+            n = o > 0 ? node.left : node.right;
+        }
+    }
+    if (outSteps) *outSteps = steps;
+    return result;
+}
+
+// Bytes held by the map's points, segments and nodes (vector capacity included)
+size_t TrapezoidMap::memoryBytes() const {
+    return points_.capacity() * sizeof(Point) + segments_.capacity() * sizeof(Segment) +
+        nodes_.capacity() * sizeof(Node);
+}
+
+// Writes the map as a little-endian binary file: magic, version, geometry
+// fingerprint, counts, then the points, segments and nodes as stored
+//
+// Args:
+//    path: the file to write (replaced atomically via a temporary file)
+void TrapezoidMap::save(const string& path) const {
+    const string tmp = path + ".tmp";
+    {
+        ofstream out(tmp, std::ios::binary);
+        if (!out) throw runtime_error("Failed to open trapezoid map for writing: " + tmp);
+        out.write(TRAPEZOID_MAP_MAGIC, 8);
+        writeValue(&out, TRAPEZOID_MAP_VERSION);
+        writeValue(&out, fingerprint_);
+        writeValue(&out, static_cast<uint64_t>(skipped_));
+        writeValue(&out, static_cast<uint64_t>(ambiguousLeaves_));
+        writeVector(&out, points_);
+        writeVector(&out, segments_);
+        writeVector(&out, nodes_);
+        out.close();
+        if (!out) throw runtime_error("Failed to write trapezoid map: " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) throw runtime_error("Failed to replace trapezoid map: " + path);
+}
+
+// Reads a map written by save(), checking it was built from these suburbs
+//
+// Args:
+//    path: the map file
+//    suburbs: the loaded suburbs
+// Returns:
+//    the map
+TrapezoidMap TrapezoidMap::load(const string& path, const vector<Suburb>& suburbs) {
+    ifstream in(path, std::ios::binary);
+    if (!in) throw runtime_error("Failed to open trapezoid map: " + path);
+    char magic[8];
+    in.read(magic, 8);
+    if (!in || std::memcmp(magic, TRAPEZOID_MAP_MAGIC, 8) != 0)
+        throw runtime_error("Not a trapezoid map file: " + path);
+    if (readValue<uint32_t>(&in) != TRAPEZOID_MAP_VERSION)
+        throw runtime_error("Unsupported trapezoid map version: " + path);
+    TrapezoidMap map;
+    map.fingerprint_ = readValue<uint64_t>(&in);
+    if (map.fingerprint_ != geometryFingerprint(suburbs))
+        throw runtime_error("Trapezoid map was built from different suburbs: " + path);
+    map.skipped_ = readValue<uint64_t>(&in);
+    map.ambiguousLeaves_ = readValue<uint64_t>(&in);
+    const uint64_t limit = uint64_t{1} << 32;
+    map.points_ = readVector<Point>(&in, limit);
+    map.segments_ = readVector<Segment>(&in, limit);
+    map.nodes_ = readVector<Node>(&in, limit);
+
+    // every index must be in range and the nodes must form a DAG (as built, every
+    // node is reachable from the root), so a damaged file cannot send locate() astray
+    bool valid = !map.nodes_.empty();
+    for (const auto& s : map.segments_) valid = valid && s.a < map.points_.size() && s.b < map.points_.size();
+    vector<uint32_t> parents(map.nodes_.size(), 0);
+    for (const auto& node : map.nodes_) {
+        if (node.kind == X_NODE) {
+            valid = valid && node.index < map.points_.size();
+        } else if (node.kind == Y_NODE) {
+            valid = valid && node.index < map.segments_.size();
+        } else {
+            valid = valid && node.kind == LEAF && (node.index < suburbs.size() || node.index == NO_SUBURB ||
+                node.index == AMBIGUOUS);
+            continue;
+        }
+        valid = valid && node.left < map.nodes_.size() && node.right < map.nodes_.size();
+        if (!valid) break;
+        ++parents[node.left];
+        ++parents[node.right];
+    }
+    if (valid) {
+        // Kahn's algorithm from the root: a cycle, or a node off the root's DAG, is never reached
+        vector<uint32_t> ready{0};
+        size_t reached = 0;
+        valid = parents[0] == 0;
+        while (valid && !ready.empty()) {
+            const Node& node = map.nodes_[ready.back()];
+            ready.pop_back();
+            ++reached;
+            if (node.kind == LEAF) continue;
+            if (--parents[node.left] == 0) ready.push_back(node.left);
+            if (--parents[node.right] == 0) ready.push_back(node.right);
+        }
+        valid = valid && reached == map.nodes_.size();
+    }
+    if (!valid) throw runtime_error("Corrupt trapezoid map: " + path);
+    return map;
+}
+
+}  // namespace suburb
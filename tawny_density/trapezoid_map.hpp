@@ -0,0 +1,87 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TAWNY_DENSITY_TRAPEZOID_MAP_HPP_
+#define TAWNY_DENSITY_TRAPEZOID_MAP_HPP_
+
+#include <cstddef>          // for size_t
+#include <cstdint>          // for uint32_t, uint64_t
+#include <string>           // for string
+#include <vector>           // for vector
+#include "suburb.hpp"       // for Suburb, Point
+#include "suburb_grid.hpp"  // for SuburbGrid
+
+using std::string;
+using std::vector;
+
+namespace suburb {
+
+const char TRAPEZOID_MAP_MAGIC[] = "TAWNYTM1";
+const uint32_t TRAPEZOID_MAP_VERSION = 1;
+const double TRAPEZOID_EPSILON = 1e-9;  // degrees (~0.1 mm); closer to an edge or vertex is ambiguous
+
+// Point location over every ring edge of every suburb at once: a trapezoidal
+// map built by randomized incremental construction (de Berg et al., ch. 6),
+// searched through its DAG in expected O(log n) steps. Each trapezoid records
+// the lowest-id suburb covering it, so locate() answers without testing any
+// polygon. Points within TRAPEZOID_EPSILON of an edge or of a vertex's
+// vertical, where the ray-casting test's rounding decides the answer, come
+// back AMBIGUOUS, as do trapezoids near edges that cross other edges (overlaps
+// the planar map cannot represent); the caller then asks the grid.
+class TrapezoidMap {
+ public:
+    static const uint32_t AMBIGUOUS = 0xFFFFFFFE;
+
+    TrapezoidMap(const vector<Suburb>& suburbs, const SuburbGrid& grid, uint64_t seed = 0x7a9e2d5c);
+    static TrapezoidMap load(const string& path, const vector<Suburb>& suburbs);
+    void save(const string& path) const;
+
+    uint32_t locate(const Point& point, size_t* outSteps = nullptr) const;
+
+    size_t segments() const { return segments_.size(); }
+    size_t skippedSegments() const { return skipped_; }
+    size_t nodes() const { return nodes_.size(); }
+    size_t ambiguousLeaves() const { return ambiguousLeaves_; }
+    size_t memoryBytes() const;
+
+    // DAG node: X nodes split on a point (left child = lexicographically
+    // smaller), Y nodes on a segment (left child = above), leaves hold a
+    // suburb id, NO_SUBURB or AMBIGUOUS
+    struct Node {
+        uint32_t kind;
+        uint32_t index;
+        uint32_t left, right;
+    };
+
+    // Edge between two points, a lexicographically before b
+    struct Segment {
+        uint32_t a, b;
+    };
+
+ private:
+    TrapezoidMap() = default;
+
+    uint64_t fingerprint_ = 0;
+    vector<Point> points_;
+    vector<Segment> segments_;
+    vector<Node> nodes_;  // nodes_[0] is the root
+    size_t skipped_ = 0;
+    size_t ambiguousLeaves_ = 0;
+};
+
+uint64_t geometryFingerprint(const vector<Suburb>& suburbs);
+
+}  // namespace suburb
+
+#endif  // TAWNY_DENSITY_TRAPEZOID_MAP_HPP_
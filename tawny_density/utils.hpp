@@ -12,70 +12,143 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #pragma once
+#include <algorithm>
 #include <string>
 #include <curl/curl.h>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 #include <cstdint>
+#include "stats.hpp"
 
 using std::string;
 using std::runtime_error;
 
 namespace utils {
 
+// How long each stage of one request took, in seconds (stage durations, not
+// curl's offsets from the start); all zero from clients that do not measure
+struct HttpTimings {
+    double dns = 0;       // name lookup
+    double connect = 0;   // TCP connect, after the lookup
+    double tls = 0;       // TLS handshake, after the connect
+    double ttfb = 0;      // first response byte, after the connection (and TLS) was ready
+    double total = 0;     // whole transfer, from the start
+    uint64_t bytes = 0;   // body bytes downloaded
+    bool reused = false;  // sent over an already open connection
+};
+
 // Simple struct to hold HTTP response data
 struct HttpResponse {
+    HttpResponse() = default;
+    HttpResponse(uint16_t responseStatus, string responseBody)
+        : status(responseStatus), body(std::move(responseBody)) {}
+
     uint16_t status = 0;
     string body;
+    HttpTimings timings;
 };
 
+// Turns curl's offsets from the start of a transfer into stage durations
+//
+// Args:
+//    dns, connect, appConnect, startTransfer, total: curl's *_TIME_T offsets in
+//        microseconds; 0 for stages that did not happen (e.g. on a reused connection)
+// Returns:
+//    the stage durations (bytes and reused are left unset)
+inline HttpTimings stageTimings(int64_t dns, int64_t connect, int64_t appConnect, int64_t startTransfer,
+                                int64_t total) {
+    auto seconds = [](int64_t us) { return static_cast<double>(us) / 1e6; };
+    const int64_t ready = std::max(connect, appConnect);
+    HttpTimings t;
+    t.dns = seconds(dns);
+    t.connect = connect > dns ? seconds(connect - dns) : 0;
+    t.tls = appConnect > connect ? seconds(appConnect - connect) : 0;
+    t.ttfb = startTransfer > ready ? seconds(startTransfer - ready) : 0;
+    t.total = seconds(total);
+    return t;
+}
+
+// Adds one request's timings to the registry's http_* histograms and
+// connection counters
+//
+// Args:
+//    t: the request's timings
+//    registry: where to record them
+inline void recordHttpTimings(const HttpTimings& t, stats::Registry* registry) {
+    registry->record("http_dns_seconds", t.dns);
+    registry->record("http_connect_seconds", t.connect);
+    registry->record("http_tls_seconds", t.tls);
+    registry->record("http_ttfb_seconds", t.ttfb);
+    registry->record("http_total_seconds", t.total);
+    registry->record("http_download_bytes", static_cast<double>(t.bytes));
+    registry->add(t.reused ? "http_connections_reused" : "http_connections_new");
+}
+
 // Interface for HTTP client (allows mocking in tests)
 struct IHttpClient {
     virtual ~IHttpClient() = default;
     virtual HttpResponse get(const string& url) = 0;
 };
 
-// Concrete implementation of IHttpClient using libcurl
+// Concrete implementation of IHttpClient using libcurl. Easy handles are
+// pooled and reused, so each keeps its connection (and DNS and TLS session)
+// alive between requests; get() may be called from several threads at once.
+// Every request's timings are recorded in a stats registry.
 class CurlHttpClient : public IHttpClient {
  public:
     // Constructor initializes libcurl
-    CurlHttpClient() {
+    //
+    // Args:
+    //    registry: where request timings are recorded
+    explicit CurlHttpClient(stats::Registry* registry = &stats::global()) : registry_(registry) {
         curl_global_init(CURL_GLOBAL_DEFAULT);
     }
 
-    // Destructor cleans up libcurl resources
+    // Destructor closes the pooled handles and cleans up libcurl resources
     ~CurlHttpClient() override {
+        for (CURL* curl : idle_) curl_easy_cleanup(curl);
         curl_global_cleanup();
     }
 
+    CurlHttpClient(const CurlHttpClient&) = delete;
+    CurlHttpClient& operator=(const CurlHttpClient&) = delete;
+
     // Performs an HTTP GET request to the specified URL and returns the response
     //
     // Args:
     //    url: the URL to send the GET request to
     // Returns:
-    //    HttpResponse containing the status code and response body
+    //    HttpResponse containing the status code, response body and timings
     HttpResponse get(const string& url) override {
         HttpResponse resp;
         string buffer;
 
-        CURL* curl = curl_easy_init();
-        if (!curl) throw runtime_error("curl_easy_init failed");
-
+        CURL* curl = acquire();
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
         curl_easy_setopt(curl, CURLOPT_USERAGENT, "tawny-density");
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
 
         CURLcode res = curl_easy_perform(curl);
         if (res != CURLE_OK) {
-            curl_easy_cleanup(curl);
+            // a timed-out or refused transfer still shows where the time went
+            recordHttpTimings(timings(curl), registry_);
+            release(curl);
+            registry_->add("http_transport_errors");
             throw runtime_error(curl_easy_strerror(res));
         }
 
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &resp.status);
-        curl_easy_cleanup(curl);
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        resp.status = static_cast<uint16_t>(status);
+        resp.timings = timings(curl);
+        release(curl);
+        recordHttpTimings(resp.timings, registry_);
 
         resp.body = std::move(buffer);
         return resp;
@@ -97,6 +170,49 @@ class CurlHttpClient : public IHttpClient {
         out->append(static_cast<char*>(contents), total);
         return total;
     }
+
+    // An idle pooled handle, or a new one if none is idle
+    CURL* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!idle_.empty()) {
+                CURL* curl = idle_.back();
+                idle_.pop_back();
+                return curl;
+            }
+        }
+        CURL* curl = curl_easy_init();
+        if (!curl) throw runtime_error("curl_easy_init failed");
+        return curl;
+    }
+
+    // Returns a handle (and its open connection) to the pool
+    void release(CURL* curl) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        idle_.push_back(curl);
+    }
+
+    // Stage durations of the handle's last transfer
+    static HttpTimings timings(CURL* curl) {
+        curl_off_t dns = 0, connect = 0, tls = 0, ttfb = 0, total = 0, bytes = 0;
+        long connects = 0;
+        curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+        curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &tls);
+        curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &ttfb);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+        curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+
+        HttpTimings t = stageTimings(dns, connect, tls, ttfb, total);
+        t.bytes = static_cast<uint64_t>(bytes);
+        t.reused = connects == 0;
+        return t;
+    }
+
+    stats::Registry* registry_;
+    std::mutex mtx_;
+    std::vector<CURL*> idle_;
 };
 
 }  // namespace utils
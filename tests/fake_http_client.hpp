@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #pragma once
+#include <functional>
+#include <mutex>
 #include <string>
+#include <vector>
 #include "../tawny_density/utils.hpp"
 
 struct FakeHttpClient : public utils::IHttpClient {
@@ -22,3 +25,19 @@ struct FakeHttpClient : public utils::IHttpClient {
         return next;
     }
 };
+
+// Fake client that answers each url through a handler and records the urls
+// requested; safe to call from several threads.
+struct RoutingHttpClient : public utils::IHttpClient {
+    std::function<utils::HttpResponse(const std::string&)> handler;
+    std::vector<std::string> urls;
+    std::mutex mtx;
+
+    utils::HttpResponse get(const std::string& url) override {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            urls.push_back(url);
+        }
+        return handler(url);
+    }
+};
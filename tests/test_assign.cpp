@@ -0,0 +1,120 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../tawny_density/assign.hpp"
+#include "test_geometry.hpp"
+
+using std::string;
+using std::vector;
+
+using assign::assignPoints;
+using assign::AssignStats;
+using assign::detectLayout;
+using assign::parseRow;
+using assign::RowLayout;
+using csv::CsvWriter;
+using suburb::Point;
+using suburb::SuburbIndex;
+
+// Parses a row held in a string
+static bool parse(const string& row, const RowLayout& layout, Point* out) {
+    return parseRow(row.data(), row.data() + row.size(), layout, out);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for detectLayout and parseRow
+// -----------------------------------------------------------------------------
+
+TEST_CASE("detectLayout finds coordinate columns by header name") {
+    RowLayout layout;
+    CHECK_FALSE(detectLayout("144.9,-37.8", &layout));
+    CHECK_EQ(layout.delimiter, ',');
+    CHECK_EQ(layout.lonColumn, 0);
+    CHECK_EQ(layout.latColumn, 1);
+
+    CHECK(detectLayout("id,\"Latitude\",Longitude,count", &layout));
+    CHECK_EQ(layout.lonColumn, 2);
+    CHECK_EQ(layout.latColumn, 1);
+
+    // eBird style: tab separated, upper case
+    CHECK(detectLayout("GLOBAL UNIQUE IDENTIFIER\tCOMMON NAME\tLATITUDE\tLONGITUDE", &layout));
+    CHECK_EQ(layout.delimiter, '\t');
+    CHECK_EQ(layout.lonColumn, 3);
+    CHECK_EQ(layout.latColumn, 2);
+
+    CHECK_THROWS(detectLayout("name,when", &layout));
+}
+
+TEST_CASE("parseRow reads the chosen columns and rejects bad rows") {
+    RowLayout layout;
+    layout.lonColumn = 2;
+    layout.latColumn = 1;
+    Point p;
+    CHECK(parse("x, -37.8 ,\"144.9\",more", layout, &p));
+    CHECK_EQ(p.lon, 144.9);
+    CHECK_EQ(p.lat, -37.8);
+
+    CHECK_FALSE(parse("x,-37.8", layout, &p));
+    CHECK_FALSE(parse("x,,144.9", layout, &p));
+    CHECK_FALSE(parse("x,-37.8,abc", layout, &p));
+    CHECK_FALSE(parse("x,-137.8,144.9", layout, &p));
+}
+
+// -----------------------------------------------------------------------------
+// Tests for assignPoints
+// -----------------------------------------------------------------------------
+
+TEST_CASE("assignPoints counts rows across chunk boundaries for any thread count") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    std::ostringstream text;
+    text << "lat,lon\n";
+    for (int i = 0; i < 1000; ++i) text << "5," << (i % 3 == 0 ? "15" : "5") << "\r\n";
+    text << "\n" << "5,50\n" << "bad row\n" << "5,15";  // blank, outside, malformed, unterminated
+
+    for (unsigned threads : {1u, 3u}) {
+        std::istringstream in(text.str());
+        vector<uint64_t> counts;
+        const AssignStats stats = assignPoints(in, index, threads, &counts, nullptr, 64);
+        CHECK_EQ(stats.rows, 1003);
+        CHECK_EQ(stats.assigned, 1001);
+        CHECK_EQ(stats.skipped, 1);
+        CHECK_EQ(counts, vector<uint64_t>{666, 335});
+    }
+}
+
+TEST_CASE("assignPoints writes one id per data row in input order") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    const string path = "tawny_test_assign_ids.csv";
+    {
+        std::istringstream in("5 ,5\n15,5\n\n50,50\n5,5\n");
+        vector<uint64_t> counts;
+        CsvWriter ids(path);
+        assignPoints(in, index, 2, &counts, &ids, 8);
+        ids.close();
+    }
+    std::ifstream file(path);
+    std::stringstream written;
+    written << file.rdbuf();
+    CHECK_EQ(written.str(), "0\n1\n\n0\n");
+    std::remove(path.c_str());
+}
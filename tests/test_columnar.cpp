@@ -0,0 +1,87 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../tawny_density/columnar.hpp"
+
+using std::string;
+using std::vector;
+
+using columnar::writeSeriesArrow;
+using counts::CountMatrix;
+using suburb::Suburb;
+
+// Reads a whole file into bytes
+static vector<uint8_t> readBytes(const string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// True if needle appears in haystack at an offset that is a multiple of alignment
+static bool containsAligned(const vector<uint8_t>& haystack, const void* needle, size_t size, size_t alignment) {
+    for (size_t pos = 0; pos + size <= haystack.size(); pos += alignment) {
+        if (std::memcmp(haystack.data() + pos, needle, size) == 0) return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// Tests for writeSeriesArrow
+// -----------------------------------------------------------------------------
+
+TEST_CASE("writeSeriesArrow writes an Arrow IPC file with aligned column buffers") {
+    const string path = "tawny_test_series.arrow";
+    vector<Suburb> suburbs(3);
+    suburbs[0].name = "ALPHA";
+    suburbs[1].name = "BETA";
+    suburbs[2].name = "GAMMA";
+    CountMatrix m(3, 20332, 20345, 7);
+    m.add(2, 20332, 11);
+    m.add(0, 20340, 7);
+
+    writeSeriesArrow(path, suburbs, m, {0, 1, 2});
+    const auto bytes = readBytes(path);
+    std::remove(path.c_str());
+
+    REQUIRE(bytes.size() > 64);
+    CHECK_EQ(bytes.size() % 2, 0);
+    CHECK_EQ(string(bytes.begin(), bytes.begin() + 6), "ARROW1");
+    CHECK_EQ(string(bytes.end() - 6, bytes.end()), "ARROW1");
+
+    // footer length precedes the trailing magic and points back inside the file
+    int32_t footerSize = 0;
+    std::memcpy(&footerSize, bytes.data() + bytes.size() - 10, 4);
+    CHECK(footerSize > 0);
+    CHECK(static_cast<size_t>(footerSize) < bytes.size());
+
+    // the first message is the schema, after the 8 byte file header
+    uint32_t continuation = 0;
+    std::memcpy(&continuation, bytes.data() + 8, 4);
+    CHECK_EQ(continuation, 0xFFFFFFFF);
+
+    // rows are ALPHA's two weeks then GAMMA's two weeks
+    const uint64_t counts[4] = {0, 7, 11, 0};
+    const int32_t starts[4] = {20332, 20339, 20332, 20339};
+    const uint32_t ids[4] = {0, 0, 2, 2};
+    CHECK(containsAligned(bytes, counts, sizeof(counts), 64));
+    CHECK(containsAligned(bytes, starts, sizeof(starts), 64));
+    CHECK(containsAligned(bytes, ids, sizeof(ids), 64));
+    CHECK(containsAligned(bytes, "ALPHABETAGAMMA", 14, 64));
+}
@@ -0,0 +1,136 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <vector>
+#include "../tawny_density/counts.hpp"
+#include "test_geometry.hpp"
+
+using std::vector;
+
+using counts::CountMatrix;
+using counts::countObservations;
+using counts::CountStats;
+using suburb::SuburbIndex;
+using observations::ObsPoint;
+using suburb::Point;
+using suburb::Suburb;
+
+// -----------------------------------------------------------------------------
+// Tests for CountMatrix
+// -----------------------------------------------------------------------------
+
+TEST_CASE("CountMatrix sizes buckets to cover the day range") {
+    CountMatrix weekly(3, 100, 120, 7);
+    CHECK_EQ(weekly.suburbs(), 3);
+    CHECK_EQ(weekly.buckets(), 3);
+    CHECK_EQ(weekly.bucketStart(2), 114);
+
+    CountMatrix daily(3, 100, 100, 1);
+    CHECK_EQ(daily.buckets(), 1);
+
+    CHECK_THROWS(CountMatrix(3, 100, 99, 7));
+    CHECK_THROWS(CountMatrix(3, 100, 120, 0));
+}
+
+TEST_CASE("CountMatrix add places days in buckets and rejects days out of range") {
+    CountMatrix m(2, 100, 120, 7);
+
+    CHECK(m.add(0, 100));
+    CHECK(m.add(0, 106));
+    CHECK(m.add(1, 107, 5));
+    CHECK(m.add(1, 120));
+    CHECK_FALSE(m.add(1, 99));
+    CHECK_FALSE(m.add(1, 121));
+
+    CHECK_EQ(m.at(0, 0), 2);
+    CHECK_EQ(m.at(1, 1), 5);
+    CHECK_EQ(m.at(1, 2), 1);
+    CHECK_EQ(m.row(1)[1], 5);
+}
+
+TEST_CASE("CountMatrix merge and totals") {
+    CountMatrix a(2, 0, 13, 7), b(2, 0, 13, 7);
+    a.add(0, 1);
+    b.add(0, 8);
+    b.add(1, 2, 3);
+
+    a.merge(b);
+    auto totals = a.totals();
+
+    CHECK_EQ(a.at(0, 0), 1);
+    CHECK_EQ(a.at(0, 1), 1);
+    CHECK_EQ(totals[0], 2);
+    CHECK_EQ(totals[1], 3);
+    CHECK_THROWS(a.merge(CountMatrix(2, 0, 13, 1)));
+}
+
+// -----------------------------------------------------------------------------
+// Tests for countObservations
+// -----------------------------------------------------------------------------
+
+TEST_CASE("countObservations assigns and buckets in one pass for any thread count") {
+    vector<Suburb> suburbs{ squareSuburb(0, 0, 10), squareSuburb(10, 0, 10) };
+
+    vector<ObsPoint> obs;
+    for (int i = 0; i < 100; ++i) {
+        ObsPoint p;
+        p.lon = (i % 2 == 0) ? 5.0 : 15.0;
+        p.lat = 5.0;
+        p.day = (i < 50) ? 0 : 10;
+        obs.push_back(p);
+    }
+    obs.push_back(ObsPoint{50.0, 50.0});  // outside every suburb
+    obs.push_back(ObsPoint{5.0, 5.0});    // inside, but no date
+
+    const SuburbIndex index(suburbs);
+    for (unsigned threads : {1u, 4u}) {
+        CountStats stats;
+        auto m = countObservations(index, obs, 0, 13, 7, threads, &stats);
+
+        CHECK_EQ(stats.assigned, 100);
+        CHECK_EQ(stats.undated, 1);
+        CHECK_EQ(stats.nearest, 0);
+        CHECK_EQ(m.buckets(), 2);
+        CHECK_EQ(m.at(0, 0) + m.at(0, 1), 50);
+        CHECK_EQ(m.totals()[1], 50);
+        // the first half of the points fall in the first week
+        CHECK_EQ(m.at(0, 0), 25);
+    }
+}
+
+TEST_CASE("countObservations falls back to the nearest suburb within the threshold") {
+    vector<Suburb> suburbs{ squareSuburb(0, 0, 0.01), squareSuburb(0.01, 0, 0.01) };
+    const SuburbIndex index(suburbs);
+
+    vector<ObsPoint> obs(3);
+    obs[0].lon = 0.005; obs[0].lat = 0.005;    // inside WEST
+    obs[1].lon = 0.025; obs[1].lat = 0.005;    // ~550 m east of EAST
+    obs[2].lon = 0.005; obs[2].lat = -0.0005;  // ~56 m south of WEST
+    for (auto& p : obs) p.day = 0;
+
+    CountStats stats;
+    auto off = countObservations(index, obs, 0, 6, 7, 1, &stats);
+    CHECK_EQ(stats.assigned, 1);
+    CHECK_EQ(off.totals(), vector<uint64_t>{1, 0});
+
+    auto near = countObservations(index, obs, 0, 6, 7, 2, &stats, 100);
+    CHECK_EQ(stats.assigned, 2);
+    CHECK_EQ(stats.nearest, 1);
+    CHECK_EQ(near.totals(), vector<uint64_t>{2, 0});
+
+    countObservations(index, obs, 0, 6, 7, 1, &stats, 1000);
+    CHECK_EQ(stats.assigned, 3);
+    CHECK_EQ(stats.nearest, 2);
+}
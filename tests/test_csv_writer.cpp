@@ -0,0 +1,141 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../tawny_density/csv_writer.hpp"
+
+using std::string;
+using std::vector;
+
+using csv::CsvWriter;
+using csv::writeCountsCsv;
+using csv::writeSeriesCsv;
+using csv::writeWeightedCsv;
+using counts::CountMatrix;
+using suburb::Suburb;
+
+// Reads a whole file into a string
+static string slurp(const string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// Temporary file path removed when the test ends
+struct TempPath {
+    string path;
+    explicit TempPath(const string& name) : path("tawny_test_" + name) {}
+    ~TempPath() { std::remove(path.c_str()); }
+};
+
+// -----------------------------------------------------------------------------
+// Tests for CsvWriter
+// -----------------------------------------------------------------------------
+
+TEST_CASE("CsvWriter quotes text and escapes embedded quotes") {
+    TempPath tmp("quotes.csv");
+    {
+        CsvWriter out(tmp.path);
+        out.raw("a").raw("b").endRow();
+        out.text("ST KILDA, EAST").text("THE \"GAP\"").endRow();
+        out.text("").integer(0).endRow();
+    }
+    CHECK_EQ(slurp(tmp.path), "a,b\n\"ST KILDA, EAST\",\"THE \"\"GAP\"\"\"\n\"\",0\n");
+}
+
+TEST_CASE("CsvWriter formats integers and survives many buffer flushes") {
+    TempPath tmp("flush.csv");
+    std::ostringstream expected;
+    {
+        CsvWriter out(tmp.path, 64);
+        for (uint64_t i = 0; i < 1000; ++i) {
+            out.integer(i * 1000003).integer(UINT64_MAX - i).endRow();
+            expected << i * 1000003 << "," << UINT64_MAX - i << "\n";
+        }
+        out.text(string(300, 'x')).endRow();  // field larger than the buffer
+        expected << "\"" << string(300, 'x') << "\"\n";
+        out.close();
+    }
+    CHECK_EQ(slurp(tmp.path), expected.str());
+}
+
+TEST_CASE("CsvWriter writes to a stream and leaves it open") {
+    std::ostringstream stream;
+    {
+        CsvWriter out(stream, 64);
+        for (int i = 0; i < 20; ++i) out.text("row").integer(static_cast<uint64_t>(i)).endRow();
+        out.close();
+    }
+    stream << "after";
+    CHECK_EQ(stream.str().substr(0, 16), "\"row\",0\n\"row\",1\n");
+    CHECK_EQ(stream.str().substr(stream.str().size() - 14), "\"row\",19\nafter");
+}
+
+TEST_CASE("CsvWriter throws when the file cannot be opened") {
+    CHECK_THROWS(CsvWriter("/nonexistent-dir/counts.csv"));
+}
+
+// -----------------------------------------------------------------------------
+// Tests for writeCountsCsv and writeSeriesCsv
+// -----------------------------------------------------------------------------
+
+TEST_CASE("writeCountsCsv writes non-zero suburbs in the given order") {
+    TempPath tmp("counts.csv");
+    vector<Suburb> suburbs(3);
+    suburbs[0].name = "ALPHA";
+    suburbs[1].name = "BETA";
+    suburbs[2].name = "GAMMA";
+
+    writeCountsCsv(tmp.path, suburbs, {4, 0, 9}, {2, 1, 0});
+
+    CHECK_EQ(slurp(tmp.path), "suburb_id,suburb,count\n2,\"GAMMA\",9\n0,\"ALPHA\",4\n");
+
+    std::ostringstream stream;
+    writeCountsCsv(stream, suburbs, {4, 0, 9}, {2, 1, 0});
+    CHECK_EQ(stream.str(), slurp(tmp.path));
+}
+
+TEST_CASE("writeWeightedCsv writes counts beside rounded weighted counts") {
+    TempPath tmp("weighted.csv");
+    vector<Suburb> suburbs(3);
+    suburbs[0].name = "ALPHA";
+    suburbs[1].name = "BETA";
+    suburbs[2].name = "GAMMA";
+
+    writeWeightedCsv(tmp.path, suburbs, {1, 0, 0}, {2.0 / 3, 1.0 / 3, 0}, {0, 1, 2});
+
+    CHECK_EQ(slurp(tmp.path), "suburb_id,suburb,count,weighted_count\n0,\"ALPHA\",1,0.666667\n1,\"BETA\",0,0.333333\n");
+}
+
+TEST_CASE("writeSeriesCsv writes every bucket of suburbs with sightings") {
+    TempPath tmp("series.csv");
+    vector<Suburb> suburbs(2);
+    suburbs[0].name = "ALPHA";
+    suburbs[1].name = "BETA";
+    CountMatrix m(2, 0, 13, 7);  // 1970-01-01 .. 1970-01-14, weekly
+    m.add(1, 8, 2);
+
+    writeSeriesCsv(tmp.path, suburbs, m, {0, 1});
+
+    CHECK_EQ(slurp(tmp.path),
+        "suburb_id,suburb,bucket_start,count\n"
+        "1,\"BETA\",1970-01-01,0\n"
+        "1,\"BETA\",1970-01-08,2\n");
+}
@@ -0,0 +1,336 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../tawny_density/counts.hpp"
+#include "../tawny_density/suburb.hpp"
+#include "../tawny_density/suburb_grid.hpp"
+#include "../tawny_density/suburb_index.hpp"
+
+// Differential tests: every fast lookup path against the brute-force oracle
+// (pointInSuburb over every suburb in id order) on randomly generated worlds
+// and adversarial points. Set TAWNY_STRESS=N (or run `ctest -C Stress`) to
+// test N times as many worlds.
+
+using std::vector;
+
+using counts::CountStats;
+using observations::ObsPoint;
+using suburb::IndexStrategy;
+using suburb::NO_SUBURB;
+using suburb::Point;
+using suburb::Polygon;
+using suburb::Ring;
+using suburb::Suburb;
+using suburb::SuburbGrid;
+using suburb::SuburbIndex;
+
+namespace {
+
+// Multiplier from TAWNY_STRESS; 1 when unset
+int stressScale() {
+    const char* value = std::getenv("TAWNY_STRESS");
+    const int n = value ? std::atoi(value) : 1;
+    return std::max(1, n);
+}
+
+// The reference answer: the lowest-id suburb whose pointInSuburb is true
+uint32_t oracle(const vector<Suburb>& suburbs, const Point& p) {
+    for (size_t id = 0; id < suburbs.size(); ++id) {
+        if (suburb::pointInSuburb(suburbs[id], p)) return static_cast<uint32_t>(id);
+    }
+    return NO_SUBURB;
+}
+
+// Fills in polygon and suburb bounding boxes over every ring, as the loader does
+void finish(Suburb* s) {
+    s->minLon = s->minLat = 1e300;
+    s->maxLon = s->maxLat = -1e300;
+    for (auto& poly : s->polys) {
+        poly.minLon = poly.minLat = 1e300;
+        poly.maxLon = poly.maxLat = -1e300;
+        for (const auto& ring : poly.rings) {
+            double minLon, minLat, maxLon, maxLat;
+            suburb::ringBounds(ring, &minLon, &minLat, &maxLon, &maxLat);
+            poly.minLon = std::min(poly.minLon, minLon);
+            poly.minLat = std::min(poly.minLat, minLat);
+            poly.maxLon = std::max(poly.maxLon, maxLon);
+            poly.maxLat = std::max(poly.maxLat, maxLat);
+        }
+        s->minLon = std::min(s->minLon, poly.minLon);
+        s->minLat = std::min(s->minLat, poly.minLat);
+        s->maxLon = std::max(s->maxLon, poly.maxLon);
+        s->maxLat = std::max(s->maxLat, poly.maxLat);
+    }
+}
+
+// Closed star-shaped ring of n vertices around (lon, lat); radii vary in [0.5, 1] * radius
+Ring starRing(std::mt19937_64& rng, size_t n, double lon, double lat, double radius) {
+    std::uniform_real_distribution<double> unit(0, 1);
+    Ring ring;
+    for (size_t i = 0; i < n; ++i) {
+        const double t = 6.283185307179586 * (i + 0.8 * unit(rng)) / n;
+        const double r = radius * (0.5 + 0.5 * unit(rng));
+        ring.points.push_back(Point{lon + r * std::cos(t), lat + r * std::sin(t)});
+    }
+    ring.points.push_back(ring.points.front());
+    return ring;
+}
+
+// Random overlapping suburbs: star polygons of 3 to ~2000 vertices, some with
+// holes, some MultiPolygons, some sharing exact vertex coordinates, plus an
+// empty suburb
+vector<Suburb> randomWorld(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::uniform_int_distribution<int> count(5, 40);
+    vector<Suburb> suburbs(static_cast<size_t>(count(rng)));
+    for (auto& s : suburbs) {
+        const int parts = unit(rng) < 0.2 ? 2 + static_cast<int>(3 * unit(rng)) : 1;
+        for (int k = 0; k < parts; ++k) {
+            const double lon = 145 + unit(rng), lat = -38 + unit(rng);
+            const double radius = 0.02 + 0.2 * unit(rng);
+            const double u = unit(rng);
+            const size_t n = u < 0.3 ? 3 + static_cast<size_t>(5 * unit(rng))
+                : u < 0.95 ? 8 + static_cast<size_t>(200 * unit(rng)) : 2000;
+            Polygon poly;
+            poly.rings.push_back(starRing(rng, n, lon, lat, radius));
+            // with 8+ vertices every edge stays beyond 0.38 * radius, so a 0.3 * radius hole fits inside
+            if (n >= 8 && unit(rng) < 0.3) poly.rings.push_back(starRing(rng, 3 + n / 4, lon, lat, radius * 0.3));
+            s.polys.push_back(poly);
+        }
+        finish(&s);
+    }
+    // a suburb reusing another's outer ring exactly: every point on it ties
+    suburbs.push_back(Suburb{});
+    suburbs.back().polys.push_back(Polygon{{suburbs[0].polys[0].rings[0]}});
+    finish(&suburbs.back());
+    suburbs.push_back(Suburb{});  // no polygons
+    return suburbs;
+}
+
+// A cols x rows tessellation with jittered shared corners, so neighbouring
+// suburbs have identical edges and points on them must resolve the same way
+vector<Suburb> tiledWorld(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> jitter(-0.3, 0.3);
+    const size_t cols = 3 + rng() % 10, rows = 3 + rng() % 10;
+    const double cell = 0.01;
+    vector<Point> corners((cols + 1) * (rows + 1));
+    for (size_t j = 0; j <= rows; ++j) {
+        for (size_t i = 0; i <= cols; ++i) {
+            const bool border = i == 0 || j == 0 || i == cols || j == rows;
+            corners[j * (cols + 1) + i] = Point{145 + cell * (i + (border ? 0 : jitter(rng))),
+                -38 + cell * (j + (border ? 0 : jitter(rng)))};
+        }
+    }
+    vector<Suburb> suburbs;
+    for (size_t j = 0; j < rows; ++j) {
+        for (size_t i = 0; i < cols; ++i) {
+            Ring ring;
+            ring.points = {corners[j * (cols + 1) + i], corners[j * (cols + 1) + i + 1],
+                corners[(j + 1) * (cols + 1) + i + 1], corners[(j + 1) * (cols + 1) + i],
+                corners[j * (cols + 1) + i]};
+            Suburb s;
+            s.polys.push_back(Polygon{{ring}});
+            finish(&s);
+            suburbs.push_back(s);
+        }
+    }
+    return suburbs;
+}
+
+// Points that stress the kernels: uniform over (and past) the bbox, every
+// vertex, edge midpoints, vertices nudged by 1e-12 .. 1e-6, points level with
+// a vertex (ray-casting degeneracies) and points on the bbox edges
+vector<Point> adversarialPoints(std::mt19937_64& rng, const vector<Suburb>& suburbs, size_t uniform) {
+    double minLon = 1e300, minLat = 1e300, maxLon = -1e300, maxLat = -1e300;
+    for (const auto& s : suburbs) {
+        if (s.polys.empty()) continue;
+        minLon = std::min(minLon, s.minLon);
+        minLat = std::min(minLat, s.minLat);
+        maxLon = std::max(maxLon, s.maxLon);
+        maxLat = std::max(maxLat, s.maxLat);
+    }
+    const double padLon = 0.1 * (maxLon - minLon), padLat = 0.1 * (maxLat - minLat);
+    std::uniform_real_distribution<double> lon(minLon - padLon, maxLon + padLon), lat(minLat - padLat, maxLat + padLat);
+    std::uniform_real_distribution<double> unit(0, 1);
+    const double nudges[] = {1e-12, 1e-9, 1e-6};
+
+    vector<Point> points;
+    for (size_t i = 0; i < uniform; ++i) points.push_back(Point{lon(rng), lat(rng)});
+    for (const auto& s : suburbs) {
+        for (const auto& poly : s.polys) {
+            for (const auto& ring : poly.rings) {
+                // sample at most ~50 vertices of long rings
+                const size_t step = std::max<size_t>(1, ring.points.size() / 50);
+                for (size_t k = 0; k + 1 < ring.points.size(); k += step) {
+                    const Point a = ring.points[k], b = ring.points[k + 1];
+                    points.push_back(a);
+                    points.push_back(Point{(a.lon + b.lon) / 2, (a.lat + b.lat) / 2});
+                    const double d = nudges[rng() % 3] * (unit(rng) < 0.5 ? -1 : 1);
+                    points.push_back(Point{a.lon + d, a.lat});
+                    points.push_back(Point{a.lon, a.lat + d});
+                    points.push_back(Point{lon(rng), a.lat});
+                }
+            }
+        }
+        if (s.polys.empty()) continue;
+        points.push_back(Point{s.minLon, lat(rng)});
+        points.push_back(Point{s.maxLon, lat(rng)});
+        points.push_back(Point{lon(rng), s.minLat});
+        points.push_back(Point{lon(rng), s.maxLat});
+        points.push_back(Point{s.minLon, s.minLat});
+    }
+    return points;
+}
+
+// Brute-force nearest: smallest pointSuburbMetres over every suburb, if within maxMetres
+double oracleNearestMetres(const vector<Suburb>& suburbs, const Point& p, double maxMetres) {
+    double best = HUGE_VAL;
+    for (const auto& s : suburbs) best = std::min(best, suburb::pointSuburbMetres(s, p, HUGE_VAL));
+    return best <= maxMetres ? best : HUGE_VAL;
+}
+
+// The same world with monotone chains built, as the loader would. The
+// generators build rings by hand, so the oracle scans every edge; the chained
+// world must give identical answers.
+vector<Suburb> withChains(vector<Suburb> suburbs) {
+    for (auto& s : suburbs) {
+        for (auto& poly : s.polys) {
+            for (auto& ring : poly.rings) suburb::buildChains(&ring);
+        }
+    }
+    return suburbs;
+}
+
+// Checks every lookup path against the oracle for one world
+void checkWorld(const vector<Suburb>& suburbs, const vector<Point>& points, uint64_t seed) {
+    vector<uint32_t> expected(points.size());
+    for (size_t i = 0; i < points.size(); ++i) expected[i] = oracle(suburbs, points[i]);
+
+    const vector<Suburb> chained = withChains(suburbs);
+    const SuburbIndex linear(suburbs, IndexStrategy::Linear);
+    const SuburbIndex grid(suburbs, IndexStrategy::Grid);
+    const SuburbIndex trapezoid(suburbs, IndexStrategy::Trapezoid);
+    const SuburbGrid fine(suburbs, 0.02), coarse(suburbs, 4.0);
+    const vector<uint32_t> batch = grid.locateBatch(points, 3);
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Point& p = points[i];
+        CAPTURE(seed);
+        CAPTURE(i);
+        CAPTURE(p.lon);
+        CAPTURE(p.lat);
+        REQUIRE_EQ(suburb::findSuburb(suburbs, p), expected[i]);
+        REQUIRE_EQ(suburb::findSuburb(chained, p), expected[i]);
+        REQUIRE_EQ(linear.locate(p), expected[i]);
+        REQUIRE_EQ(grid.locate(p), expected[i]);
+        REQUIRE_EQ(trapezoid.locate(p), expected[i]);
+        REQUIRE_EQ(fine.locate(p), expected[i]);
+        REQUIRE_EQ(coarse.locate(p), expected[i]);
+        REQUIRE_EQ(batch[i], expected[i]);
+    }
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Differential tests for locate
+// -----------------------------------------------------------------------------
+
+TEST_CASE("differential: every index agrees with the brute-force oracle on random worlds") {
+    const int worlds = 6 * stressScale();
+    for (int w = 0; w < worlds; ++w) {
+        const uint64_t seed = 1000 + static_cast<uint64_t>(w);
+        std::mt19937_64 rng(seed);
+        const vector<Suburb> suburbs = randomWorld(rng);
+        checkWorld(suburbs, adversarialPoints(rng, suburbs, 500), seed);
+    }
+}
+
+TEST_CASE("differential: every index agrees with the oracle on shared tessellation edges") {
+    const int worlds = 6 * stressScale();
+    for (int w = 0; w < worlds; ++w) {
+        const uint64_t seed = 2000 + static_cast<uint64_t>(w);
+        std::mt19937_64 rng(seed);
+        const vector<Suburb> suburbs = tiledWorld(rng);
+        checkWorld(suburbs, adversarialPoints(rng, suburbs, 300), seed);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Differential tests for nearest and counting
+// -----------------------------------------------------------------------------
+
+TEST_CASE("differential: nearest matches the brute-force closest boundary") {
+    const int worlds = 6 * stressScale();
+    for (int w = 0; w < worlds; ++w) {
+        const uint64_t seed = 3000 + static_cast<uint64_t>(w);
+        std::mt19937_64 rng(seed);
+        const vector<Suburb> suburbs = randomWorld(rng);
+        const vector<Suburb> chained = withChains(suburbs);
+        const SuburbIndex index(suburbs);
+        const SuburbIndex chainedIndex(chained);
+        const double maxMetres = 500 + static_cast<double>(rng() % 20000);
+        for (const Point& p : adversarialPoints(rng, suburbs, 300)) {
+            if (oracle(suburbs, p) != NO_SUBURB) continue;
+            CAPTURE(seed);
+            CAPTURE(p.lon);
+            CAPTURE(p.lat);
+            const double expected = oracleNearestMetres(suburbs, p, maxMetres);
+            double metres = HUGE_VAL;
+            const uint32_t id = index.nearest(p, maxMetres, &metres);
+            if (expected == HUGE_VAL) {
+                REQUIRE_EQ(id, NO_SUBURB);
+                continue;
+            }
+            REQUIRE_NE(id, NO_SUBURB);
+            REQUIRE_EQ(metres, doctest::Approx(expected));
+            REQUIRE_EQ(suburb::pointSuburbMetres(suburbs[id], p, HUGE_VAL), doctest::Approx(expected));
+            // chained rings only search edges near the point, with the same result
+            double chainedMetres = HUGE_VAL;
+            REQUIRE_EQ(chainedIndex.nearest(p, maxMetres, &chainedMetres), id);
+            REQUIRE_EQ(chainedMetres, doctest::Approx(expected));
+            REQUIRE_EQ(suburb::pointSuburbMetres(chained[id], p, expected), doctest::Approx(expected));
+        }
+    }
+}
+
+TEST_CASE("differential: countObservations totals match oracle counts for any thread count") {
+    const int worlds = 4 * stressScale();
+    for (int w = 0; w < worlds; ++w) {
+        const uint64_t seed = 4000 + static_cast<uint64_t>(w);
+        std::mt19937_64 rng(seed);
+        const vector<Suburb> suburbs = rng() % 2 ? randomWorld(rng) : tiledWorld(rng);
+        const vector<Point> points = adversarialPoints(rng, suburbs, 2000);
+        vector<ObsPoint> obs;
+        vector<uint64_t> expected(suburbs.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            obs.push_back(ObsPoint{points[i].lon, points[i].lat, i + 1, static_cast<int>(i % 30)});
+            const uint32_t id = oracle(suburbs, points[i]);
+            if (id != NO_SUBURB) ++expected[id];
+        }
+        const SuburbIndex index(suburbs);
+        for (unsigned threads : {1u, 4u}) {
+            CountStats stats;
+            const auto totals = counts::countObservations(index, obs, 0, 29, 7, threads, &stats).totals();
+            CAPTURE(seed);
+            CAPTURE(threads);
+            CHECK_EQ(totals, expected);
+        }
+    }
+}
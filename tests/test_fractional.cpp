@@ -0,0 +1,127 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <doctest/doctest.h>
+#include <cmath>
+#include <vector>
+#include "../tawny_density/fractional.hpp"
+#include "test_geometry.hpp"
+
+using std::vector;
+
+using fractional::countFractional;
+using fractional::discSamples;
+using fractional::FractionalOptions;
+using fractional::FractionalStats;
+using observations::ObsPoint;
+using suburb::Point;
+using suburb::Suburb;
+using suburb::SuburbIndex;
+using suburb::METRES_PER_DEGREE_LAT;
+
+static ObsPoint obs(double lon, double lat, double accuracy) {
+    ObsPoint p;
+    p.lon = lon;
+    p.lat = lat;
+    p.day = 0;
+    p.accuracy = accuracy;
+    return p;
+}
+
+// -----------------------------------------------------------------------------
+// Tests for discSamples
+// -----------------------------------------------------------------------------
+
+TEST_CASE("discSamples spreads points evenly over the unit disc") {
+    const auto disc = discSamples(400);
+    CHECK_EQ(disc.size(), 400);
+    int right = 0, inner = 0;
+    for (const Point& p : disc) {
+        CHECK_LE(std::hypot(p.lon, p.lat), 1.0);
+        if (p.lon > 0) ++right;
+        if (std::hypot(p.lon, p.lat) < std::sqrt(0.5)) ++inner;
+    }
+    // half the area lies right of the centre, and half within radius sqrt(1/2)
+    CHECK_EQ(right, doctest::Approx(200).epsilon(0.05));
+    CHECK_EQ(inner, 200);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for countFractional
+// -----------------------------------------------------------------------------
+
+TEST_CASE("countFractional splits observations by how much of their circle each suburb covers") {
+    // two 0.01 degree squares side by side, ~1.1 km wide
+    vector<Suburb> suburbs{ squareSuburb(0, 0, 0.01), squareSuburb(0.01, 0, 0.01) };
+    const SuburbIndex index(suburbs);
+    const double m = 1 / METRES_PER_DEGREE_LAT;  // one metre in degrees at the equator
+
+    vector<ObsPoint> points{
+        obs(0.005, 0.005, 0),              // no accuracy: whole, WEST
+        obs(0.005, 0.005, 100),            // circle inside WEST: whole
+        obs(0.01, 0.005, 200),             // centred on the shared edge: half each
+        obs(0.01 + 100 * m, 0.005, 200),   // mostly EAST
+        obs(0.5, 0.5, 100),                // far from both
+    };
+    points.push_back(obs(0.005, 0.005, 0));
+    points.back().day = 99;  // out of range
+
+    for (unsigned threads : {1u, 3u}) {
+        FractionalStats stats;
+        FractionalOptions options;
+        options.samples = 256;
+        const auto w = countFractional(index, points, 0, 6, options, threads, &stats);
+
+        CHECK_EQ(stats.whole, 2);
+        CHECK_EQ(stats.spread, 2);
+        CHECK_EQ(stats.unassigned, 1);
+        CHECK_EQ(stats.undated, 1);
+        CHECK_EQ(w[0] + w[1], doctest::Approx(4));
+        // the off-centre circle has ~80% of its area east of the edge (segment at half the radius)
+        CHECK_EQ(w[1], doctest::Approx(0.5 + 0.80).epsilon(0.03));
+    }
+}
+
+TEST_CASE("countFractional clamps huge accuracy radii") {
+    vector<Suburb> suburbs{ squareSuburb(0, 0, 0.01), squareSuburb(0.01, 0, 0.01) };
+    const SuburbIndex index(suburbs);
+    FractionalOptions options;
+    options.maxAccuracyMetres = 100;
+
+    FractionalStats stats;
+    const auto w = countFractional(index, {obs(0.005, 0.005, 50000)}, 0, 6, options, 1, &stats);
+    CHECK_EQ(stats.whole, 1);
+    CHECK_EQ(w[0], 1);
+}
+
+TEST_CASE("countFractional credits circles outside every suburb to the nearest within nearestMetres") {
+    vector<Suburb> suburbs{ squareSuburb(0, 0, 0.01), squareSuburb(0.01, 0, 0.01) };
+    const SuburbIndex index(suburbs);
+    const double m = 1 / METRES_PER_DEGREE_LAT;
+    // 300 m east of EAST with a 100 m circle, and a point with no accuracy 50 m west of WEST
+    const vector<ObsPoint> points{ obs(0.02 + 300 * m, 0.005, 100), obs(-50 * m, 0.005, 0) };
+
+    FractionalStats stats;
+    FractionalOptions options;
+    auto w = countFractional(index, points, 0, 6, options, 1, &stats);
+    CHECK_EQ(stats.unassigned, 2);
+    CHECK_EQ(w[0] + w[1], 0);
+
+    options.nearestMetres = 500;
+    w = countFractional(index, points, 0, 6, options, 2, &stats);
+    CHECK_EQ(stats.unassigned, 0);
+    CHECK_EQ(stats.nearest, 2);
+    CHECK_EQ(w[0], 1);
+    CHECK_EQ(w[1], 1);
+}
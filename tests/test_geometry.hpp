@@ -0,0 +1,65 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../tawny_density/suburb.hpp"
+
+// Axis-aligned rectangular ring, counter-clockwise from its south-west corner
+inline suburb::Ring rectRing(double minLon, double minLat, double maxLon, double maxLat) {
+    return suburb::Ring{ { {minLon, minLat}, {maxLon, minLat}, {maxLon, maxLat}, {minLon, maxLat} } };
+}
+
+// Axis-aligned square ring with its south-west corner at (lon, lat)
+inline suburb::Ring squareRing(double lon, double lat, double size) {
+    return rectRing(lon, lat, lon + size, lat + size);
+}
+
+// Named suburb of the given polygons (each a list of rings, outer ring first), bboxes filled in
+inline suburb::Suburb polygonSuburb(const std::string& name, const std::vector<std::vector<suburb::Ring>>& polys) {
+    suburb::Suburb s;
+    s.name = name;
+    s.minLon = s.minLat = 1e300;
+    s.maxLon = s.maxLat = -1e300;
+    for (const auto& rings : polys) {
+        suburb::Polygon poly;
+        poly.rings = rings;
+        suburb::ringBounds(rings[0], &poly.minLon, &poly.minLat, &poly.maxLon, &poly.maxLat);
+        s.minLon = std::min(s.minLon, poly.minLon);
+        s.minLat = std::min(s.minLat, poly.minLat);
+        s.maxLon = std::max(s.maxLon, poly.maxLon);
+        s.maxLat = std::max(s.maxLat, poly.maxLat);
+        s.polys.push_back(poly);
+    }
+    return s;
+}
+
+// Named axis-aligned rectangular suburb
+inline suburb::Suburb rectSuburb(const std::string& name, double minLon, double minLat, double maxLon, double maxLat) {
+    return polygonSuburb(name, { { rectRing(minLon, minLat, maxLon, maxLat) } });
+}
+
+// Axis-aligned square suburb with its south-west corner at (lon, lat)
+inline suburb::Suburb squareSuburb(double lon, double lat, double size) {
+    return rectSuburb("", lon, lat, lon + size, lat + size);
+}
+
+// Two side by side 10x10 square suburbs, WEST (id 0) and EAST (id 1)
+inline std::vector<suburb::Suburb> twoSuburbs() {
+    std::vector<suburb::Suburb> suburbs = { squareSuburb(0, 0, 10), squareSuburb(10, 0, 10) };
+    suburbs[0].name = "WEST";
+    suburbs[1].name = "EAST";
+    return suburbs;
+}
@@ -0,0 +1,169 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "../tawny_density/heatmap.hpp"
+
+using std::string;
+using std::vector;
+
+using heatmap::Raster;
+using heatmap::makeRaster;
+using heatmap::rasterise;
+using heatmap::gaussianKernel;
+using heatmap::gaussianBlur;
+using heatmap::summariseSuburbs;
+using heatmap::writeRaster;
+using heatmap::METRES_PER_DEGREE;
+using observations::ObsPoint;
+using suburb::Ring;
+using suburb::Polygon;
+using suburb::Suburb;
+
+// 100 x 100 raster of 1 metre cells at the equator
+static Raster equatorRaster() {
+    return makeRaster(0, -0.5 * 100 / METRES_PER_DEGREE, 100 / METRES_PER_DEGREE,
+        0.5 * 100 / METRES_PER_DEGREE, 1.0);
+}
+
+static double total(const Raster& r) {
+    return std::accumulate(r.cells.begin(), r.cells.end(), 0.0);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for makeRaster and rasterise
+// -----------------------------------------------------------------------------
+
+TEST_CASE("makeRaster sizes roughly square cells over the extent") {
+    Raster r = equatorRaster();
+    CHECK_EQ(r.cols, 100);
+    CHECK_EQ(r.rows, 100);
+    CHECK_EQ(r.cells.size(), 10000);
+
+    // at 60 degrees south a degree of longitude is half as long
+    Raster south = makeRaster(0, -60.5, 1, -59.5, 1000);
+    CHECK_EQ(south.rows, doctest::Approx(112).epsilon(0.01));
+    CHECK_EQ(south.cols, doctest::Approx(56).epsilon(0.02));
+
+    CHECK_THROWS(makeRaster(0, 0, 1, 1, 0));
+    CHECK_THROWS(makeRaster(1, 0, 1, 1, 10));
+    CHECK_THROWS(makeRaster(0, 0, 100, 80, 0.001));
+}
+
+TEST_CASE("rasterise counts points per cell and ignores points outside") {
+    Raster r = equatorRaster();
+    vector<ObsPoint> obs;
+    for (int i = 0; i < 1000; ++i) {
+        obs.push_back(ObsPoint{r.centreLon(static_cast<size_t>(i % 100)), r.centreLat(static_cast<size_t>(i % 7))});
+    }
+    obs.push_back(ObsPoint{-1.0, 0.0});
+    obs.push_back(ObsPoint{0.0, 5.0});
+
+    Raster serial = r, threaded = r, manyBands = r;
+    rasterise(obs, &serial, 1);
+    rasterise(obs, &threaded, 4);
+    rasterise(obs, &manyBands, 150);  // more threads than rows
+
+    CHECK_EQ(total(serial), doctest::Approx(1000));
+    CHECK_EQ(serial.at(0, 0), doctest::Approx(2));  // i = 0 and i = 700
+    CHECK_EQ(serial.cells, threaded.cells);
+    CHECK_EQ(serial.cells, manyBands.cells);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for gaussianKernel and gaussianBlur
+// -----------------------------------------------------------------------------
+
+TEST_CASE("gaussianKernel is normalised, symmetric and 3 sigma wide") {
+    auto k = gaussianKernel(2.0);
+    CHECK_EQ(k.size(), 13);
+    CHECK_EQ(std::accumulate(k.begin(), k.end(), 0.0), doctest::Approx(1.0));
+    CHECK_EQ(k.front(), doctest::Approx(k.back()));
+    CHECK(k[6] > k[5]);
+    CHECK_EQ(gaussianKernel(0).size(), 1);
+}
+
+TEST_CASE("gaussianBlur spreads an impulse symmetrically and keeps its mass") {
+    Raster r = equatorRaster();
+    r.cells[50 * r.cols + 50] = 100.0f;
+
+    Raster threaded = r;
+    gaussianBlur(&r, 3.0, 1);
+    gaussianBlur(&threaded, 3.0, 3);
+
+    CHECK_EQ(total(r), doctest::Approx(100).epsilon(1e-4));
+    CHECK(r.at(50, 50) < 100.0f);
+    CHECK_EQ(r.at(47, 50), doctest::Approx(r.at(53, 50)));
+    CHECK_EQ(r.at(50, 47), doctest::Approx(r.at(50, 53)));
+    CHECK_EQ(r.at(47, 50), doctest::Approx(r.at(50, 47)));
+    CHECK_EQ(r.at(0, 0), 0.0f);
+    CHECK_EQ(r.cells, threaded.cells);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for summariseSuburbs and writeRaster
+// -----------------------------------------------------------------------------
+
+TEST_CASE("summariseSuburbs reports mean and peak over cells inside each suburb") {
+    Raster r = makeRaster(0, 0, 10, 10, METRES_PER_DEGREE);  // 10 x 10 one-degree cells (near enough)
+    r.cells.assign(r.cells.size(), 1.0f);
+    const size_t hot = 2 * r.cols + 3;
+    r.cells[hot] = 9.0f;
+
+    Polygon poly;
+    poly.rings = { Ring{ { {0, 0}, {5, 0}, {5, 5}, {0, 5} } } };
+    poly.minLon = 0; poly.minLat = 0; poly.maxLon = 5; poly.maxLat = 5;
+    Suburb s;
+    s.polys = { poly };
+    s.minLon = 0; s.minLat = 0; s.maxLon = 5; s.maxLat = 5;
+    Suburb away;
+    away.minLon = 50; away.minLat = 50; away.maxLon = 51; away.maxLat = 51;
+
+    auto summary = summariseSuburbs({s, away}, r, 2);
+
+    REQUIRE_EQ(summary.size(), 2);
+    CHECK(summary[0].cells > 0);
+    CHECK_EQ(summary[0].peak, doctest::Approx(9.0));
+    CHECK_EQ(summary[0].peakLon, doctest::Approx(r.centreLon(3)));
+    CHECK_EQ(summary[0].peakLat, doctest::Approx(r.centreLat(2)));
+    CHECK_EQ(summary[0].mean, doctest::Approx((summary[0].cells + 8.0) / summary[0].cells));
+    CHECK_EQ(summary[1].cells, 0);
+}
+
+TEST_CASE("writeRaster writes the header and float cells") {
+    const string path = "tawny_test_heat.bin";
+    Raster r = makeRaster(144, -38, 145, -37, 20000);
+    r.cells[1] = 2.5f;
+    writeRaster(path, r);
+
+    std::ifstream in(path, std::ios::binary);
+    vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+
+    REQUIRE_EQ(bytes.size(), 8 + 8 + 32 + r.cells.size() * 4);
+    CHECK_EQ(string(bytes.begin(), bytes.begin() + 8), "TAWNYHM1");
+    uint32_t cols = 0;
+    float cell = 0;
+    std::memcpy(&cols, bytes.data() + 8, 4);
+    std::memcpy(&cell, bytes.data() + 48 + 4, 4);
+    CHECK_EQ(cols, r.cols);
+    CHECK_EQ(cell, 2.5f);
+}
@@ -0,0 +1,93 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../tawny_density/hierarchy.hpp"
+#include "test_geometry.hpp"
+
+using std::string;
+using std::vector;
+
+using hierarchy::containment;
+using hierarchy::Hierarchy;
+using hierarchy::rollUp;
+using hierarchy::writeRollupCsv;
+using suburb::NO_SUBURB;
+using suburb::Suburb;
+using suburb::SuburbIndex;
+
+// Four suburbs along a row; C straddles the LGA boundary at lon 2 with most of its area in EASTSHIRE
+static vector<Suburb> suburbs() {
+    return { rectSuburb("A", 0, 0, 1, 1), rectSuburb("B", 1, 0, 2, 1), rectSuburb("C", 1.9, 0, 3, 1), rectSuburb("D", 5, 5, 6, 6) };
+}
+
+static vector<Suburb> lgas() {
+    return { rectSuburb("WESTSHIRE", 0, 0, 2, 1), rectSuburb("EASTSHIRE", 2, 0, 4, 1) };
+}
+
+// -----------------------------------------------------------------------------
+// Tests for containment and rollUp
+// -----------------------------------------------------------------------------
+
+TEST_CASE("containment maps each child to the parent holding most of it") {
+    const SuburbIndex parents(lgas());
+    for (unsigned threads : {1u, 3u}) {
+        CHECK_EQ(containment(suburbs(), parents, threads), vector<uint32_t>{0, 0, 1, NO_SUBURB});
+    }
+}
+
+TEST_CASE("rollUp sums children into parents and drops orphans") {
+    CHECK_EQ(rollUp({1, 2, 3, 4}, {0, 0, 1, NO_SUBURB}, 2), vector<uint64_t>{3, 3});
+    CHECK_THROWS(rollUp({1, 2}, {0}, 1));
+}
+
+// -----------------------------------------------------------------------------
+// Tests for Hierarchy
+// -----------------------------------------------------------------------------
+
+TEST_CASE("Hierarchy rolls suburb counts up through every level") {
+    const SuburbIndex finest(suburbs());
+    Hierarchy h(finest);
+    h.addLevel("lga", lgas());
+    h.addLevel("region", { rectSuburb("STATE", -10, -10, 10, 10) });
+    CHECK_EQ(h.levels(), 3);
+    CHECK_EQ(h.level(0).name, "suburb");
+    CHECK_THROWS(h.addLevel("lga", lgas()));
+
+    const auto counts = h.rollUp({5, 0, 2, 7});
+    REQUIRE_EQ(counts.size(), 3);
+    CHECK_EQ(counts[1], vector<uint64_t>{5, 2});
+    CHECK_EQ(counts[2], vector<uint64_t>{7});
+
+    const string path = "tawny_test_rollup.csv";
+    writeRollupCsv(path, h, counts);
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    CHECK_EQ(text.str(),
+        "level,unit_id,unit,parent_id,count\n"
+        "\"suburb\",0,\"A\",0,5\n"
+        "\"suburb\",2,\"C\",1,2\n"
+        "\"suburb\",3,\"D\",,7\n"
+        "\"lga\",0,\"WESTSHIRE\",0,5\n"
+        "\"lga\",1,\"EASTSHIRE\",0,2\n"
+        "\"region\",0,\"STATE\",,7\n");
+    std::remove(path.c_str());
+}
@@ -13,7 +13,10 @@
 // limitations under the License.
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
+#include <chrono>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include "../tawny_density/observations.hpp"
 #include "fake_http_client.hpp"
 
@@ -25,6 +28,12 @@ using utils::IHttpClient;
 using observations::urlEncode;
 using observations::httpGet;
 using observations::fetchINatPoints;
+using observations::fetchINatPointsSharded;
+using observations::parseIsoDate;
+using observations::formatIsoDate;
+using observations::splitDateRange;
+using observations::ShardOptions;
+using observations::DateWindow;
 
 // We wrap curl_easy_escape so we can mock it in tests.
 extern "C" {
@@ -130,7 +139,8 @@ TEST_CASE("fetchINatPoints parses a simple iNaturalist response") {
                 },
                 {
                     "geojson": { "coordinates": [145.0000, -37.8200] },
-                    "observed_on": "2024-01-02"
+                    "observed_on": "2024-01-02",
+                    "positional_accuracy": 250
                 }
             ]
         })"
@@ -150,6 +160,12 @@ TEST_CASE("fetchINatPoints parses a simple iNaturalist response") {
 
     CHECK_EQ(points[1].lon, doctest::Approx(145.0000));
     CHECK_EQ(points[1].lat, doctest::Approx(-37.8200));
+
+    CHECK_EQ(points[0].day, parseIsoDate("2024-01-01"));
+    CHECK_EQ(points[1].day, parseIsoDate("2024-01-02"));
+
+    CHECK_EQ(points[0].accuracy, 0);
+    CHECK_EQ(points[1].accuracy, 250);
 }
 
 TEST_CASE("fetchINatPoints returns empty vector on HTTP error") {
@@ -179,3 +195,228 @@ TEST_CASE("fetchINatPoints returns empty vector on malformed JSON") {
 
     CHECK(points.empty());
 }
+
+// -----------------------------------------------------------------------------
+// Tests for date helpers and splitDateRange
+// -----------------------------------------------------------------------------
+
+TEST_CASE("parseIsoDate and formatIsoDate round trip") {
+    CHECK_EQ(parseIsoDate("1970-01-01"), 0);
+    CHECK_EQ(parseIsoDate("2025-09-01"), 20332);
+    CHECK_EQ(formatIsoDate(20332), "2025-09-01");
+    CHECK_EQ(formatIsoDate(parseIsoDate("2024-02-29")), "2024-02-29");
+    CHECK_EQ(formatIsoDate(parseIsoDate("1969-12-31")), "1969-12-31");
+}
+
+TEST_CASE("parseIsoDate rejects malformed dates") {
+    CHECK_THROWS(parseIsoDate("2025/09/01"));
+    CHECK_THROWS(parseIsoDate("2025-13-01"));
+    CHECK_THROWS(parseIsoDate("not a date"));
+}
+
+TEST_CASE("splitDateRange produces weekly windows covering the range") {
+    auto windows = splitDateRange("2025-09-01", "2025-09-20", 7);
+
+    REQUIRE_EQ(windows.size(), 3);
+    CHECK_EQ(formatIsoDate(windows[0].firstDay), "2025-09-01");
+    CHECK_EQ(formatIsoDate(windows[0].lastDay), "2025-09-07");
+    CHECK_EQ(formatIsoDate(windows[1].firstDay), "2025-09-08");
+    CHECK_EQ(formatIsoDate(windows[2].firstDay), "2025-09-15");
+    CHECK_EQ(formatIsoDate(windows[2].lastDay), "2025-09-20");
+}
+
+TEST_CASE("splitDateRange handles a single day and rejects bad widths") {
+    CHECK_EQ(splitDateRange("2025-09-01", "2025-09-01", 7).size(), 1);
+    CHECK(splitDateRange("2025-09-02", "2025-09-01", 7).empty());
+    CHECK_THROWS(splitDateRange("2025-09-01", "2025-09-30", 0));
+}
+
+// -----------------------------------------------------------------------------
+// Tests for fetchINatPointsSharded
+// -----------------------------------------------------------------------------
+
+// Returns the value of query parameter key in url
+static std::string queryParam(const std::string& url, const std::string& key) {
+    const auto pos = url.find("&" + key + "=");
+    if (pos == std::string::npos) return "";
+    const auto start = pos + key.size() + 2;
+    return url.substr(start, url.find('&', start) - start);
+}
+
+TEST_CASE("fetchINatPointsSharded queries each window and deduplicates by id") {
+    RoutingHttpClient fake;
+    fake.handler = [](const std::string& url) -> HttpResponse {
+        // every window returns observation 7 plus one observation keyed on its start day
+        const int day = parseIsoDate(queryParam(url, "d1"));
+        return {200, R"({"total_results": 2, "results": [
+            {"id": 7, "geojson": {"coordinates": [145.0, -37.8]}},
+            {"id": )" + std::to_string(1000 + day) + R"(, "geojson": {"coordinates": [144.0, -37.0]}}
+        ]})"};
+    };
+
+    ShardOptions options;
+    options.windowDays = 7;
+    options.concurrency = 3;
+    options.pageDelayMs = 0;
+
+    auto points = fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-28",
+        -38.0, 144.0, -37.0, 146.0, options);
+
+    CHECK_EQ(fake.urls.size(), 4);
+    REQUIRE_EQ(points.size(), 5);
+    CHECK_EQ(points[0].id, 7);
+    CHECK_EQ(points[1].id, 1000 + parseIsoDate("2025-09-01"));
+    CHECK_EQ(points[4].id, 1000 + parseIsoDate("2025-09-22"));
+}
+
+TEST_CASE("fetchINatPointsSharded halves windows with too many results") {
+    RoutingHttpClient fake;
+    fake.handler = [](const std::string& url) -> HttpResponse {
+        const std::string d1 = queryParam(url, "d1");
+        if (d1 != queryParam(url, "d2")) return {200, R"({"total_results": 100000, "results": []})"};
+        const int day = parseIsoDate(d1);
+        return {200, R"({"total_results": 1, "results": [
+            {"id": )" + std::to_string(day) + R"(, "geojson": {"coordinates": [145.0, -37.8]}}
+        ]})"};
+    };
+
+    ShardOptions options;
+    options.windowDays = 4;
+    options.concurrency = 2;
+    options.pageDelayMs = 0;
+
+    auto points = fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-04",
+        -38.0, 144.0, -37.0, 146.0, options);
+
+    // one observation per single-day window
+    REQUIRE_EQ(points.size(), 4);
+    CHECK_EQ(formatIsoDate(static_cast<int>(points[0].id)), "2025-09-01");
+    CHECK_EQ(formatIsoDate(static_cast<int>(points[3].id)), "2025-09-04");
+}
+
+TEST_CASE("fetchINatPointsSharded retries throttled requests") {
+    RoutingHttpClient fake;
+    int calls = 0;
+    fake.handler = [&calls](const std::string&) -> HttpResponse {
+        if (calls++ == 0) return {429, "slow down"};
+        return {200, R"({"total_results": 1, "results": [{"id": 1, "geojson": {"coordinates": [145.0, -37.8]}}]})"};
+    };
+
+    ShardOptions options;
+    options.concurrency = 1;
+    options.pageDelayMs = 0;
+
+    auto points = fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-03",
+        -38.0, 144.0, -37.0, 146.0, options);
+
+    CHECK_EQ(calls, 2);
+    CHECK_EQ(points.size(), 1);
+}
+
+TEST_CASE("fetchINatPointsSharded passes updated_since for delta fetches") {
+    RoutingHttpClient fake;
+    fake.handler = [](const std::string&) -> HttpResponse {
+        return {200, R"({"total_results": 0, "results": []})"};
+    };
+
+    ShardOptions options;
+    options.pageDelayMs = 0;
+    options.updatedSince = "2025-12-01T00:00:00Z";
+
+    fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-03", -38.0, 144.0, -37.0, 146.0, options);
+
+    REQUIRE_EQ(fake.urls.size(), 1);
+    CHECK_EQ(queryParam(fake.urls[0], "updated_since"), "2025-12-01T00%3A00%3A00Z");
+}
+
+TEST_CASE("fetchINatPointsSharded reports windows whose pages fail and keeps the rest") {
+    RoutingHttpClient fake;
+    fake.handler = [](const std::string& url) -> HttpResponse {
+        const std::string d1 = queryParam(url, "d1");
+        if (d1 == "2025-09-08") return {503, "unavailable"};
+        if (d1 == "2025-09-15") return {200, "{not json"};
+        const int day = parseIsoDate(d1);
+        return {200, R"({"total_results": 1, "results": [
+            {"id": )" + std::to_string(day) + R"(, "geojson": {"coordinates": [145.0, -37.8]}}
+        ]})"};
+    };
+
+    ShardOptions options;
+    options.windowDays = 7;
+    options.concurrency = 2;
+    options.pageDelayMs = 0;
+    options.maxRetries = 1;
+
+    std::vector<DateWindow> failed;
+    auto points = fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-28",
+        -38.0, 144.0, -37.0, 146.0, options, &failed);
+
+    REQUIRE_EQ(failed.size(), 2);
+    CHECK_EQ(formatIsoDate(failed[0].firstDay), "2025-09-08");
+    CHECK_EQ(formatIsoDate(failed[1].firstDay), "2025-09-15");
+    REQUIRE_EQ(points.size(), 2);
+    CHECK_EQ(formatIsoDate(static_cast<int>(points[0].id)), "2025-09-01");
+    CHECK_EQ(formatIsoDate(static_cast<int>(points[1].id)), "2025-09-22");
+
+    // without a failure list a failed window is an error, never a silently partial result
+    CHECK_THROWS_AS(fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-28",
+        -38.0, 144.0, -37.0, 146.0, options), std::runtime_error);
+}
+
+TEST_CASE("fetchINatPointsSharded stops at the last page when results are dropped or shrink") {
+    RoutingHttpClient fake;
+    fake.handler = [](const std::string& url) -> HttpResponse {
+        const std::string page = queryParam(url, "page");
+        // past its page limit the API errors, which would fail the window
+        if (page != "1" && page != "2") return {422, "page limit"};
+        if (queryParam(url, "d1") == "2025-09-01") {
+            // one result has no coordinates, so fewer than total_results are kept
+            if (page != "1") return {200, R"({"total_results": 2, "results": []})"};
+            return {200, R"({"total_results": 2, "results": [
+                {"id": 1, "geojson": {"coordinates": [145.0, -37.8]}},
+                {"id": 2}
+            ]})"};
+        }
+        // total_results drops between pages, leaving page 2 empty
+        if (page != "1") return {200, R"({"total_results": 1, "results": []})"};
+        return {200, R"({"total_results": 201, "results": [
+            {"id": 3, "geojson": {"coordinates": [145.0, -37.8]}}
+        ]})"};
+    };
+
+    ShardOptions options;
+    options.windowDays = 7;
+    options.concurrency = 1;
+    options.pageDelayMs = 0;
+    options.maxRetries = 1;
+
+    std::vector<DateWindow> failed;
+    auto points = fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-14",
+        -38.0, 144.0, -37.0, 146.0, options, &failed);
+
+    CHECK(failed.empty());
+    CHECK_EQ(fake.urls.size(), 3);
+    REQUIRE_EQ(points.size(), 2);
+    CHECK_EQ(points[0].id, 1);
+    CHECK_EQ(points[1].id, 3);
+}
+
+TEST_CASE("fetchINatPointsSharded spaces requests from all workers by the politeness delay") {
+    RoutingHttpClient fake;
+    fake.handler = [](const std::string&) -> HttpResponse {
+        return {200, R"({"total_results": 0, "results": []})"};
+    };
+
+    ShardOptions options;
+    options.windowDays = 1;
+    options.concurrency = 4;
+    options.pageDelayMs = 40;
+
+    const auto start = std::chrono::steady_clock::now();
+    fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-04", -38.0, 144.0, -37.0, 146.0, options);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // four requests, one per worker, still go out one delay apart
+    CHECK_EQ(fake.urls.size(), 4);
+    CHECK_GE(elapsed, std::chrono::milliseconds(3 * 40));
+}
@@ -0,0 +1,112 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <vector>
+#include "../tawny_density/query_stats.hpp"
+#include "../tawny_density/stats.hpp"
+#include "../tawny_density/suburb_index.hpp"
+#include "test_geometry.hpp"
+
+using std::vector;
+
+using suburb::collectQueryStats;
+using suburb::IndexStrategy;
+using suburb::NO_SUBURB;
+using suburb::Point;
+using suburb::QueryStats;
+using suburb::queryStatsEnabled;
+using suburb::resetQueryStats;
+using suburb::Suburb;
+using suburb::SuburbIndex;
+
+// A: unit square with a hole; B: the square east of it; C: two squares far east
+static vector<Suburb> scene() {
+    return {
+        polygonSuburb("A", {{squareRing(0, 0, 1), squareRing(0.4, 0.4, 0.2)}}),
+        polygonSuburb("B", {{squareRing(1, 0, 1)}}),
+        polygonSuburb("C", {{squareRing(10, 0, 1)}, {squareRing(12, 0, 1)}}),
+    };
+}
+
+// -----------------------------------------------------------------------------
+// Tests for query counters
+// -----------------------------------------------------------------------------
+
+TEST_CASE("query counters count the work of each locate, or stay zero when compiled out") {
+    const SuburbIndex index(scene(), IndexStrategy::Linear);
+    resetQueryStats();
+    CHECK_EQ(index.locate(Point{0.2, 0.2}), 0);    // A: outer ring and hole
+    CHECK_EQ(index.locate(Point{1.5, 0.5}), 1);    // A rejected by bbox, then B
+    CHECK_EQ(index.locate(Point{12.5, 0.5}), 2);   // C's first polygon rejected by bbox
+    CHECK_EQ(index.locate(Point{5, 5}), NO_SUBURB);
+    const QueryStats q = collectQueryStats();
+
+    if (!queryStatsEnabled()) {
+        CHECK_EQ(q.counters.queries, 0);
+        CHECK_EQ(q.counters.edgesVisited, 0);
+        CHECK_EQ(q.edgesPerQuery.count(), 0);
+        return;
+    }
+    CHECK_EQ(q.counters.queries, 4);
+    CHECK_EQ(q.counters.hits, 3);
+    CHECK_EQ(q.counters.misses, 1);
+    CHECK_EQ(q.counters.suburbBboxTests, 1 + 2 + 3 + 3);
+    CHECK_EQ(q.counters.polygonBboxRejects, 1);
+    CHECK_EQ(q.counters.ringsTested, 4);
+    CHECK_EQ(q.counters.holeTests, 1);
+    CHECK_EQ(q.counters.edgesVisited, 16);
+    REQUIRE_EQ(q.suburbEdges.size(), 3);
+    CHECK_EQ(q.suburbEdges[0], 8);
+    CHECK_EQ(q.suburbEdges[1], 4);
+    CHECK_EQ(q.suburbEdges[2], 4);
+    CHECK_EQ(q.edgesPerQuery.count(), 4);
+    CHECK_EQ(q.edgesPerQuery.max(), 8);
+    CHECK_EQ(q.candidatesPerQuery.max(), 3);
+}
+
+TEST_CASE("query counters from worker threads are merged when the threads exit") {
+    const SuburbIndex index(scene(), IndexStrategy::Grid);
+    resetQueryStats();
+    const vector<Point> points(100, Point{0.2, 0.2});
+    const vector<uint32_t> ids = index.locateBatch(points, 3);
+    CHECK_EQ(ids[99], 0);
+
+    const QueryStats q = collectQueryStats();
+    CHECK_EQ(q.counters.queries, queryStatsEnabled() ? 100 : 0);
+    CHECK_EQ(q.counters.edgesVisited, queryStatsEnabled() ? 800 : 0);
+    resetQueryStats();
+}
+
+TEST_CASE("reportQueryStats adds counters, histograms and the costliest suburbs") {
+    const vector<Suburb> suburbs = scene();
+    const SuburbIndex index(suburbs, IndexStrategy::Linear);
+    resetQueryStats();
+    index.locate(Point{0.2, 0.2});
+    index.locate(Point{1.5, 0.5});
+
+    stats::Registry r;
+    suburb::reportQueryStats(suburbs, &r, 1);
+    if (!queryStatsEnabled()) {
+        CHECK_EQ(r.counter("query_locates"), 0);
+        CHECK_EQ(r.histogram("query_edges").count(), 0);
+        return;
+    }
+    CHECK_EQ(r.counter("query_locates"), 2);
+    CHECK_EQ(r.counter("query_edges_visited"), 12);
+    CHECK_EQ(r.counter("query_edges[A]"), 8);
+    CHECK_EQ(r.counter("query_edges[B]"), 0);  // only the top 1 is listed
+    CHECK_EQ(r.histogram("query_candidates").count(), 2);
+    resetQueryStats();
+}
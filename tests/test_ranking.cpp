@@ -0,0 +1,116 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <vector>
+#include "../tawny_density/ranking.hpp"
+
+using std::vector;
+
+using ranking::RankedSuburb;
+using ranking::topK;
+using ranking::mergeTopK;
+using ranking::orderSuburbs;
+using ranking::SortOrder;
+using suburb::Suburb;
+
+// -----------------------------------------------------------------------------
+// Tests for topK
+// -----------------------------------------------------------------------------
+
+TEST_CASE("topK returns suburbs in count order") {
+    vector<uint64_t> counts{3, 9, 0, 5, 1};
+
+    auto ranked = topK(counts, 3);
+
+    REQUIRE_EQ(ranked.size(), 3);
+    CHECK_EQ(ranked[0].id, 1);
+    CHECK_EQ(ranked[0].count, 9);
+    CHECK_EQ(ranked[1].id, 3);
+    CHECK_EQ(ranked[2].id, 0);
+}
+
+TEST_CASE("topK breaks ties by lower suburb id") {
+    vector<uint64_t> counts{2, 7, 7, 2, 7};
+
+    auto ranked = topK(counts, 4);
+
+    REQUIRE_EQ(ranked.size(), 4);
+    CHECK_EQ(ranked[0].id, 1);
+    CHECK_EQ(ranked[1].id, 2);
+    CHECK_EQ(ranked[2].id, 4);
+    CHECK_EQ(ranked[3].id, 0);
+}
+
+TEST_CASE("topK skips zero counts and handles k larger than the input") {
+    vector<uint64_t> counts{0, 4, 0};
+
+    auto ranked = topK(counts, 20);
+
+    REQUIRE_EQ(ranked.size(), 1);
+    CHECK_EQ(ranked[0].id, 1);
+    CHECK(topK(counts, 0).empty());
+    CHECK(topK(vector<uint64_t>{}, 5).empty());
+}
+
+TEST_CASE("topK gives the same answer for any thread count") {
+    vector<uint64_t> counts(1000);
+    for (size_t i = 0; i < counts.size(); ++i) counts[i] = (i * 7919) % 13;
+
+    auto serial = topK(counts, 20, 1);
+    for (unsigned threads : {2u, 3u, 8u}) {
+        auto parallel = topK(counts, 20, threads);
+        REQUIRE_EQ(parallel.size(), serial.size());
+        for (size_t i = 0; i < serial.size(); ++i) {
+            CHECK_EQ(parallel[i].id, serial[i].id);
+            CHECK_EQ(parallel[i].count, serial[i].count);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Tests for mergeTopK
+// -----------------------------------------------------------------------------
+
+TEST_CASE("mergeTopK merges per-thread lists") {
+    vector<vector<RankedSuburb>> partials{
+        { {0, 5}, {2, 3} },
+        { {10, 5}, {11, 4} },
+        {}
+    };
+
+    auto ranked = mergeTopK(partials, 3);
+
+    REQUIRE_EQ(ranked.size(), 3);
+    CHECK_EQ(ranked[0].id, 0);
+    CHECK_EQ(ranked[1].id, 10);
+    CHECK_EQ(ranked[2].id, 11);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for orderSuburbs
+// -----------------------------------------------------------------------------
+
+TEST_CASE("orderSuburbs orders by id, count or name") {
+    vector<Suburb> suburbs(4);
+    suburbs[0].name = "DELTA";
+    suburbs[1].name = "ALPHA";
+    suburbs[2].name = "CHARLIE";
+    suburbs[3].name = "ALPHA";
+    vector<uint64_t> counts{1, 5, 5, 0};
+
+    CHECK_EQ(orderSuburbs(suburbs, counts, SortOrder::Id), vector<uint32_t>{0, 1, 2, 3});
+    CHECK_EQ(orderSuburbs(suburbs, counts, SortOrder::Count), vector<uint32_t>{1, 2, 0, 3});
+    CHECK_EQ(orderSuburbs(suburbs, counts, SortOrder::Name), vector<uint32_t>{1, 3, 2, 0});
+}
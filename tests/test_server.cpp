@@ -0,0 +1,213 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <doctest/doctest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../tawny_density/server.hpp"
+#include "test_geometry.hpp"
+
+using std::string;
+using std::vector;
+
+using server::answerLine;
+using server::parsePoint;
+using server::LookupClient;
+using server::LookupServer;
+using suburb::NO_SUBURB;
+using suburb::Point;
+using suburb::SuburbIndex;
+
+// -----------------------------------------------------------------------------
+// Tests for parsePoint and answerLine
+// -----------------------------------------------------------------------------
+
+TEST_CASE("parsePoint accepts space, tab and comma separated coordinates") {
+    Point p;
+    CHECK(parsePoint("144.96 -37.81", &p));
+    CHECK_EQ(p.lon, 144.96);
+    CHECK_EQ(p.lat, -37.81);
+    CHECK(parsePoint("  1.5,\t2.5  ", &p));
+    CHECK_EQ(p.lon, 1.5);
+    CHECK_EQ(p.lat, 2.5);
+
+    CHECK_FALSE(parsePoint("", &p));
+    CHECK_FALSE(parsePoint("144.96", &p));
+    CHECK_FALSE(parsePoint("144.96-37.81", &p));
+    CHECK_FALSE(parsePoint("1 2 3", &p));
+    CHECK_FALSE(parsePoint("abc def", &p));
+    CHECK_FALSE(parsePoint("200 0", &p));
+    CHECK_FALSE(parsePoint("nan 0", &p));
+}
+
+TEST_CASE("answerLine replies with id and name, '-' or ERR") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    string out;
+    answerLine(index, "15 5", &out);
+    answerLine(index, "50 50", &out);
+    answerLine(index, "x", &out);
+    CHECK_EQ(out, "1\tEAST\n-\t\nERR malformed point\n");
+}
+
+// -----------------------------------------------------------------------------
+// Tests for LookupServer and LookupClient
+// -----------------------------------------------------------------------------
+
+TEST_CASE("LookupServer answers batches from concurrent clients") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    LookupServer lookupServer(index, "tawny_test_server.sock", 2);
+    std::thread running([&] { lookupServer.run(); });
+
+    {
+        LookupClient a(lookupServer.socketPath());
+        LookupClient b(lookupServer.socketPath());
+        CHECK_EQ(a.lookup({{5, 5}, {15, 5}, {50, 50}}), vector<uint32_t>{0, 1, NO_SUBURB});
+        CHECK_EQ(b.lookup({{15, 9}}), vector<uint32_t>{1});
+        // the same connection keeps answering, including empty and large batches
+        CHECK(a.lookup({}).empty());
+        vector<Point> many(20000, Point{5, 5});
+        for (size_t i = 0; i < many.size(); i += 2) many[i] = Point{15, 5};
+        const auto ids = a.lookup(many);
+        REQUIRE_EQ(ids.size(), many.size());
+        CHECK_EQ(ids.front(), 1);
+        CHECK_EQ(ids.back(), 0);
+    }
+
+    lookupServer.stop();
+    running.join();
+}
+
+TEST_CASE("LookupClient reads answers while a large batch is still being sent") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    LookupServer lookupServer(index, "tawny_test_server_large.sock", 1, 2000);
+    std::thread running([&] { lookupServer.run(); });
+
+    {
+        // far more answers than the socket buffers hold
+        vector<Point> points(200000);
+        for (size_t i = 0; i < points.size(); ++i) points[i] = Point{(i % 3) * 10.0 + 5, 5};
+        LookupClient client(lookupServer.socketPath());
+        const auto ids = client.lookup(points);
+        REQUIRE_EQ(ids.size(), points.size());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            const uint32_t expected = i % 3 == 2 ? NO_SUBURB : static_cast<uint32_t>(i % 3);
+            if (ids[i] != expected) FAIL_CHECK("point " << i << " answered " << ids[i]);
+        }
+        // the connection is left ready for the next batch
+        CHECK_EQ(client.lookup({{15, 5}}), vector<uint32_t>{1});
+    }
+
+    lookupServer.stop();
+    running.join();
+}
+
+TEST_CASE("LookupServer frees workers between batches and closes idle connections") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    LookupServer lookupServer(index, "tawny_test_server_idle.sock", 1, 200);
+    std::thread running([&] { lookupServer.run(); });
+
+    {
+        LookupClient idle(lookupServer.socketPath());
+        CHECK_EQ(idle.lookup({{5, 5}}), vector<uint32_t>{0});
+        // the single worker is not held by the idle connection
+        LookupClient busy(lookupServer.socketPath());
+        CHECK_EQ(busy.lookup({{15, 5}}), vector<uint32_t>{1});
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        CHECK_THROWS(idle.lookup({{5, 5}}));
+    }
+
+    lookupServer.stop();
+    running.join();
+}
+
+TEST_CASE("LookupServer is not held up by a client that never reads its answers") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    LookupServer lookupServer(index, "tawny_test_server_stuck.sock", 1, 300);
+    std::thread running([&] { lookupServer.run(); });
+
+    // send batches without reading until the server stops taking them
+    const int stuck = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    REQUIRE(stuck >= 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, lookupServer.socketPath().c_str());
+    REQUIRE_EQ(::connect(stuck, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)), 0);
+    string batch;
+    for (int i = 0; i < 4096; ++i) batch += "5 5\n";
+    batch += "\n";
+    int refused = 0;
+    while (refused < 20) {
+        const ssize_t n = ::send(stuck, batch.data(), batch.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            REQUIRE((errno == EAGAIN || errno == EWOULDBLOCK));
+            ++refused;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        } else {
+            refused = 0;
+        }
+    }
+
+    // the only worker is free for other clients
+    {
+        LookupClient client(lookupServer.socketPath());
+        CHECK_EQ(client.lookup({{15, 5}}), vector<uint32_t>{1});
+    }
+
+    // the stuck connection is closed once its answers sit unsent past the idle timeout
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    CHECK_LT(::send(stuck, "\n", 1, MSG_DONTWAIT | MSG_NOSIGNAL), 0);
+    ::close(stuck);
+
+    lookupServer.stop();
+    running.join();
+}
+
+TEST_CASE("LookupServer refuses a socket a running server is using") {
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    LookupServer first(index, "tawny_test_server_live.sock", 1);
+    std::thread running([&] { first.run(); });
+
+    CHECK_THROWS(LookupServer(index, first.socketPath()));
+    LookupClient client(first.socketPath());
+    CHECK_EQ(client.lookup({{15, 5}}), vector<uint32_t>{1});
+
+    first.stop();
+    running.join();
+}
+
+TEST_CASE("LookupServer refuses to replace a regular file") {
+    const string path = "tawny_test_not_a_socket";
+    std::ofstream(path) << "data";
+    const auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    CHECK_THROWS(LookupServer(index, path));
+    std::remove(path.c_str());
+    CHECK_THROWS(LookupClient("tawny_test_missing.sock"));
+}
@@ -0,0 +1,184 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../tawny_density/snapshot.hpp"
+#include "test_geometry.hpp"
+
+using std::string;
+using std::vector;
+
+using observations::ObsPoint;
+using snapshot::Snapshot;
+using snapshot::DeltaStats;
+using suburb::Point;
+using suburb::SuburbIndex;
+
+static ObsPoint obs(uint64_t id, double lon, int day) {
+    ObsPoint p;
+    p.id = id;
+    p.lon = lon;
+    p.lat = 5.0;
+    p.day = day;
+    return p;
+}
+
+// -----------------------------------------------------------------------------
+// Tests for Snapshot::apply and Snapshot::reconcile
+// -----------------------------------------------------------------------------
+
+TEST_CASE("Snapshot apply inserts, updates, skips unchanged and deletes") {
+    auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    Snapshot snap(suburbs, 0, 13, 7);
+
+    DeltaStats first = snap.apply(index, {obs(1, 5, 0), obs(2, 5, 8), obs(3, 15, 1), obs(0, 5, 0)}, {});
+    CHECK_EQ(first.inserted, 3);
+    CHECK_EQ(first.ignored, 1);
+    CHECK_EQ(snap.assigned(), 3);
+    CHECK_EQ(snap.matrix().at(0, 0), 1);
+    CHECK_EQ(snap.matrix().at(0, 1), 1);
+    CHECK_EQ(snap.matrix().at(1, 0), 1);
+
+    // 1 unchanged, 2 moves east, 3 deleted, 4 is new but outside every suburb
+    DeltaStats second = snap.apply(index, {obs(1, 5, 0), obs(2, 15, 8), obs(4, 50, 2)}, {3, 99});
+    CHECK_EQ(second.unchanged, 1);
+    CHECK_EQ(second.updated, 1);
+    CHECK_EQ(second.inserted, 1);
+    CHECK_EQ(second.deleted, 1);
+    CHECK_EQ(second.ignored, 1);
+
+    CHECK_EQ(snap.observations(), 3);
+    CHECK_EQ(snap.assigned(), 2);
+    CHECK_EQ(snap.matrix().totals(), vector<uint64_t>{1, 1});
+    CHECK_EQ(snap.matrix().at(1, 1), 1);
+}
+
+TEST_CASE("Snapshot reconcile deletes ids missing from a full result set") {
+    auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    Snapshot snap(suburbs, 0, 13, 7);
+    snap.apply(index, {obs(1, 5, 0), obs(2, 15, 0)}, {});
+
+    DeltaStats delta = snap.reconcile(index, {obs(2, 15, 0)});
+
+    CHECK_EQ(delta.deleted, 1);
+    CHECK_EQ(delta.unchanged, 1);
+    CHECK_EQ(snap.matrix().totals(), vector<uint64_t>{0, 1});
+}
+
+TEST_CASE("Snapshot apply can place points just outside a suburb") {
+    auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    Snapshot snap(suburbs, 0, 13, 7);
+
+    // 20.001 is ~110 m east of EAST at this latitude
+    DeltaStats delta = snap.apply(index, {obs(1, 20.001, 0)}, {}, 1, 200);
+    CHECK_EQ(delta.inserted, 1);
+    CHECK_EQ(snap.assigned(), 1);
+    CHECK_EQ(snap.matrix().totals(), vector<uint64_t>{0, 1});
+}
+
+// -----------------------------------------------------------------------------
+// Tests for Snapshot::save and Snapshot::load
+// -----------------------------------------------------------------------------
+
+TEST_CASE("Snapshot round trips through a file and keeps applying deltas") {
+    const string path = "tawny_test_state.snap";
+    auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    {
+        Snapshot snap(suburbs, 0, 13, 7);
+        snap.apply(index, {obs(1, 5, 0), obs(2, 15, 9)}, {});
+        snap.setFetchedAt("2025-12-01T00:00:00Z");
+        snap.save(path);
+    }
+
+    Snapshot loaded = Snapshot::load(path, suburbs);
+    CHECK_EQ(loaded.fetchedAt(), "2025-12-01T00:00:00Z");
+    CHECK_EQ(loaded.observations(), 2);
+    CHECK_EQ(loaded.assigned(), 2);
+    CHECK_EQ(loaded.matrix().buckets(), 2);
+    CHECK_EQ(loaded.matrix().at(1, 1), 1);
+
+    DeltaStats delta = loaded.apply(index, {obs(2, 15, 9)}, {1});
+    CHECK_EQ(delta.unchanged, 1);
+    CHECK_EQ(delta.deleted, 1);
+    CHECK_EQ(loaded.matrix().totals(), vector<uint64_t>{0, 1});
+
+    // a different suburb layer is rejected
+    auto other = twoSuburbs();
+    other[1].name = "ELSEWHERE";
+    CHECK_THROWS(Snapshot::load(path, other));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Snapshot relocates every observation when the nearest distance changes") {
+    const string path = "tawny_test_state_nearest.snap";
+    auto suburbs = twoSuburbs();
+    const SuburbIndex index(suburbs);
+    {
+        Snapshot snap(suburbs, 0, 13, 7);
+        snap.apply(index, {obs(1, 5, 0), obs(2, 20.001, 0)}, {});
+        CHECK_EQ(snap.assigned(), 1);
+        snap.save(path);
+    }
+
+    // the saved distance survives the round trip, so the same rule relocates nothing
+    Snapshot loaded = Snapshot::load(path, suburbs);
+    CHECK_EQ(loaded.nearestMetres(), 0);
+    CHECK_EQ(loaded.apply(index, {}, {}).relocated, 0);
+
+    // a wider rule places the point outside EAST, as a fresh run would
+    DeltaStats delta = loaded.apply(index, {}, {}, 1, 200);
+    CHECK_EQ(delta.relocated, 2);
+    CHECK_EQ(loaded.assigned(), 2);
+    CHECK_EQ(loaded.nearestMetres(), 200);
+    CHECK_EQ(loaded.matrix().totals(), vector<uint64_t>{1, 1});
+
+    // and going back to 0 drops it again
+    CHECK_EQ(loaded.apply(index, {}, {}).relocated, 2);
+    CHECK_EQ(loaded.assigned(), 1);
+    CHECK_EQ(loaded.matrix().totals(), vector<uint64_t>{1, 0});
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Snapshot load rejects a boundary moved inside the bounding boxes") {
+    const string path = "tawny_test_state_moved.snap";
+    auto suburbs = twoSuburbs();
+    // a vertex in the middle of WEST's border with EAST
+    auto& west = suburbs[0].polys[0].rings[0].points;
+    west.insert(west.begin() + 2, Point{10, 5});
+    const SuburbIndex index(suburbs);
+    {
+        Snapshot snap(suburbs, 0, 13, 7);
+        snap.apply(index, {obs(1, 9.8, 0)}, {});
+        snap.save(path);
+    }
+    CHECK_EQ(Snapshot::load(path, suburbs).observations(), 1);
+
+    // moving it west changes no bounding box but hands (9.8, 5) to no suburb
+    auto moved = suburbs;
+    moved[0].polys[0].rings[0].points[2] = Point{9.5, 5};
+    CHECK_THROWS(Snapshot::load(path, moved));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Snapshot load rejects missing and foreign files") {
+    auto suburbs = twoSuburbs();
+    CHECK_THROWS(Snapshot::load("tawny_test_missing.snap", suburbs));
+}
@@ -0,0 +1,242 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include "../tawny_density/observations.hpp"
+#include "../tawny_density/stats.hpp"
+#include "fake_http_client.hpp"
+
+using std::string;
+using json = nlohmann::json;
+
+using stats::PhaseStats;
+using stats::Registry;
+using stats::ScopedTimer;
+using utils::HttpResponse;
+
+// -----------------------------------------------------------------------------
+// Tests for Registry
+// -----------------------------------------------------------------------------
+
+TEST_CASE("Registry sums runs, time and items per phase") {
+    Registry r;
+    r.addPhase("parse", 0.5, 100);
+    r.addPhase("parse", 1.5, 300);
+    r.addPhase("write", 0.25);
+
+    const PhaseStats parse = r.phase("parse");
+    CHECK_EQ(parse.runs, 2);
+    CHECK_EQ(parse.seconds, doctest::Approx(2.0));
+    CHECK_EQ(parse.maxSeconds, doctest::Approx(1.5));
+    CHECK_EQ(parse.items, 400);
+    CHECK_EQ(r.phase("write").runs, 1);
+    CHECK_EQ(r.phase("missing").runs, 0);
+}
+
+TEST_CASE("Registry counters start at zero and accumulate") {
+    Registry r;
+    CHECK_EQ(r.counter("pages"), 0);
+    r.add("pages");
+    r.add("pages", 4);
+    CHECK_EQ(r.counter("pages"), 5);
+    r.reset();
+    CHECK_EQ(r.counter("pages"), 0);
+}
+
+TEST_CASE("Registry JSON reports phases, throughput and counters") {
+    Registry r;
+    r.addPhase("assign", 2.0, 1000);
+    r.addPhase("write", 1.0);
+    r.add("http_retries", 3);
+
+    const json j = r.toJson();
+    CHECK(j["wall_seconds"].get<double>() >= 0);
+    CHECK_EQ(j["phases"]["assign"]["runs"], 1);
+    CHECK_EQ(j["phases"]["assign"]["items_per_second"].get<double>(), doctest::Approx(500));
+    CHECK_FALSE(j["phases"]["write"].contains("items"));
+    CHECK_EQ(j["counters"]["http_retries"], 3);
+}
+
+TEST_CASE("Registry summary lists phases in the order first recorded") {
+    Registry r;
+    r.addPhase("zeta", 0.1);
+    r.addPhase("alpha", 0.1, 10);
+    r.add("pages", 2);
+
+    const string text = r.summary();
+    REQUIRE_NE(text.find("zeta"), string::npos);
+    CHECK_LT(text.find("zeta"), text.find("alpha"));
+    CHECK_NE(text.find("items/s"), string::npos);
+    CHECK_NE(text.find("pages"), string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for ScopedTimer
+// -----------------------------------------------------------------------------
+
+TEST_CASE("ScopedTimer records one run at scope exit") {
+    Registry r;
+    {
+        ScopedTimer timer("load", &r);
+        timer.setItems(7);
+        CHECK_EQ(r.phase("load").runs, 0);
+    }
+    CHECK_EQ(r.phase("load").runs, 1);
+    CHECK_EQ(r.phase("load").items, 7);
+}
+
+TEST_CASE("ScopedTimer stop records early and only once") {
+    Registry r;
+    {
+        ScopedTimer timer("assign", &r);
+        timer.stop();
+        CHECK_EQ(r.phase("assign").runs, 1);
+        timer.stop();
+    }
+    CHECK_EQ(r.phase("assign").runs, 1);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for writeStatsJson and the global registry
+// -----------------------------------------------------------------------------
+
+TEST_CASE("writeStatsJson writes the registry's JSON") {
+    Registry r;
+    r.addPhase("fetch", 0.75, 20);
+    r.add("pages", 2);
+    const string path = "tawny_test_stats.json";
+    stats::writeStatsJson(path, r);
+
+    std::ifstream in(path);
+    const json j = json::parse(in);
+    in.close();
+    std::remove(path.c_str());
+    CHECK_EQ(j["phases"]["fetch"]["items"], 20);
+    CHECK_EQ(j["counters"]["pages"], 2);
+}
+
+TEST_CASE("Sharded fetches record requests, retries, pages and parse time") {
+    RoutingHttpClient fake;
+    int calls = 0;
+    fake.handler = [&calls](const string&) -> HttpResponse {
+        if (calls++ == 0) return {503, "busy"};
+        return {200, R"({"total_results": 1, "results": [{"id": 1, "geojson": {"coordinates": [145.0, -37.8]}}]})"};
+    };
+    observations::ShardOptions options;
+    options.concurrency = 1;
+    options.pageDelayMs = 0;
+
+    Registry& g = stats::global();
+    g.reset();
+    observations::fetchINatPointsSharded(fake, "Aves", "2025-09-01", "2025-09-03", -38.0, 144.0, -37.0, 146.0,
+        options);
+
+    CHECK_EQ(g.counter("http_requests"), 2);
+    CHECK_EQ(g.counter("http_retries"), 1);
+    CHECK_EQ(g.counter("pages"), 1);
+    CHECK_EQ(g.phase("http_request").runs, 2);
+    CHECK_EQ(g.phase("json_parse").runs, 1);
+    CHECK_GT(g.counter("http_bytes"), 0);
+    g.reset();
+}
+
+// -----------------------------------------------------------------------------
+// Tests for Histogram
+// -----------------------------------------------------------------------------
+
+TEST_CASE("Histogram percentiles are within a bucket of the exact values") {
+    stats::Histogram h;
+    for (int i = 1; i <= 1000; ++i) h.add(i * 1e-3);  // 1 ms .. 1 s
+
+    CHECK_EQ(h.count(), 1000);
+    CHECK_EQ(h.min(), doctest::Approx(1e-3));
+    CHECK_EQ(h.max(), doctest::Approx(1.0));
+    CHECK_EQ(h.mean(), doctest::Approx(0.5005));
+    CHECK_EQ(h.percentile(50), doctest::Approx(0.5).epsilon(0.1));
+    CHECK_EQ(h.percentile(90), doctest::Approx(0.9).epsilon(0.1));
+    CHECK_EQ(h.percentile(99), doctest::Approx(0.99).epsilon(0.1));
+    CHECK_EQ(h.percentile(100), doctest::Approx(1.0));
+    CHECK_EQ(h.percentile(0), doctest::Approx(1e-3).epsilon(0.1));
+}
+
+TEST_CASE("Histogram handles empty, zero and single values") {
+    stats::Histogram h;
+    CHECK_EQ(h.count(), 0);
+    CHECK_EQ(h.percentile(50), 0);
+    h.add(0);
+    h.add(-1);  // counts as 0
+    CHECK_EQ(h.percentile(99), 0);
+    h.add(2.5);
+    CHECK_EQ(h.percentile(100), doctest::Approx(2.5));
+    CHECK_EQ(h.max(), doctest::Approx(2.5));
+}
+
+TEST_CASE("Registry reports histograms in JSON and the summary") {
+    Registry r;
+    for (int i = 0; i < 10; ++i) r.record("http_total_seconds", 0.1);
+    CHECK_EQ(r.histogram("http_total_seconds").count(), 10);
+    CHECK_EQ(r.histogram("missing").count(), 0);
+
+    const json j = r.toJson();
+    CHECK_EQ(j["histograms"]["http_total_seconds"]["count"], 10);
+    CHECK_EQ(j["histograms"]["http_total_seconds"]["p50"].get<double>(), doctest::Approx(0.1));
+    CHECK_NE(r.summary().find("http_total_seconds"), string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for memory accounting
+// -----------------------------------------------------------------------------
+
+TEST_CASE("recordBytes keeps the largest size per name and reports it with RSS") {
+    Registry r;
+    r.recordBytes("http_page_body", 100);
+    r.recordBytes("http_page_body", 4000);
+    r.recordBytes("http_page_body", 50);
+    CHECK_EQ(r.bytes("http_page_body"), 4000);
+    CHECK_EQ(r.bytes("missing"), 0);
+
+    const json j = r.toJson();
+    CHECK_EQ(j["memory"]["http_page_body"], 4000);
+    CHECK(j["memory"].contains("peak_rss"));
+    CHECK_NE(r.summary().find("http_page_body"), string::npos);
+}
+
+TEST_CASE("peak RSS is read from /proc and recorded per phase") {
+    const uint64_t peak = stats::peakRssBytes();
+    CHECK_GT(peak, 0);
+    CHECK_GE(peak, stats::currentRssBytes());
+
+    Registry r;
+    r.addPhase("load", 0.1);
+    CHECK_GT(r.phase("load").peakRssBytes, 0);
+}
+
+TEST_CASE("jsonBytes grows with the document and counts long strings") {
+    const json small = json::parse(R"({"a": [1, 2]})");
+    const json large = json::parse(R"({"a": [1, 2, 3, 4, 5, 6, 7, 8], "b": "a string too long for the small buffer"})");
+    CHECK_GE(stats::jsonBytes(json(1)), sizeof(json));
+    CHECK_GT(stats::jsonBytes(small), 3 * sizeof(json));
+    CHECK_GT(stats::jsonBytes(large), stats::jsonBytes(small) + 6 * sizeof(json) + 36);
+}
+
+TEST_CASE("costly measurements are off until a report is asked for") {
+    CHECK_FALSE(stats::enabled());
+    stats::setEnabled(true);
+    CHECK(stats::enabled());
+    stats::setEnabled(false);
+    CHECK_FALSE(stats::enabled());
+}
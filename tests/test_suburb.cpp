@@ -12,10 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <doctest/doctest.h>
+#include <cmath>
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "../tawny_density/suburb.hpp"
 
 using std::string;
+using std::vector;
 
 using suburb::Point;
 using suburb::Ring;
@@ -23,9 +27,12 @@ using suburb::Polygon;
 using suburb::Suburb;
 
 using suburb::ringBounds;
+using suburb::buildChains;
 using suburb::pointInRing;
 using suburb::pointInPolygon;
 using suburb::pointInSuburb;
+using suburb::findSuburb;
+using suburb::NO_SUBURB;
 
 // -----------------------------------------------------------------------------
 // Tests for ringBounds
@@ -163,6 +170,53 @@ TEST_CASE("pointInRing: ring with fewer than 3 points is always false") {
     CHECK(pointInRing(ring3, {0, 0}) == false);
 }
 
+// -----------------------------------------------------------------------------
+// Tests for buildChains
+// -----------------------------------------------------------------------------
+
+TEST_CASE("buildChains splits a ring where its latitude turns") {
+    // a square rises once and falls once; flat edges stay in the run they are in
+    Ring square{ { {0, 0}, {10, 0}, {10, 10}, {0, 10}, {0, 0} } };
+    buildChains(&square);
+    CHECK_EQ(square.chains, vector<uint32_t>{0, 3});
+    CHECK_EQ(square.chainLats, vector<double>{0, 10, 0});
+
+    // the "C" shape turns at the bite too
+    Ring c{ { {0, 0}, {10, 0}, {10, 10}, {6, 10}, {6, 4}, {4, 4}, {4, 10}, {0, 10} } };
+    buildChains(&c);
+    CHECK_EQ(c.chains, vector<uint32_t>{0, 3, 5, 7});
+
+    Ring empty{};
+    buildChains(&empty);
+    CHECK(empty.chains.empty());
+    CHECK(empty.chainLats.empty());
+}
+
+TEST_CASE("pointInRing with chains agrees with the full scan, on edges and vertices too") {
+    // a zigzag ring with flat runs, repeated vertices and vertical edges
+    Ring plain{ {
+        {0, 0}, {2, 3}, {3, 3}, {4, 1}, {5, 4}, {5, 6}, {6, 6}, {7, 2}, {8, 8}, {8, 8},
+        {6, 9}, {4, 7}, {3, 9}, {1, 8}, {1, 5}, {-1, 6}, {0, 3}, {-1, 2}
+    } };
+    Ring chained = plain;
+    buildChains(&chained);
+    REQUIRE_GT(chained.chains.size(), 4);
+
+    vector<Point> points;
+    for (int x = -4; x <= 36; ++x) {
+        for (int y = -4; y <= 40; ++y) points.push_back(Point{x * 0.25, y * 0.25});  // lattice through every vertex
+    }
+    for (const auto& v : plain.points) {
+        points.push_back(Point{v.lon, std::nextafter(v.lat, 100.0)});
+        points.push_back(Point{v.lon, std::nextafter(v.lat, -100.0)});
+    }
+    for (const auto& p : points) {
+        CAPTURE(p.lon);
+        CAPTURE(p.lat);
+        CHECK_EQ(pointInRing(chained, p), pointInRing(plain, p));
+    }
+}
+
 // -----------------------------------------------------------------------------
 // Tests for pointInPolygon
 // -----------------------------------------------------------------------------
@@ -265,6 +319,27 @@ TEST_CASE("pointInPolygon: outer ring with fewer than 3 points is false") {
     CHECK(pointInPolygon(poly, {5, 5}) == false);
 }
 
+// -----------------------------------------------------------------------------
+// Tests for findSuburb
+// -----------------------------------------------------------------------------
+
+TEST_CASE("findSuburb returns the first suburb containing the point") {
+    Polygon poly;
+    poly.minLon = 0; poly.minLat = 0;
+    poly.maxLon = 10; poly.maxLat = 10;
+    poly.rings = { Ring{ { {0, 0}, {10, 0}, {10, 10}, {0, 10} } } };
+
+    Suburb a;
+    a.polys = { poly };
+    a.minLon = 0; a.minLat = 0; a.maxLon = 10; a.maxLat = 10;
+    Suburb empty;
+
+    vector<Suburb> suburbs{ empty, a, a };
+    CHECK_EQ(findSuburb(suburbs, {5, 5}), 1);
+    CHECK_EQ(findSuburb(suburbs, {20, 20}), NO_SUBURB);
+    CHECK_EQ(findSuburb({}, {5, 5}), NO_SUBURB);
+}
+
 // -----------------------------------------------------------------------------
 // Tests for pointInSuburb
 // -----------------------------------------------------------------------------
@@ -471,3 +546,31 @@ TEST_CASE("pointInPolygon: outer ring with fewer than 3 points is false") {
 //     CHECK(isPointInRing(ring2, {0, 0}) == false);
 //     CHECK(isPointInRing(ring3, {0, 0}) == false);
 // }
+
+// -----------------------------------------------------------------------------
+// Tests for geometryBytes
+// -----------------------------------------------------------------------------
+
+TEST_CASE("geometryBytes counts vertex arrays, ring and polygon metadata and long names") {
+    Suburb s;
+    s.name = "A suburb name well past the small string buffer";
+    Polygon poly;
+    Ring outer;
+    outer.points.reserve(100);
+    outer.points.resize(5);
+    poly.rings.push_back(outer);
+    poly.rings.push_back(Ring{{{0, 0}, {1, 0}, {0, 1}}});
+    buildChains(&poly.rings.back());
+    s.polys.push_back(poly);
+    vector<Suburb> suburbs{s, Suburb{}};
+
+    const suburb::GeometryBytes b = suburb::geometryBytes(suburbs);
+    // copies drop spare capacity, so the reserved 100 points are not counted
+    CHECK_EQ(b.vertices, (suburbs[0].polys[0].rings[0].points.capacity() + 3) * sizeof(Point));
+    CHECK_EQ(b.chains, 2 * sizeof(uint32_t) + 3 * sizeof(double));
+    CHECK_EQ(b.rings, 2 * sizeof(Ring));
+    CHECK_EQ(b.polygons, sizeof(Polygon));
+    CHECK_EQ(b.suburbs, suburbs.capacity() * sizeof(Suburb));
+    CHECK_GE(b.names, s.name.size());
+    CHECK_EQ(b.total(), b.names + b.vertices + b.chains + b.rings + b.polygons + b.suburbs);
+}
@@ -0,0 +1,95 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "../tawny_density/suburb_grid.hpp"
+#include "test_geometry.hpp"
+
+using std::vector;
+
+using suburb::Point;
+using suburb::Suburb;
+using suburb::SuburbGrid;
+using suburb::findSuburb;
+using suburb::pointSegmentMetres;
+using suburb::NO_SUBURB;
+using suburb::METRES_PER_DEGREE_LAT;
+
+// -----------------------------------------------------------------------------
+// Tests for SuburbGrid::locate
+// -----------------------------------------------------------------------------
+
+TEST_CASE("SuburbGrid locate agrees with findSuburb, including overlaps and edges") {
+    // a 6x6 tiling of 0.01 degree squares plus one overlapping suburb and an empty one
+    vector<Suburb> suburbs;
+    for (int r = 0; r < 6; ++r) {
+        for (int c = 0; c < 6; ++c) suburbs.push_back(squareSuburb(144.9 + 0.01 * c, -37.8 + 0.01 * r, 0.01));
+    }
+    suburbs.push_back(squareSuburb(144.905, -37.795, 0.02));
+    suburbs.push_back(Suburb{});
+    const SuburbGrid grid(suburbs);
+    CHECK_GT(grid.cols() * grid.rows(), 1);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> lon(144.89, 144.97), lat(-37.81, -37.73);
+    for (int i = 0; i < 2000; ++i) {
+        const Point p{lon(rng), lat(rng)};
+        CHECK_EQ(grid.locate(p), findSuburb(suburbs, p));
+    }
+    // points on shared edges and corners
+    for (int r = 0; r <= 6; ++r) {
+        for (int c = 0; c <= 6; ++c) {
+            const Point p{144.9 + 0.01 * c, -37.8 + 0.01 * r};
+            CHECK_EQ(grid.locate(p), findSuburb(suburbs, p));
+        }
+    }
+}
+
+TEST_CASE("SuburbGrid over no suburbs locates nothing") {
+    const vector<Suburb> suburbs;
+    const SuburbGrid grid(suburbs);
+    CHECK_EQ(grid.locate({0, 0}), NO_SUBURB);
+    CHECK_EQ(grid.nearest({0, 0}, 1000), NO_SUBURB);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for SuburbGrid::nearest
+// -----------------------------------------------------------------------------
+
+TEST_CASE("SuburbGrid nearest finds the closest boundary within the threshold") {
+    vector<Suburb> suburbs{ squareSuburb(0, 0, 0.01), squareSuburb(0.02, 0, 0.01) };
+    const SuburbGrid grid(suburbs);
+
+    // 0.004 degrees right of WEST, 0.006 left of EAST
+    double metres = 0;
+    CHECK_EQ(grid.nearest({0.014, 0.005}, 1000, &metres), 0);
+    CHECK(metres == doctest::Approx(0.004 * METRES_PER_DEGREE_LAT).epsilon(0.01));
+    CHECK_EQ(grid.nearest({0.017, 0.005}, 1000), 1);
+    CHECK_EQ(grid.nearest({0.014, 0.005}, 400), NO_SUBURB);
+    CHECK_EQ(grid.nearest({0.5, 0.5}, 1000), NO_SUBURB);
+    // equidistant: the lower id wins
+    CHECK_EQ(grid.nearest({0.015, 0.005}, 1000), 0);
+}
+
+TEST_CASE("pointSegmentMetres measures to the closest point of the segment") {
+    const double lonScale = METRES_PER_DEGREE_LAT;
+    CHECK(pointSegmentMetres({0, 1}, {-1, 0}, {1, 0}, lonScale) == doctest::Approx(METRES_PER_DEGREE_LAT));
+    CHECK(pointSegmentMetres({3, 0}, {-1, 0}, {1, 0}, lonScale) == doctest::Approx(2 * METRES_PER_DEGREE_LAT));
+    CHECK(pointSegmentMetres({0, 0}, {2, 2}, {2, 2}, lonScale) ==
+        doctest::Approx(2 * std::sqrt(2.0) * METRES_PER_DEGREE_LAT));
+}
@@ -0,0 +1,88 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../tawny_density/suburb_index.hpp"
+#include "test_geometry.hpp"
+
+using std::vector;
+
+using suburb::findSuburb;
+using suburb::indexStrategyName;
+using suburb::IndexStrategy;
+using suburb::NO_SUBURB;
+using suburb::parseIndexStrategy;
+using suburb::Point;
+using suburb::Suburb;
+using suburb::SuburbIndex;
+
+// n x n tiling of square suburbs plus one suburb overlapping the middle
+static vector<Suburb> tiledSuburbs(int n) {
+    vector<Suburb> suburbs;
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c < n; ++c) suburbs.push_back(squareSuburb(c, r, 1));
+    }
+    suburbs.push_back(squareSuburb(n / 2.0 - 0.5, n / 2.0 - 0.5, 1));
+    return suburbs;
+}
+
+// -----------------------------------------------------------------------------
+// Tests for SuburbIndex
+// -----------------------------------------------------------------------------
+
+TEST_CASE("SuburbIndex strategies agree with findSuburb") {
+    const auto suburbs = tiledSuburbs(8);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> coord(-1, 9);
+    vector<Point> points;
+    for (int i = 0; i < 3000; ++i) points.push_back(Point{coord(rng), coord(rng)});
+    for (int i = 0; i <= 8; ++i) points.push_back(Point{static_cast<double>(i), static_cast<double>(i)});
+
+    for (auto strategy : {IndexStrategy::Linear, IndexStrategy::Grid}) {
+        const SuburbIndex index(suburbs, strategy);
+        CHECK_EQ(index.size(), suburbs.size());
+        CHECK_EQ(index.strategy(), strategy);
+        for (const auto& p : points) CHECK_EQ(index.locate(p), findSuburb(suburbs, p));
+    }
+}
+
+TEST_CASE("SuburbIndex locateBatch matches locate for any thread count") {
+    SuburbIndex built(tiledSuburbs(4));
+    const SuburbIndex index(std::move(built));  // the index stays usable after a move
+    vector<Point> points;
+    for (int i = 0; i < 1000; ++i) points.push_back(Point{(i % 50) * 0.1 - 0.5, (i / 50) * 0.25 - 0.5});
+
+    for (unsigned threads : {1u, 4u}) {
+        const vector<uint32_t> ids = index.locateBatch(points, threads);
+        REQUIRE_EQ(ids.size(), points.size());
+        for (size_t i = 0; i < points.size(); ++i) CHECK_EQ(ids[i], index.locate(points[i]));
+    }
+    uint32_t one = 0;
+    index.locateBatch(&points[0], 1, &one);
+    CHECK_EQ(one, NO_SUBURB);  // (-0.5, -0.5) is outside
+}
+
+TEST_CASE("SuburbIndex strategies parse by name") {
+    CHECK_EQ(parseIndexStrategy("linear"), IndexStrategy::Linear);
+    CHECK_EQ(parseIndexStrategy("grid"), IndexStrategy::Grid);
+    CHECK_EQ(parseIndexStrategy("trapezoid"), IndexStrategy::Trapezoid);
+    CHECK_EQ(std::string(indexStrategyName(IndexStrategy::Grid)), "grid");
+    CHECK_EQ(std::string(indexStrategyName(IndexStrategy::Trapezoid)), "trapezoid");
+    CHECK_THROWS(parseIndexStrategy("quadtree"));
+}
@@ -0,0 +1,193 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../tawny_density/counts.hpp"
+#include "../tawny_density/stats.hpp"
+#include "../tawny_density/suburb_index.hpp"
+#include "../tawny_density/trace.hpp"
+
+using std::string;
+using std::vector;
+using json = nlohmann::json;
+
+using counts::CountStats;
+using observations::ObsPoint;
+using suburb::Polygon;
+using suburb::Ring;
+using suburb::Suburb;
+using suburb::SuburbIndex;
+
+// Complete ("X") events in a trace, in file order
+static vector<json> spans(const json& trace) {
+    vector<json> out;
+    for (const auto& e : trace["traceEvents"]) {
+        if (e["ph"] == "X") out.push_back(e);
+    }
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// Tests for Span and record
+// -----------------------------------------------------------------------------
+
+TEST_CASE("trace records nothing while stopped") {
+    trace::start();
+    trace::stop();
+    {
+        trace::Span span("idle", "test");
+    }
+    trace::record("idle", "test", 0, 1);
+    CHECK(spans(trace::toJson()).empty());
+}
+
+TEST_CASE("trace Span records a complete event with its category and items") {
+    trace::start();
+    {
+        trace::Span outer("outer", "test");
+        trace::Span inner("inner", "test");
+        inner.setItems(42);
+    }
+    trace::stop();
+
+    const vector<json> events = spans(trace::toJson());
+    REQUIRE_EQ(events.size(), 2);
+    // inner ends first, so is recorded first
+    CHECK_EQ(events[0]["name"], "inner");
+    CHECK_EQ(events[0]["cat"], "test");
+    CHECK_EQ(events[0]["args"]["items"], 42);
+    CHECK_EQ(events[1]["name"], "outer");
+    CHECK_FALSE(events[1].contains("args"));
+    CHECK(events[1]["ts"].get<double>() <= events[0]["ts"].get<double>());
+    CHECK(events[1]["dur"].get<double>() >= events[0]["dur"].get<double>());
+    CHECK(events[0]["ts"].get<double>() >= 0);
+    CHECK_EQ(events[0]["tid"], events[1]["tid"]);
+}
+
+TEST_CASE("trace gives each thread its own track and name") {
+    trace::start();
+    trace::setThreadName("main");
+    trace::record("on main", "test", trace::nowNs(), trace::nowNs());
+    std::thread worker([] {
+        trace::setThreadName("worker");
+        trace::Span span("on worker", "test");
+    });
+    worker.join();
+    trace::stop();
+
+    const json j = trace::toJson();
+    std::set<string> names;
+    std::set<int> tids;
+    for (const auto& e : j["traceEvents"]) {
+        if (e["ph"] == "M") names.insert(e["args"]["name"].get<string>());
+        tids.insert(e["tid"].get<int>());
+    }
+    CHECK_EQ(names, std::set<string>{"main", "worker"});
+    CHECK_EQ(tids.size(), 2);
+}
+
+TEST_CASE("trace ring buffer keeps the newest events and counts the dropped ones") {
+    trace::start(4);
+    for (int i = 0; i < 10; ++i) trace::record("tick", "test", i, i + 1, i);
+    trace::stop();
+
+    const json j = trace::toJson();
+    const vector<json> events = spans(j);
+    REQUIRE_EQ(events.size(), 4);
+    for (int k = 0; k < 4; ++k) CHECK_EQ(events[k]["args"]["items"], 6 + k);
+    CHECK_EQ(j["otherData"]["dropped_events"], 6);
+}
+
+TEST_CASE("trace start discards the previous trace") {
+    trace::start();
+    trace::record("old", "test", 0, 1);
+    trace::start();
+    trace::record("new", "test", 0, 1);
+    trace::stop();
+
+    const vector<json> events = spans(trace::toJson());
+    REQUIRE_EQ(events.size(), 1);
+    CHECK_EQ(events[0]["name"], "new");
+}
+
+// -----------------------------------------------------------------------------
+// Tests for traced library code
+// -----------------------------------------------------------------------------
+
+TEST_CASE("trace shows ScopedTimer phases and countObservations batches") {
+    Polygon poly;
+    poly.rings = { Ring{ { {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 0} } } };
+    poly.maxLon = poly.maxLat = 1;
+    Suburb s;
+    s.polys = { poly };
+    s.maxLon = s.maxLat = 1;
+    const SuburbIndex index(vector<Suburb>{s});
+    const vector<ObsPoint> obs(100, ObsPoint{0.5, 0.5, 0, 3});
+
+    stats::Registry registry;
+    trace::start();
+    {
+        stats::ScopedTimer timer("assign", &registry);
+        CountStats counted;
+        counts::countObservations(index, obs, 0, 13, 7, 2, &counted);
+        timer.setItems(obs.size());
+    }
+    trace::stop();
+
+    int batches = 0, merges = 0, phases = 0;
+    int64_t batchItems = 0;
+    std::set<int> batchTids;
+    for (const auto& e : spans(trace::toJson())) {
+        if (e["name"] == "assign_batch") {
+            ++batches;
+            batchItems += e["args"]["items"].get<int64_t>();
+            batchTids.insert(e["tid"].get<int>());
+        }
+        if (e["name"] == "merge") ++merges;
+        if (e["name"] == "assign" && e["cat"] == "phase") {
+            ++phases;
+            CHECK_EQ(e["args"]["items"], 100);
+        }
+    }
+    CHECK_EQ(batches, 2);
+    CHECK_EQ(batchItems, 100);
+    CHECK_EQ(batchTids.size(), 2);
+    CHECK_EQ(merges, 1);
+    CHECK_EQ(phases, 1);
+}
+
+TEST_CASE("writeTrace writes a file chrome://tracing can load") {
+    trace::start();
+    {
+        trace::Span span("write", "test");
+    }
+    trace::stop();
+    const string path = "tawny_test_trace.json";
+    trace::writeTrace(path);
+
+    std::ifstream in(path);
+    const json j = json::parse(in);
+    CHECK(j["traceEvents"].is_array());
+    CHECK_EQ(j["displayTimeUnit"], "ms");
+    CHECK_EQ(spans(j).size(), 1);
+    in.close();
+    std::remove(path.c_str());
+    CHECK_THROWS(trace::writeTrace("/nonexistent-dir/trace.json"));
+}
@@ -0,0 +1,190 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <doctest/doctest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../tawny_density/suburb_index.hpp"
+#include "../tawny_density/trapezoid_map.hpp"
+#include "test_geometry.hpp"
+
+using std::string;
+using std::vector;
+
+using suburb::IndexStrategy;
+using suburb::Point;
+using suburb::Suburb;
+using suburb::SuburbGrid;
+using suburb::SuburbIndex;
+using suburb::TrapezoidMap;
+using suburb::findSuburb;
+using suburb::NO_SUBURB;
+
+// A 6x6 tiling of quarter-degree squares; the coordinates are exact in binary, so
+// neighbours share their corners bit for bit as they do in real boundary data
+static vector<Suburb> tiling() {
+    vector<Suburb> suburbs;
+    for (int r = 0; r < 6; ++r) {
+        for (int c = 0; c < 6; ++c) suburbs.push_back(squareSuburb(144.0 + 0.25 * c, -38.0 + 0.25 * r, 0.25));
+    }
+    return suburbs;
+}
+
+// -----------------------------------------------------------------------------
+// Tests for TrapezoidMap::locate
+// -----------------------------------------------------------------------------
+
+TEST_CASE("TrapezoidMap locates points in a tessellation without testing polygons") {
+    const auto suburbs = tiling();
+    const SuburbGrid grid(suburbs);
+    const TrapezoidMap map(suburbs, grid);
+    CHECK_EQ(map.segments(), 2 * 6 * 7);  // shared edges are stored once
+    CHECK_EQ(map.skippedSegments(), 0);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> lon(143.9, 145.6), lat(-38.1, -36.4);
+    for (int i = 0; i < 2000; ++i) {
+        const Point p{lon(rng), lat(rng)};
+        size_t steps = 0;
+        CHECK_EQ(map.locate(p, &steps), findSuburb(suburbs, p));
+        CHECK_GT(steps, 0);
+        CHECK_LT(steps, 60);
+    }
+}
+
+TEST_CASE("TrapezoidMap defers points on edges and vertices") {
+    const auto suburbs = tiling();
+    const SuburbGrid grid(suburbs);
+    const TrapezoidMap map(suburbs, grid);
+    for (int r = 0; r <= 6; ++r) {
+        for (int c = 0; c <= 6; ++c) {
+            const Point corner{144.0 + 0.25 * c, -38.0 + 0.25 * r};
+            CHECK_EQ(map.locate(corner), TrapezoidMap::AMBIGUOUS);
+            const Point edge{corner.lon + 0.125, corner.lat};
+            if (c < 6) CHECK_EQ(map.locate(edge), TrapezoidMap::AMBIGUOUS);
+            // a micrometre or so inside is far enough to decide
+            const Point inside{corner.lon + 0.125, corner.lat + 1e-8};
+            CHECK_EQ(map.locate(inside), findSuburb(suburbs, inside));
+        }
+    }
+}
+
+TEST_CASE("TrapezoidMap skips crossing edges and defers the area around them") {
+    // one suburb laid across the tiling: its edges cross the tiles' edges
+    auto suburbs = tiling();
+    suburbs.push_back(squareSuburb(144.125, -37.875, 0.5));
+    suburbs.push_back(Suburb{});
+    const SuburbGrid grid(suburbs);
+    const TrapezoidMap map(suburbs, grid);
+    CHECK_GT(map.skippedSegments(), 0);
+    CHECK_GT(map.ambiguousLeaves(), 0);
+
+    const SuburbIndex index(suburbs, IndexStrategy::Trapezoid);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> lon(143.9, 145.6), lat(-38.1, -36.4);
+    for (int i = 0; i < 2000; ++i) {
+        const Point p{lon(rng), lat(rng)};
+        const uint32_t id = map.locate(p);
+        if (id != TrapezoidMap::AMBIGUOUS) CHECK_EQ(id, findSuburb(suburbs, p));
+        CHECK_EQ(index.locate(p), findSuburb(suburbs, p));
+    }
+}
+
+TEST_CASE("TrapezoidMap over no suburbs locates nothing") {
+    const vector<Suburb> suburbs;
+    const SuburbGrid grid(suburbs);
+    const TrapezoidMap map(suburbs, grid);
+    CHECK_EQ(map.nodes(), 1);
+    CHECK_EQ(map.locate(Point{144.0, -38.0}), NO_SUBURB);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for TrapezoidMap::save and TrapezoidMap::load
+// -----------------------------------------------------------------------------
+
+TEST_CASE("TrapezoidMap round trips through a file") {
+    const string path = "tawny_test_map.bin";
+    const auto suburbs = tiling();
+    const SuburbGrid grid(suburbs);
+    const TrapezoidMap map(suburbs, grid);
+    map.save(path);
+
+    const TrapezoidMap loaded = TrapezoidMap::load(path, suburbs);
+    CHECK_EQ(loaded.nodes(), map.nodes());
+    CHECK_EQ(loaded.segments(), map.segments());
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> lon(143.9, 145.6), lat(-38.1, -36.4);
+    for (int i = 0; i < 500; ++i) {
+        const Point p{lon(rng), lat(rng)};
+        CHECK_EQ(loaded.locate(p), map.locate(p));
+    }
+
+    // a different suburb layer is rejected
+    auto moved = tiling();
+    moved[5].polys[0].rings[0].points[2].lat += 1e-7;
+    CHECK_THROWS(TrapezoidMap::load(path, moved));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("TrapezoidMap load rejects missing, foreign and truncated files") {
+    const auto suburbs = tiling();
+    CHECK_THROWS(TrapezoidMap::load("tawny_test_missing.bin", suburbs));
+
+    const string path = "tawny_test_map.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "TAWNYSN1 not a map";
+    }
+    CHECK_THROWS(TrapezoidMap::load(path, suburbs));
+
+    const SuburbGrid grid(suburbs);
+    TrapezoidMap(suburbs, grid).save(path);
+    string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    CHECK_THROWS(TrapezoidMap::load(path, suburbs));
+    std::remove(path.c_str());
+}
+
+TEST_CASE("SuburbIndex reuses a cached trapezoid map and rebuilds a stale one") {
+    const string path = "tawny_test_map.bin";
+    const auto suburbs = tiling();
+    {
+        const SuburbIndex built(suburbs, IndexStrategy::Trapezoid, path);
+        REQUIRE(built.trapezoidMap() != nullptr);
+    }
+    CHECK_NOTHROW(TrapezoidMap::load(path, suburbs));
+
+    const SuburbIndex cached(suburbs, IndexStrategy::Trapezoid, path);
+    CHECK_EQ(cached.locate(Point{144.125, -37.875}), 0);
+    CHECK_GT(cached.memoryBytes(), SuburbIndex(suburbs, IndexStrategy::Grid).memoryBytes());
+
+    // other suburbs: the cached map no longer matches, so it is rebuilt and replaced
+    auto other = tiling();
+    other.pop_back();
+    const SuburbIndex rebuilt(other, IndexStrategy::Trapezoid, path);
+    CHECK_EQ(rebuilt.locate(Point{145.375, -36.625}), NO_SUBURB);
+    CHECK_NOTHROW(TrapezoidMap::load(path, other));
+    std::remove(path.c_str());
+}
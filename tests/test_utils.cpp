@@ -0,0 +1,108 @@
+// Copyright 2026 Maree Carroll
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <doctest/doctest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include "../tawny_density/stats.hpp"
+#include "../tawny_density/utils.hpp"
+
+using std::string;
+
+using stats::Registry;
+using utils::CurlHttpClient;
+using utils::HttpResponse;
+using utils::HttpTimings;
+using utils::recordHttpTimings;
+using utils::stageTimings;
+
+// -----------------------------------------------------------------------------
+// Tests for stageTimings and recordHttpTimings
+// -----------------------------------------------------------------------------
+
+TEST_CASE("stageTimings turns curl offsets into stage durations") {
+    // new TLS connection: lookup 10 ms, connect 20 ms, handshake 30 ms, server 100 ms
+    HttpTimings t = stageTimings(10000, 30000, 60000, 160000, 200000);
+    CHECK_EQ(t.dns, doctest::Approx(0.01));
+    CHECK_EQ(t.connect, doctest::Approx(0.02));
+    CHECK_EQ(t.tls, doctest::Approx(0.03));
+    CHECK_EQ(t.ttfb, doctest::Approx(0.1));
+    CHECK_EQ(t.total, doctest::Approx(0.2));
+
+    // plain connection: ttfb counts from the connect
+    t = stageTimings(10000, 30000, 0, 80000, 90000);
+    CHECK_EQ(t.tls, 0);
+    CHECK_EQ(t.ttfb, doctest::Approx(0.05));
+
+    // failed before any response byte
+    t = stageTimings(10000, 0, 0, 0, 5000000);
+    CHECK_EQ(t.connect, 0);
+    CHECK_EQ(t.ttfb, 0);
+    CHECK_EQ(t.total, doctest::Approx(5.0));
+}
+
+TEST_CASE("recordHttpTimings fills the http histograms and connection counters") {
+    Registry r;
+    HttpTimings t;
+    t.dns = 0.01;
+    t.connect = 0.02;
+    t.ttfb = 0.2;
+    t.total = 0.25;
+    t.bytes = 4096;
+    recordHttpTimings(t, &r);
+    t.reused = true;
+    recordHttpTimings(t, &r);
+
+    CHECK_EQ(r.histogram("http_total_seconds").count(), 2);
+    CHECK_EQ(r.histogram("http_ttfb_seconds").max(), doctest::Approx(0.2));
+    CHECK_EQ(r.histogram("http_download_bytes").max(), doctest::Approx(4096));
+    CHECK_EQ(r.histogram("http_tls_seconds").max(), 0);
+    CHECK_EQ(r.counter("http_connections_new"), 1);
+    CHECK_EQ(r.counter("http_connections_reused"), 1);
+}
+
+// -----------------------------------------------------------------------------
+// Tests for CurlHttpClient (file:// urls, so no network is needed)
+// -----------------------------------------------------------------------------
+
+TEST_CASE("CurlHttpClient records timings for every request through its pooled handles") {
+    const string path = "tawny_test_http_body.txt";
+    {
+        std::ofstream out(path);
+        out << "hello frogmouth";
+    }
+    char cwd[4096];
+    REQUIRE(getcwd(cwd, sizeof(cwd)) != nullptr);
+    const string url = "file://" + string(cwd) + "/" + path;
+
+    Registry r;
+    {
+        CurlHttpClient client(&r);
+        for (int i = 0; i < 3; ++i) {
+            const HttpResponse resp = client.get(url);
+            CHECK_EQ(resp.body, "hello frogmouth");
+            CHECK_EQ(resp.timings.bytes, 15);
+            CHECK_GE(resp.timings.total, 0);
+        }
+        CHECK_THROWS(client.get("file:///nonexistent/tawny_test_missing"));
+    }
+    std::remove(path.c_str());
+
+    // the failed transfer is timed too
+    CHECK_EQ(r.histogram("http_total_seconds").count(), 4);
+    CHECK_EQ(r.histogram("http_download_bytes").max(), doctest::Approx(15));
+    CHECK_EQ(r.counter("http_connections_new") + r.counter("http_connections_reused"), 4);
+    CHECK_EQ(r.counter("http_transport_errors"), 1);
+}